@@ -0,0 +1,66 @@
+// 多线程压力测试：比较 Allocator<T> 线程缓存与 malloc 在 1~64 个线程下的吞吐量
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include "allocator.h"
+
+using namespace tinyWheels;
+
+constexpr size_t ROUNDS = 20000;    // 每个线程的轮数
+constexpr size_t BATCH = 64;        // 每轮先分配 BATCH 个块，再全部释放
+constexpr size_t SIZES[] = {1, 2, 3, 4, 6, 8, 12, 16};  // 每次申请的 int 个数，覆盖多个大小类别
+
+struct TinyAllocator {
+    static void *allocate(const size_t n) {return Allocator<int>::allocate(n).first;}
+    static void deallocate(void *p, const size_t n) {Allocator<int>::deallocate(static_cast<int *>(p), n);}
+};
+struct MallocAllocator {
+    static void *allocate(const size_t n) {return malloc(n * sizeof(int));}
+    static void deallocate(void *p, size_t) {free(p);}
+};
+
+template<class Alloc>
+void worker(std::atomic<bool> &start) {
+    void *ptrs[BATCH];
+    while (not start.load(std::memory_order_acquire)) {}
+    for (size_t r = 0; r < ROUNDS; ++r) {
+        for (size_t i = 0; i < BATCH; ++i) {
+            ptrs[i] = Alloc::allocate(SIZES[(r + i) % std::size(SIZES)]);
+            *static_cast<int *>(ptrs[i]) = static_cast<int>(i);
+        }
+        for (size_t i = 0; i < BATCH; ++i) {
+            Alloc::deallocate(ptrs[i], SIZES[(r + i) % std::size(SIZES)]);
+        }
+    }
+}
+
+// 返回每秒完成的 分配+释放 次数（百万次）
+template<class Alloc>
+double run(const size_t threads) {
+    std::atomic<bool> start{false};
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        pool.emplace_back(worker<Alloc>, std::ref(start));
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (auto &t : pool) t.join();
+    const std::chrono::duration<double> cost = std::chrono::steady_clock::now() - begin;
+    return static_cast<double>(threads * ROUNDS * BATCH) / cost.count() / 1e6;
+}
+
+int main() {
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "Allocator Mops" << std::setw(16) << "malloc Mops" << std::endl;
+    for (size_t threads = 1; threads <= 64; threads *= 2) {
+        const auto tiny = run<TinyAllocator>(threads);
+        const auto sys = run<MallocAllocator>(threads);
+        std::cout << std::setw(8) << threads << std::setw(16) << std::fixed << std::setprecision(2) << tiny
+                  << std::setw(16) << sys << std::endl;
+    }
+    return 0;
+}
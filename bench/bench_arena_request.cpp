@@ -0,0 +1,73 @@
+// 每次请求的临时内存：同样的请求负载分别使用
+//   1. Allocator<T>（内存池的自由链表，逐个释放）
+//   2. monotonic_buffer_resource（请求结束时 release()，内存还给上游）
+//   3. Arena（请求结束时 reset()，内存块留给下一次请求）
+// 比较每次请求的耗时
+#include <chrono>
+#include <iostream>
+#include "arena.h"
+#include "list.h"
+#include "mystring.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+constexpr int REQUESTS = 200000;
+constexpr int VECTOR_LENGTH = 64;   // 每次请求解析出的整数个数
+constexpr int LIST_LENGTH = 32;     // 每次请求排队的任务个数
+constexpr int STRINGS = 8;          // 每次请求拼接的字符串个数
+
+long checksum = 0;  // 防止整个请求被优化掉
+
+template<class Vector, class List, class Make>
+void request(const int id, Vector &&v, List &&l, Make &&make_string) {
+    for (int i = 0; i < VECTOR_LENGTH; ++i) {
+        v[i] = id + i;
+    }
+    for (int i = 0; i < LIST_LENGTH; ++i) {
+        l.push_back(id ^ i);
+    }
+    for (int i = 0; i < STRINGS; ++i) {
+        auto s = make_string("header-");
+        s += "value-";
+        s += static_cast<char>('a' + i);
+        checksum += static_cast<long>(s.size());
+    }
+    checksum += v[VECTOR_LENGTH - 1] + l.size();
+}
+
+template<class Function>
+double measure(const char *name, Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int id = 0; id < REQUESTS; ++id) {
+        function(id);
+    }
+    const auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / REQUESTS;
+    std::cout << name << ": " << ns << " ns/request" << std::endl;
+    return ns;
+}
+
+int main() {
+    const auto pool = measure("Allocator (free list)", [](const int id) {
+        request(id, vector<int>(VECTOR_LENGTH), list<int>(), [](const char *s) {return string(s);});
+    });
+
+    monotonic_buffer_resource monotonic;
+    const auto mono = measure("monotonic_buffer_resource + release()", [&monotonic](const int id) {
+        request(id, pmr::vector<int>(VECTOR_LENGTH, &monotonic), pmr::list<int>(&monotonic),
+                [&monotonic](const char *s) {return string(s, &monotonic);});
+        monotonic.release();
+    });
+
+    Arena arena;
+    const auto bump = measure("Arena + reset()", [&arena](const int id) {
+        request(id, vector<int, ArenaAllocator<int>>(VECTOR_LENGTH, &arena), list<int, ArenaAllocator<int>>(&arena),
+                [&arena](const char *s) {return string(s, &arena);});
+        arena.reset();
+    });
+
+    std::cout << "arena reserved: " << arena.reserved_bytes() << " bytes" << std::endl;
+    std::cout << "speedup over free list: " << pool / bump << "x, over monotonic: " << mono / bump << "x" << std::endl;
+    std::cout << "checksum: " << checksum << std::endl;
+    return 0;
+}
@@ -0,0 +1,82 @@
+// 1600 万个标志：vector<bool>（每个标志一个字节）与 bit_vector（每个字 64 个标志）比较内存、两个过滤条件求与、计数、遍历稀疏的 1
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "bit_vector.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+constexpr size_t FLAGS = 16000000;
+constexpr int ROUNDS = 10;
+
+template<class Function>
+double measure(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i) {
+        function();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / ROUNDS;
+}
+
+int main() {
+    std::mt19937_64 random(3);
+    vector<bool> bytes_a(FLAGS), bytes_b(FLAGS), bytes_c(FLAGS);
+    bit_vector bits_a(FLAGS), bits_b(FLAGS);
+    for (size_t i = 0; i < FLAGS; ++i) {
+        const bool a = random() % 2, b = random() % 100 < 2;  // b 很稀疏
+        bytes_a[i] = a;
+        bytes_b[i] = b;
+        bits_a[i] = a;
+        bits_b[i] = b;
+    }
+    size_t checksum = 0;
+
+    std::cout << "memory: vector<bool> " << FLAGS / 1024 << " KB, bit_vector " << bits_a.word_count() * 8 / 1024 << " KB" << std::endl;
+    const auto bytes_and = measure([&] {
+        for (size_t i = 0; i < FLAGS; ++i) {
+            bytes_c[i] = bytes_a[i] and bytes_b[i];
+        }
+    });
+    bit_vector bits_c;
+    const auto bits_and = measure([&] {
+        bits_c = bits_a;
+        bits_c &= bits_b;
+    });
+    std::cout << "a & b: vector<bool> " << bytes_and << " ms, bit_vector (copy + and) " << bits_and << " ms" << std::endl;
+
+    const auto bytes_count = measure([&] {
+        size_t count = 0;
+        for (size_t i = 0; i < FLAGS; ++i) {
+            count += bytes_a[i];
+        }
+        checksum += count;
+    });
+    const auto bits_count = measure([&] {checksum += bits_a.count();});
+    std::cout << "count: vector<bool> " << bytes_count << " ms, bit_vector " << bits_count << " ms" << std::endl;
+
+    const auto bytes_scan = measure([&] {
+        for (size_t i = 0; i < FLAGS; ++i) {
+            if (bytes_b[i]) {
+                checksum += i;
+            }
+        }
+    });
+    const auto bits_scan = measure([&] {
+        for (auto i = bits_b.find_first(); i != bit_vector::npos; i = bits_b.find_next(i)) {
+            checksum += i;
+        }
+    });
+    std::cout << "iterate 2% set bits: vector<bool> " << bytes_scan << " ms, bit_vector " << bits_scan << " ms" << std::endl;
+
+    const rank_index index(bits_b);
+    const auto select_time = measure([&] {
+        for (size_t k = 0; k < 100000; ++k) {
+            checksum += index.select(k * 3);
+            checksum += index.rank(k * 131);
+        }
+    });
+    std::cout << "100000 rank + select with rank_index: " << select_time << " ms" << std::endl;
+    std::cout << "checksum: " << checksum << std::endl;
+    return 0;
+}
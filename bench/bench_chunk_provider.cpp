@@ -0,0 +1,53 @@
+// 大内存块来源对随机访问的影响：同一个几百 MB 的 vector 分别放在 malloc、mmap、mmap + 透明大页上，随机遍历并计时
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include "vector.h"
+
+using namespace tinyWheels;
+
+// 随机访问 accesses 次，下标由线性同余生成，避免额外的下标数组占用缓存
+uint64_t random_traverse(vector<uint64_t> &v, const size_t accesses) {
+    uint64_t sum = 0, state = 88172645463325252ull;
+    const auto n = v.size();
+    auto data = v.begin();
+    for (size_t i = 0; i < accesses; ++i) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        sum += data[(state >> 17) % n];
+    }
+    return sum;
+}
+
+double run(ChunkProvider *provider, const size_t elements, const size_t accesses, uint64_t &checksum) {
+    MemoryPool::set_chunk_provider(provider);
+    vector<uint64_t> v(elements, 1);
+    for (size_t i = 0; i < elements; ++i) v[i] = i;
+    const auto begin = std::chrono::steady_clock::now();
+    checksum = random_traverse(v, accesses);
+    const std::chrono::duration<double, std::milli> cost = std::chrono::steady_clock::now() - begin;
+    return cost.count();
+}
+
+int main(int argc, char *argv[]) {
+    const size_t megabytes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 512;
+    const size_t elements = megabytes * 1024 * 1024 / sizeof(uint64_t);
+    const size_t accesses = 20000000;
+    MallocChunkProvider &malloc_provider = MallocChunkProvider::instance();
+    MmapChunkProvider mmap_provider(false);
+    MmapChunkProvider huge_provider(true);
+
+    struct {const char *name; ChunkProvider *provider;} cases[] = {
+        {"malloc", &malloc_provider}, {"mmap", &mmap_provider}, {"mmap + MADV_HUGEPAGE", &huge_provider},
+    };
+    std::cout << "vector<uint64_t>: " << megabytes << " MB, random accesses: " << accesses << std::endl;
+    for (auto &[name, provider] : cases) {
+        uint64_t checksum = 0;
+        const auto ms = run(provider, elements, accesses, checksum);
+        std::cout << std::setw(24) << name << std::setw(12) << std::fixed << std::setprecision(1) << ms << " ms"
+                  << "  (checksum " << checksum << ")" << std::endl;
+    }
+    MemoryPool::set_chunk_provider(nullptr);
+    return 0;
+}
@@ -0,0 +1,92 @@
+// 队列负载：原来基于 list 的 deque（每个元素一个节点）与分块的 deque
+// 1. 稳定状态：队列里保持 1000 个元素，1000 万次入队、出队
+// 2. 突发：一次入队 100 万个，再全部出队，重复 10 次
+// 同时统计申请次数；最后用下标遍历分块的 deque，list 没有随机访问
+#include <chrono>
+#include <iostream>
+#include "deque.h"
+#include "list.h"
+#include "memory_resource.h"
+
+using namespace tinyWheels;
+
+constexpr size_t STEADY_LENGTH = 1000;
+constexpr size_t STEADY_OPERATIONS = 10000000;
+constexpr size_t BURST_LENGTH = 1000000;
+constexpr int BURST_ROUNDS = 10;
+
+// 统计申请次数
+class CountingResource final : public memory_resource {
+    size_t allocations_{0};
+public:
+    [[nodiscard]] size_t allocations() const {return allocations_;}
+protected:
+    void *do_allocate(const memory_size_type bytes, const memory_size_type alignment) override {
+        ++allocations_;
+        return get_default_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *address, const memory_size_type bytes, const memory_size_type alignment) override {
+        get_default_resource()->deallocate(address, bytes, alignment);
+    }
+};
+
+template<class Work>
+void measure(const char *name, Work &&work, const CountingResource &counting) {
+    const auto before = counting.allocations();
+    const auto start = std::chrono::steady_clock::now();
+    const auto sum = work();
+    const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << ms << " ms, allocations: " << counting.allocations() - before << " (sum " << sum << ")" << std::endl;
+}
+
+// Queue 需要 push_back、pop_front、front
+template<class Queue>
+long long steady(Queue &q) {
+    long long sum = 0;
+    for (size_t i = 0; i < STEADY_LENGTH; ++i) {
+        q.push_back(static_cast<int>(i));
+    }
+    for (size_t i = 0; i < STEADY_OPERATIONS; ++i) {
+        q.push_back(static_cast<int>(i));
+        sum += q.front();
+        q.pop_front();
+    }
+    while (q.pop_front()) {}
+    return sum;
+}
+
+template<class Queue>
+long long burst(Queue &q) {
+    long long sum = 0;
+    for (int round = 0; round < BURST_ROUNDS; ++round) {
+        for (size_t i = 0; i < BURST_LENGTH; ++i) {
+            q.push_back(static_cast<int>(i));
+        }
+        while (not q.empty()) {
+            sum += q.front();
+            q.pop_front();
+        }
+    }
+    return sum;
+}
+
+int main() {
+    CountingResource list_counting, deque_counting;
+    pmr::list<int> l(&list_counting);
+    pmr::deque<int> d(&deque_counting);
+
+    measure("list steady", [&l] {return steady(l);}, list_counting);
+    measure("deque steady", [&d] {return steady(d);}, deque_counting);
+    measure("list burst", [&l] {return burst(l);}, list_counting);
+    measure("deque burst", [&d] {return burst(d);}, deque_counting);
+
+    for (size_t i = 0; i < BURST_LENGTH; ++i) {
+        d.push_back(static_cast<int>(i % 1000));
+    }
+    measure("deque operator[] scan", [&d] {
+        long long sum = 0;
+        for (size_t i = 0; i < d.size(); ++i) sum += d[i];
+        return sum;
+    }, deque_counting);
+    return 0;
+}
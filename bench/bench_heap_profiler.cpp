@@ -0,0 +1,45 @@
+// 采样堆分析器的开销：同样的 48 字节申请/释放循环，分别在分析器关闭、以默认间隔（512KB）开启时运行
+// 关闭时分配路径上只多一次 relaxed 读；开启时平均每 512KB 才记录一次调用栈，开销应该在 1% 左右
+#include <chrono>
+#include <iostream>
+#include "HeapProfiler.h"
+#include "allocator.h"
+
+using namespace tinyWheels;
+
+constexpr int ROUNDS = 200;
+constexpr int BATCH = 100000;
+
+struct Object {
+    char data[48];
+};
+
+double run() {
+    Allocator<Object> alloc;
+    static Object *objects[BATCH];
+    const auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (auto &object : objects) {
+            object = alloc.allocate(1).first;
+        }
+        for (const auto object : objects) {
+            alloc.deallocate(object, 1);
+        }
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (ROUNDS * BATCH);
+}
+
+int main() {
+    run();  // 预热，让内存池准备好足够的内存块
+    double off = 0, on = 0;
+    for (int i = 0; i < 3; ++i) {  // 交替运行，减少频率变化的影响
+        off += run();
+        HeapProfiler::start();
+        on += run();
+        HeapProfiler::stop();
+    }
+    std::cout << "profiler off: " << off / 3 << " ns/op" << std::endl;
+    std::cout << "profiler on:  " << on / 3 << " ns/op, " << HeapProfiler::samples() << " samples" << std::endl;
+    std::cout << "overhead: " << (on / off - 1) * 100 << "%" << std::endl;
+    return 0;
+}
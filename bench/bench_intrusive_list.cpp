@@ -0,0 +1,95 @@
+// LRU 链：10 万个连接，1000 万次随机访问，每次把访问的连接移到开头
+// list 保存连接编号：erase 再 push_front 每次都要申请；list::splice 不申请，但节点与连接分开，要多跳一次
+// intrusive_list 直接 splice 连接本身，不申请内存
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "intrusive_list.h"
+#include "list.h"
+#include "memory_resource.h"
+
+using namespace tinyWheels;
+
+constexpr size_t CONNECTIONS = 100000;
+constexpr size_t TOUCHES = 10000000;
+
+// 统计申请次数
+class CountingResource final : public memory_resource {
+    size_t allocations_{0};
+public:
+    [[nodiscard]] size_t allocations() const {return allocations_;}
+protected:
+    void *do_allocate(const memory_size_type bytes, const memory_size_type alignment) override {
+        ++allocations_;
+        return get_default_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *address, const memory_size_type bytes, const memory_size_type alignment) override {
+        get_default_resource()->deallocate(address, bytes, alignment);
+    }
+};
+
+struct Connection : intrusive_list_hook<> {
+    int fd{0};
+    long last_active{0};
+};
+
+template<class Touch>
+void measure(const char *name, const std::vector<unsigned> &order, Touch &&touch, const CountingResource *counting) {
+    const auto before = counting == nullptr ? 0 : counting->allocations();
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto fd : order) {
+        touch(fd);
+    }
+    const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << ms << " ms, allocations: " << (counting == nullptr ? 0 : counting->allocations() - before) << std::endl;
+}
+
+int main() {
+    std::mt19937 random(1);
+    std::vector<unsigned> order(TOUCHES);
+    for (auto &fd : order) {
+        fd = random() % CONNECTIONS;
+    }
+
+    CountingResource counting;
+    pmr::list<int> lru(&counting);
+    std::vector<pmr::list<int>::Iterator> where(CONNECTIONS);
+    for (size_t fd = 0; fd < CONNECTIONS; ++fd) {
+        lru.push_front(static_cast<int>(fd));
+        where[fd] = lru.begin();
+    }
+    // 访问时同时更新连接的活跃时间，list 的连接放在另一个数组中
+    std::vector<long> last_active(CONNECTIONS);
+    long now = 0;
+    measure("list erase + push_front", order, [&](const unsigned fd) {
+        last_active[fd] = ++now;
+        lru.erase(where[fd]);
+        lru.push_front(static_cast<int>(fd));
+        where[fd] = lru.begin();
+    }, &counting);
+
+    lru.clear();
+    for (size_t fd = 0; fd < CONNECTIONS; ++fd) {
+        lru.push_front(static_cast<int>(fd));
+        where[fd] = lru.begin();
+    }
+    measure("list splice", order, [&](const unsigned fd) {
+        last_active[fd] = ++now;
+        lru.splice(lru.begin(), lru, where[fd]);
+    }, &counting);
+
+    std::vector<Connection> connections(CONNECTIONS);
+    intrusive_list<Connection> chain;
+    for (size_t fd = 0; fd < CONNECTIONS; ++fd) {
+        connections[fd].fd = static_cast<int>(fd);
+        chain.push_front(connections[fd]);
+    }
+    measure("intrusive_list splice", order, [&](const unsigned fd) {
+        auto &connection = connections[fd];
+        connection.last_active = ++now;
+        chain.splice(chain.begin(), chain, connection);
+    }, nullptr);
+    chain.clear();
+    return 0;
+}
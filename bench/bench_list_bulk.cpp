@@ -0,0 +1,43 @@
+// 构造大 list：节点按批向分配器申请（allocate_bulk），与逐个 push_back 以及构造同样大小的 vector 比较
+#include <chrono>
+#include <iostream>
+#include "list.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+constexpr size_t ELEMENTS = 1000000;
+constexpr int ROUNDS = 10;
+
+template<class Function>
+void measure(const char *name, Function &&function) {
+    double best = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = round == 0 or ms < best ? ms : best;
+    }
+    std::cout << name << ": " << best << " ms" << std::endl;
+}
+
+int main() {
+    measure("vector(n, value) + destroy", [] {
+        vector<int> v(ELEMENTS, 1);
+    });
+    measure("list(n, value) + destroy (bulk)", [] {
+        list<int> l(ELEMENTS, 1);
+    });
+    measure("list push_back x n + destroy", [] {
+        list<int> l;
+        for (size_t i = 0; i < ELEMENTS; ++i) {
+            l.push_back(1);
+        }
+    });
+    list<int> source(ELEMENTS, 1);
+    measure("list copy + destroy (bulk)", [&source] {
+        list<int> l(source);
+    });
+    std::cout << MemoryPool::statistics();
+    return 0;
+}
@@ -0,0 +1,51 @@
+// 100 万个节点的 list：排序之后遍历顺序与节点地址无关，每一步都是一次缓存未命中；compact 之后按地址顺序遍历，与刚构造的链表比较
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "list.h"
+
+using namespace tinyWheels;
+
+constexpr size_t ELEMENTS = 1000000;
+constexpr int ROUNDS = 5;
+
+long long traverse(const list<int> &l) {
+    long long sum = 0;
+    for (auto it = l.begin(); it != l.end(); ++it) {
+        sum += (*it).data();
+    }
+    return sum;
+}
+
+// 多轮遍历取最快的一次
+void measure(const char *name, const list<int> &l) {
+    double best = 0;
+    long long sum = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        sum += traverse(l);
+        const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = round == 0 or ms < best ? ms : best;
+    }
+    std::cout << name << ": " << best << " ms (sum " << sum / ROUNDS << ")" << std::endl;
+}
+
+int main() {
+    std::mt19937 random(1);
+    list<int> fresh;
+    for (size_t i = 0; i < ELEMENTS; ++i) {
+        fresh.push_back(static_cast<int>(random() % 1000000));
+    }
+    measure("freshly built", fresh);
+
+    list<int> fragmented(fresh);
+    fragmented.sort();  // 只修改指针，遍历顺序变成随机的地址
+    measure("fragmented (after sort)", fragmented);
+
+    const auto start = std::chrono::steady_clock::now();
+    fragmented.compact();
+    const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "compact: " << ms << " ms" << std::endl;
+    measure("after compact", fragmented);
+    return 0;
+}
@@ -0,0 +1,70 @@
+// 1000 万个节点的 list 排序：自底向上归并只修改节点指针，与 std::list::sort 比较；同时确认排序过程中没有申请内存
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <random>
+#include "list.h"
+#include "memory_resource.h"
+
+using namespace tinyWheels;
+
+constexpr size_t ELEMENTS = 10000000;
+constexpr int ROUNDS = 3;
+
+// 统计申请次数
+class CountingResource final : public memory_resource {
+    size_t allocations_{0};
+public:
+    [[nodiscard]] size_t allocations() const {return allocations_;}
+protected:
+    void *do_allocate(const memory_size_type bytes, const memory_size_type alignment) override {
+        ++allocations_;
+        return get_default_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *address, const memory_size_type bytes, const memory_size_type alignment) override {
+        get_default_resource()->deallocate(address, bytes, alignment);
+    }
+};
+
+// 每一轮先构造（不计时），只测排序
+template<class Build, class Sort>
+void measure(const char *name, Build &&build, Sort &&sort) {
+    double best = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        auto l = build();
+        const auto start = std::chrono::steady_clock::now();
+        sort(l);
+        const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = round == 0 or ms < best ? ms : best;
+    }
+    std::cout << name << ": " << best << " ms" << std::endl;
+}
+
+int main() {
+    std::vector<int> values(ELEMENTS);
+    std::mt19937 random(1);
+    for (auto &value : values) {
+        value = static_cast<int>(random());
+    }
+
+    measure("tinyWheels::list::sort", [&values] {
+        list<int> l;
+        for (const auto value : values) {
+            l.push_back(value);
+        }
+        return l;
+    }, [](list<int> &l) {l.sort();});
+    measure("std::list::sort", [&values] {
+        return std::list<int>(values.begin(), values.end());
+    }, [](std::list<int> &l) {l.sort();});
+
+    CountingResource counting;
+    pmr::list<int> l(&counting);
+    for (const auto value : values) {
+        l.push_back(value);
+    }
+    const auto before = counting.allocations();
+    l.sort();
+    std::cout << "allocations during sort: " << counting.allocations() - before << std::endl;
+    return 0;
+}
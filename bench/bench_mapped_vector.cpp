@@ -0,0 +1,70 @@
+// 进程启动时的索引：每次从头构建 1000 万条记录的 vector<Record>，与打开上一次保存的 mapped_vector 比较
+// 打开只是映射文件、检查文件头；之后第一次扫描会触发缺页，数据在页缓存中时很快
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "mapped_vector.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+constexpr uint64_t RECORDS = 10000000;
+
+struct Record {
+    uint64_t key;
+    double score;
+    uint32_t offset;
+    uint32_t length;
+};
+
+Record make_record(const uint64_t i) {
+    // 模拟构建时的计算
+    return {i * 2654435761ULL, std::sqrt(static_cast<double>(i)), static_cast<uint32_t>(i * 40), static_cast<uint32_t>(i % 4096)};
+}
+
+double milliseconds(const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    const std::string path = "/tmp/bench_mapped_vector_" + std::to_string(getpid()) + ".bin";
+    unlink(path.c_str());
+    double checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        vector<Record> index;
+        for (uint64_t i = 0; i < RECORDS; ++i) {
+            index.push_back(make_record(i));
+        }
+        checksum += index[RECORDS / 2].score;
+    }
+    std::cout << "rebuild vector<Record>: " << milliseconds(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    {
+        mapped_vector<Record> index(path.c_str());
+        index.reserve(RECORDS);
+        for (uint64_t i = 0; i < RECORDS; ++i) {
+            index.push_back(make_record(i));
+        }
+        index.flush();
+    }
+    std::cout << "build mapped_vector + flush (once): " << milliseconds(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    const mapped_vector<Record> index(path.c_str(), true);
+    std::cout << "open mapped_vector read only: " << milliseconds(start) * 1000 << " us, " << index.size() << " records" << std::endl;
+    checksum += index[RECORDS / 2].score;
+
+    start = std::chrono::steady_clock::now();
+    for (const auto &record : index) {
+        checksum += record.length;
+    }
+    std::cout << "first full scan (page faults): " << milliseconds(start) << " ms" << std::endl;
+    std::cout << "checksum: " << checksum << std::endl;
+    unlink(path.c_str());
+    return 0;
+}
@@ -0,0 +1,68 @@
+// 对 parallel_for、parallel_reduce、parallel_transform、parallel_sort 在不同线程数下计时
+// 线程数从 1 翻倍到 hardware_concurrency（参与计算的还有调用线程，所以池中放 threads - 1 个线程），输出相对单线程的加速比
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+#include "parallel.h"
+
+using namespace tinyWheels;
+
+constexpr size_t SIZE = 20000000;
+
+template<class Function>
+double measure(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    std::mt19937_64 random(7);
+    vector<double> source(SIZE);
+    for (auto &value : source) {
+        value = static_cast<double>(random() % 1000000) / 7.0;
+    }
+    vector<double> output(SIZE);
+    vector<double> keys(SIZE);
+    double checksum = 0;  // 防止计算被优化掉
+
+    const size_t hardware = std::max(1U, std::thread::hardware_concurrency());
+    double base[4]{};
+    std::cout << "size: " << SIZE << ", hardware threads: " << hardware << std::endl;
+    for (size_t threads = 1; ; threads = std::min(threads * 2, hardware)) {
+        ThreadPoll pool(threads - 1, true);
+        double times[4];
+        times[0] = measure([&] {
+            parallel_for(pool, size_t(0), SIZE, [&](const size_t i) {output[i] = std::sqrt(source[i]) * 3.0;});
+        });
+        times[1] = measure([&] {
+            checksum += parallel_reduce(pool, output, 0.0);
+        });
+        times[2] = measure([&] {
+            parallel_transform(pool, source.begin(), source.end(), output.begin(), [](const double x) {return std::sin(x);});
+        });
+        std::copy(source.begin(), source.end(), keys.begin());
+        times[3] = measure([&] {
+            parallel_sort(pool, keys);
+        });
+        checksum += keys[SIZE / 2];
+        if (threads == 1) {
+            std::copy(times, times + 4, base);
+        }
+        std::cout << "threads " << threads << ":";
+        const char *names[] = {"for", "reduce", "transform", "sort"};
+        for (int i = 0; i < 4; ++i) {
+            std::cout << "  " << names[i] << " " << times[i] << " ms (x" << base[i] / times[i] << ")";
+        }
+        std::cout << std::endl;
+        pool.stop(true);
+        if (threads == hardware) {
+            break;
+        }
+    }
+    std::cout << "checksum: " << checksum << std::endl;
+    return 0;
+}
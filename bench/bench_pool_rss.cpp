@@ -0,0 +1,56 @@
+// 混合类型负载下的常驻内存（RSS）测试：许多不同的类型轮流申请、释放大量小对象
+// 每个 Allocator<T> 各自持有内存块时，每种类型的峰值内存都会一直保留；共享内存池后可以互相复用
+#include <cstdio>
+#include <iostream>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#include "allocator.h"
+
+using namespace tinyWheels;
+
+constexpr size_t OBJECTS = 200000;  // 每种类型同时存活的对象数量
+
+// 大小在 8~64 字节之间的一组不同类型，很多类型的大小相同，只是类型不同
+template<size_t I>
+struct Record {
+    char payload[(I % 8 + 1) * 8];
+};
+
+// 读取 /proc/self/statm 中的常驻内存页数，换算成 KB
+long rss_kb() {
+    long pages = 0, resident = 0;
+    if (FILE *f = fopen("/proc/self/statm", "r")) {
+        if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        fclose(f);
+    }
+    return resident * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+// 一个阶段：申请 OBJECTS 个 T，全部存活后再全部释放
+template<class T>
+void phase(std::vector<void *> &ptrs) {
+    for (size_t i = 0; i < OBJECTS; ++i) {
+        auto [ptr, cap] = Allocator<T>::allocate(1);
+        ptr->payload[0] = static_cast<char>(i);
+        ptrs[i] = ptr;
+    }
+    for (size_t i = 0; i < OBJECTS; ++i) {
+        Allocator<T>::deallocate(static_cast<T *>(ptrs[i]), 1);
+    }
+}
+
+template<size_t... I>
+void run_all(std::vector<void *> &ptrs, std::index_sequence<I...>) {
+    (phase<Record<I>>(ptrs), ...);
+}
+
+int main() {
+    std::vector<void *> ptrs(OBJECTS);
+    const auto before = rss_kb();
+    run_all(ptrs, std::make_index_sequence<32>{});
+    const auto after = rss_kb();
+    std::cout << "types: 32, objects per type: " << OBJECTS << std::endl;
+    std::cout << "RSS before: " << before << " KB, after: " << after << " KB, growth: " << after - before << " KB" << std::endl;
+    return 0;
+}
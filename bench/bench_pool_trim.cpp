@@ -0,0 +1,64 @@
+// 突发峰值下的常驻内存（RSS）测试：先申请大量小对象形成峰值，全部释放后比较 trim 前后的常驻内存
+// 没有 trim 时峰值内存会一直留在内存池中；trim 把完全空闲的大内存块还给操作系统
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "allocator.h"
+
+using namespace tinyWheels;
+
+constexpr size_t OBJECTS = 2000000;  // 峰值时同时存活的对象数量
+constexpr int BURSTS = 3;            // 峰值的次数
+
+struct Record {
+    char payload[48];
+};
+
+// 读取 /proc/self/statm 中的常驻内存页数，换算成 KB
+long rss_kb() {
+    long pages = 0, resident = 0;
+    if (FILE *f = fopen("/proc/self/statm", "r")) {
+        if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        fclose(f);
+    }
+    return resident * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+void burst(std::vector<Record *> &ptrs) {
+    for (size_t i = 0; i < OBJECTS; ++i) {
+        ptrs[i] = Allocator<Record>::allocate(1).first;
+        ptrs[i]->payload[0] = static_cast<char>(i);
+    }
+    for (size_t i = 0; i < OBJECTS; ++i) {
+        Allocator<Record>::deallocate(ptrs[i], 1);
+    }
+}
+
+int main() {
+    std::vector<Record *> ptrs(OBJECTS);
+    const auto before = rss_kb();
+    std::cout << "objects per burst: " << OBJECTS << ", RSS before: " << before << " KB" << std::endl;
+
+    for (int i = 0; i < BURSTS; ++i) {
+        burst(ptrs);
+        std::cout << "burst " << i << " freed, RSS: " << rss_kb() << " KB" << std::endl;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const auto released = MemoryPool::trim();
+    const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "trim released: " << released / 1024 << " KB in " << ms << " ms, RSS: " << rss_kb() << " KB" << std::endl;
+
+    // 后台清理线程：保留 8MB 的空闲大内存块，超出的部分由清理线程释放
+    MemoryPool::set_release_watermark(4 * MemoryPool::CHUNK_BYTES);
+    MemoryPool::start_scavenger(std::chrono::milliseconds(100));
+    burst(ptrs);
+    std::cout << "burst with scavenger freed, RSS: " << rss_kb() << " KB" << std::endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    MemoryPool::stop_scavenger();
+    std::cout << "after scavenger, RSS: " << rss_kb() << " KB" << std::endl;
+    std::cout << MemoryPool::statistics();
+    return 0;
+}
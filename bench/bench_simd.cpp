@@ -0,0 +1,103 @@
+// 连续内存上的查找与归约：逐个处理的标量循环、SSE2（128 位）与 AVX2（256 位）内核对比
+// 标量循环关闭了编译器的自动向量化，代表原来只能手写循环时的速度；find 找一个不存在的值，需要扫描整个区间
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include "algorithm.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+constexpr int ROUNDS = 5;
+
+namespace scalar {
+    // 与 algorithm.h 中的泛型版本相同，只是不允许编译器向量化
+#define SCALAR [[gnu::noinline, gnu::optimize("no-tree-vectorize")]]
+    template<class T> SCALAR size_t find(const T *data, const size_t n, const T value) {
+        for (size_t i = 0; i < n; ++i) if (data[i] == value) return i;
+        return n;
+    }
+    template<class T> SCALAR size_t count(const T *data, const size_t n, const T value) {
+        size_t rst = 0;
+        for (size_t i = 0; i < n; ++i) rst += data[i] == value;
+        return rst;
+    }
+    template<class T> SCALAR T min(const T *data, const size_t n) {
+        T rst = data[0];
+        for (size_t i = 1; i < n; ++i) rst = data[i] < rst ? data[i] : rst;
+        return rst;
+    }
+    template<class T> SCALAR sum_type_t<T> sum(const T *data, const size_t n) {
+        sum_type_t<T> rst = 0;
+        for (size_t i = 0; i < n; ++i) rst += data[i];
+        return rst;
+    }
+    template<class T> SCALAR sum_type_t<T> dot(const T *a, const T *b, const size_t n) {
+        sum_type_t<T> rst = 0;
+        for (size_t i = 0; i < n; ++i) rst += static_cast<sum_type_t<T>>(a[i]) * b[i];
+        return rst;
+    }
+#undef SCALAR
+}
+
+double sink = 0;  // 防止结果被优化掉
+
+// 每个操作跑 ROUNDS 次取最快的一次，返回 GB/s
+template<class Function>
+double measure(const size_t bytes, Function &&function) {
+    double best = 1e100;
+    for (int round = 0; round < ROUNDS; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        sink += static_cast<double>(function());
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return static_cast<double>(bytes) / best / 1e9;
+}
+
+template<class T>
+void run(const char *name, const size_t n) {
+    vector<T> a(n), b(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = static_cast<T>(i % 1000);
+        b[i] = static_cast<T>(i % 7);
+    }
+    const T *x = a.begin(), *y = b.begin();
+    const T missing = static_cast<T>(-1);
+    const size_t bytes = n * sizeof(T);
+
+    const char *operations[] = {"find", "count", "min", "minmax", "sum", "dot"};
+    double results[3][6];
+    results[0][0] = measure(bytes, [&] {return scalar::find(x, n, missing);});
+    results[0][1] = measure(bytes, [&] {return scalar::count(x, n, T(3));});
+    results[0][2] = measure(bytes, [&] {return scalar::min(x, n);});
+    results[0][3] = measure(bytes, [&] {return scalar::min(x, n);});  // 标量的 minmax 与 min 一样受限于依赖链，这里只作参照
+    results[0][4] = measure(bytes, [&] {return scalar::sum(x, n);});
+    results[0][5] = measure(2 * bytes, [&] {return scalar::dot(x, y, n);});
+    for (int level = 1; level <= 2; ++level) {
+        simd::enable_avx2(level == 2);
+        auto &row = results[level];
+        row[0] = measure(bytes, [&] {return find(a.begin(), a.end(), missing) - a.begin();});
+        row[1] = measure(bytes, [&] {return count(a.begin(), a.end(), T(3));});
+        row[2] = measure(bytes, [&] {return *min_element(a.begin(), a.end());});
+        row[3] = measure(bytes, [&] {return *minmax_element(a.begin(), a.end()).second;});
+        row[4] = measure(bytes, [&] {return sum(a.begin(), a.end());});
+        row[5] = measure(2 * bytes, [&] {return dot(a.begin(), a.end(), b.begin());});
+    }
+    simd::enable_avx2(true);
+
+    std::cout << name << ", " << n << " elements (GB/s, scalar / sse2 / avx2):" << std::endl;
+    for (int op = 0; op < 6; ++op) {
+        std::cout << "  " << operations[op] << ": " << results[0][op] << " / " << results[1][op] << " / " << results[2][op]
+                  << "  (" << results[2][op] / results[0][op] << "x)" << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "avx2 supported: " << simd::avx2_supported() << std::endl;
+    for (const size_t n : {size_t(1) << 20, size_t(10000000), size_t(100000000)}) {
+        run<int32_t>("int32_t", n);
+        run<float>("float", n);
+    }
+    std::cout << "sink: " << sink << std::endl;
+    return 0;
+}
@@ -0,0 +1,43 @@
+// 每个连接对象里有一个通常只有几个元素的数组：分别用 vector 与 small_vector<int, 8>
+// 反复构造连接、放入 4 个元素、遍历、析构，比较每个连接的耗时以及内存池的申请量
+#include <chrono>
+#include <iostream>
+#include "small_vector.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+constexpr int CONNECTIONS = 5000000;
+constexpr int ELEMENTS = 4;
+
+template<class Container>
+struct Connection {
+    int fd;
+    Container events;
+};
+
+long checksum = 0;  // 防止整个循环被优化掉
+
+template<class Container>
+void run(const char *name) {
+    const auto before = Allocator<int>::statistics().allocated_bytes;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < CONNECTIONS; ++i) {
+        Connection<Container> connection{i, Container()};
+        for (int j = 0; j < ELEMENTS; ++j) {
+            connection.events.push_back(i + j);
+        }
+        for (const auto event : connection.events) {
+            checksum += event;
+        }
+    }
+    const auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / CONNECTIONS;
+    std::cout << name << ": " << ns << " ns/connection, pool bytes " << Allocator<int>::statistics().allocated_bytes - before << std::endl;
+}
+
+int main() {
+    run<vector<int>>("vector<int>");
+    run<small_vector<int, 8>>("small_vector<int, 8>");
+    std::cout << "checksum: " << checksum << std::endl;
+    return 0;
+}
@@ -0,0 +1,65 @@
+// 1000 万条 64 字节的记录只扫描价格一列：vector<Record> 每读 8 字节要把整条记录读进缓存，
+// soa_vector 的价格列是连续的 double 数组，逐行访问与交给 sum 向量化求和分别计时
+#include <array>
+#include <chrono>
+#include <iostream>
+#include "algorithm.h"
+#include "soa_vector.h"
+
+using namespace tinyWheels;
+
+constexpr size_t ROWS = 10000000;
+constexpr int ROUNDS = 5;
+
+struct Record {
+    int id;
+    int quantity;
+    double price;
+    std::array<char, 48> note;
+};
+
+template<class Function>
+double measure(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i) {
+        function();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / ROUNDS;
+}
+
+int main() {
+    vector<Record> records(ROWS);
+    soa_vector<int, int, double, std::array<char, 48>> columns(ROWS);
+    for (size_t i = 0; i < ROWS; ++i) {
+        const auto price = static_cast<double>(i % 1000) / 8.0;
+        records[i].id = static_cast<int>(i);
+        records[i].price = price;
+        columns.get<0>(i) = static_cast<int>(i);
+        columns.get<2>(i) = price;
+    }
+
+    double checksum = 0;  // 防止求和被优化掉
+    const auto aos = measure([&] {
+        double total = 0;
+        for (const auto &record : records) {
+            total += record.price;
+        }
+        checksum += total;
+    });
+    const auto soa_rows = measure([&] {
+        double total = 0;
+        for (const auto row : columns) {
+            total += row.get<2>();
+        }
+        checksum += total;
+    });
+    const auto soa_column = measure([&] {
+        const auto prices = columns.column<2>();
+        checksum += sum(prices.begin(), prices.end());
+    });
+    std::cout << "vector<Record> (" << sizeof(Record) << " bytes/row): " << aos << " ms" << std::endl;
+    std::cout << "soa_vector by row: " << soa_rows << " ms" << std::endl;
+    std::cout << "soa_vector column sum: " << soa_column << " ms" << std::endl;
+    std::cout << "checksum: " << checksum << std::endl;
+    return 0;
+}
@@ -0,0 +1,80 @@
+// 1000 万个 int：vector、list、unrolled_list 的遍历时间与每个元素占用的内存
+// unrolled_list 分别用迭代器与 for_each_segment 遍历，后者每个节点内部是对数组的循环
+#include <chrono>
+#include <iostream>
+#include "list.h"
+#include "memory_resource.h"
+#include "unrolled_list.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+constexpr size_t ELEMENTS = 10000000;
+constexpr int ROUNDS = 5;
+
+// 统计申请的字节数
+class CountingResource final : public memory_resource {
+    size_t bytes_{0};
+public:
+    [[nodiscard]] size_t bytes() const {return bytes_;}
+protected:
+    void *do_allocate(const memory_size_type bytes, const memory_size_type alignment) override {
+        bytes_ += bytes;
+        return get_default_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *address, const memory_size_type bytes, const memory_size_type alignment) override {
+        bytes_ -= bytes;
+        get_default_resource()->deallocate(address, bytes, alignment);
+    }
+};
+
+// 多轮遍历取最快的一次
+template<class Scan>
+void measure(const char *name, Scan &&scan, const size_t bytes) {
+    double best = 0;
+    long long sum = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        sum += scan();
+        const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = round == 0 or ms < best ? ms : best;
+    }
+    std::cout << name << ": " << best << " ms, " << static_cast<double>(bytes) / ELEMENTS << " bytes/element (sum " << sum / ROUNDS << ")" << std::endl;
+}
+
+int main() {
+    CountingResource vector_bytes, list_bytes, unrolled_bytes;
+    pmr::vector<int> v(&vector_bytes);
+    pmr::list<int> l(&list_bytes);
+    pmr::unrolled_list<int> u(&unrolled_bytes);
+    for (size_t i = 0; i < ELEMENTS; ++i) {
+        const auto value = static_cast<int>(i % 1000);
+        v.push_back(value);
+        l.push_back(value);
+        u.push_back(value);
+    }
+
+    measure("vector", [&v] {
+        long long sum = 0;
+        for (const auto value : v) sum += value;
+        return sum;
+    }, vector_bytes.bytes());
+    measure("list", [&l] {
+        long long sum = 0;
+        for (auto it = l.begin(); it != l.end(); ++it) sum += (*it).data();
+        return sum;
+    }, list_bytes.bytes());
+    measure("unrolled_list iterator", [&u] {
+        long long sum = 0;
+        for (const auto value : u) sum += value;
+        return sum;
+    }, unrolled_bytes.bytes());
+    measure("unrolled_list for_each_segment", [&u] {
+        long long sum = 0;
+        u.for_each_segment([&sum](const span<const int> segment) {
+            for (const auto value : segment) sum += value;
+        });
+        return sum;
+    }, unrolled_bytes.bytes());
+    return 0;
+}
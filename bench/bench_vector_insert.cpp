@@ -0,0 +1,53 @@
+// 1000 万个元素的 vector：在中间反复插入、删除，以及从空开始连续 push_back
+// 平凡可重定位的元素用 memmove / memcpy 整体搬移，声明为不可重定位的同样大小的元素只能逐个移动构造再析构
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include "vector.h"
+
+using namespace tinyWheels;
+
+constexpr size_t ELEMENTS = 10000000;
+constexpr int INSERTS = 100;  // 每次插入都要搬移后一半的 500 万个元素
+
+// 与 uint64_t 一样大，但是声明为不可重定位
+struct Pinned {
+    uint64_t value;
+    Pinned() = default;
+    Pinned(const uint64_t value) : value(value) {}
+    Pinned(const Pinned &other) : value(other.value) {}
+    Pinned &operator=(const Pinned &other) = default;
+};
+template<>
+struct tinyWheels::is_trivially_relocatable<Pinned> : std::false_type {};
+
+template<class Function>
+double measure(Function &&function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<class T>
+void run(const char *name) {
+    vector<T> v;
+    const auto grow = measure([&v] {
+        for (size_t i = 0; i < ELEMENTS; ++i) {
+            v.push_back(T(i));
+        }
+    });
+    const auto insert = measure([&v] {
+        for (int i = 0; i < INSERTS; ++i) {
+            v.insert(v.begin() + v.size() / 2, T(i));
+            v.erase(v.begin() + v.size() / 2);
+        }
+    });
+    std::cout << name << ": push_back " << grow << " ms, insert + erase in middle " << insert / INSERTS
+              << " ms/op" << std::endl;
+}
+
+int main() {
+    run<uint64_t>("memmove (uint64_t)");
+    run<Pinned>("element-wise (Pinned)");
+    return 0;
+}
@@ -0,0 +1,53 @@
+// 超大 vector 的扩容：平凡可重定位的类型由分配器整体搬移（mremap 只改页表），其他类型申请新内存后逐个移动
+// 用同样大小的两种元素连续 push_back，比较总耗时以及最慢的一次扩容
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include "vector.h"
+
+using namespace tinyWheels;
+
+constexpr size_t ELEMENTS = size_t(1) << 26;  // 512MB 的 uint64_t
+
+// 与 uint64_t 一样大，但是声明为不可重定位，扩容时只能逐个移动
+struct Pinned {
+    uint64_t value;
+    Pinned() = default;
+    Pinned(const uint64_t value) : value(value) {}
+};
+template<>
+struct tinyWheels::is_trivially_relocatable<Pinned> : std::false_type {};
+
+template<class T>
+void grow(const char *name) {
+    vector<T> v;
+    double slowest = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ELEMENTS; ++i) {
+        if (v.size() != v.capacity()) {
+            v.push_back(T(i));
+            continue;
+        }
+        const auto before = std::chrono::steady_clock::now();  // 这一次 push_back 需要扩容
+        v.push_back(T(i));
+        const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - before).count();
+        slowest = ms > slowest ? ms : slowest;
+    }
+    const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << ms << " ms total, slowest growth " << slowest << " ms, capacity " << v.capacity() << std::endl;
+}
+
+int main() {
+    std::cout << "default (malloc + realloc):" << std::endl;
+    grow<uint64_t>("  trivially relocatable");
+    grow<Pinned>("  element-wise move");
+
+    MmapChunkProvider provider(false);
+    MemoryPool::set_chunk_provider(&provider);
+    std::cout << "mmap (mremap):" << std::endl;
+    grow<uint64_t>("  trivially relocatable");
+    grow<Pinned>("  element-wise move");
+    MemoryPool::set_chunk_provider(nullptr);
+    std::cout << MemoryPool::statistics();
+    return 0;
+}
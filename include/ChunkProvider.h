@@ -0,0 +1,61 @@
+//
+// Created by 24983 on 25-3-10.
+//
+
+#ifndef CHUNKPROVIDER_H
+#define CHUNKPROVIDER_H
+
+#include <cstddef>
+
+namespace tinyWheels {
+    // 大内存块来源：内存池的大内存块以及超大的内存块都从这里申请，可以替换成不同的实现
+    class ChunkProvider {
+    public:
+        using memory_size_type = size_t;
+
+        virtual ~ChunkProvider() = default;
+        // 申请 bytes 字节、按 alignment 对齐的内存，失败返回 nullptr，由调用者决定是否回退
+        virtual void *allocate(memory_size_type bytes, memory_size_type alignment) = 0;
+        // 释放 allocate 得到的内存，bytes 必须与申请时相同
+        virtual void release(void *address, memory_size_type bytes) = 0;
+        // 把申请的大小向上取整到该来源的粒度，例如页或者大页，多出来的部分内存池也会用上
+        [[nodiscard]] virtual memory_size_type round_up(const memory_size_type bytes) const {return bytes;}
+        // 把 allocate 得到的内存调整为 new_bytes 字节，内容按字节保留，位置可以改变；
+        // 不支持或者失败时返回 nullptr，原来的内存保持不变
+        virtual void *reallocate(void *, memory_size_type, memory_size_type, memory_size_type) {return nullptr;}
+        // 在原来的位置把内存扩展到 new_bytes 字节，不支持或者后面的地址已被占用时返回 false
+        virtual bool expand(void *, memory_size_type, memory_size_type) {return false;}
+    };
+
+    // 使用 malloc / aligned_alloc 获取内存，是默认的来源，也是其他来源失败时的回退
+    class MallocChunkProvider final : public ChunkProvider {
+    public:
+        void *allocate(memory_size_type bytes, memory_size_type alignment) override;
+        void release(void *address, memory_size_type bytes) override;
+        // realloc，glibc 对 mmap 出来的大块内存会用 mremap；对齐超过 max_align_t 时 realloc 不保证对齐，返回 nullptr
+        void *reallocate(void *address, memory_size_type old_bytes, memory_size_type new_bytes, memory_size_type alignment) override;
+
+        static MallocChunkProvider& instance();
+    };
+
+    // 使用 mmap 获取按页对齐的内存，huge_pages 为 true 时按 2MB 对齐并通过 MADV_HUGEPAGE 请求透明大页，
+    // 一个跨越几百 MB 的 vector 只需要很少的页表项，随机访问时页表遍历更少
+    class MmapChunkProvider final : public ChunkProvider {
+        bool huge_pages_;
+    public:
+        constexpr static memory_size_type HUGE_PAGE_BYTES = 2 * 1024 * 1024;  // x86-64 透明大页大小
+
+        explicit MmapChunkProvider(bool huge_pages = true) : huge_pages_(huge_pages) {}
+        void *allocate(memory_size_type bytes, memory_size_type alignment) override;
+        void release(void *address, memory_size_type bytes) override;
+        [[nodiscard]] memory_size_type round_up(memory_size_type bytes) const override;
+        // mremap 只修改页表，不复制数据，几个 GB 的内存也只需要很短的时间；对齐超过页大小时不保证，返回 nullptr
+        void *reallocate(void *address, memory_size_type old_bytes, memory_size_type new_bytes, memory_size_type alignment) override;
+        bool expand(void *address, memory_size_type old_bytes, memory_size_type new_bytes) override;
+        [[nodiscard]] bool huge_pages() const {return huge_pages_;}
+
+        static memory_size_type page_bytes();
+    };
+}
+
+#endif //CHUNKPROVIDER_H
@@ -0,0 +1,61 @@
+//
+// Created by 24983 on 25-3-14.
+//
+
+#ifndef HEAPPROFILER_H
+#define HEAPPROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <typeinfo>
+
+namespace tinyWheels {
+    // 采样堆分析器：Allocator<T>::allocate 平均每申请 sample_bytes 字节记录一次调用栈、类型名以及大小类别，
+    // 用来找出是哪些调用点让内存池不停地申请大内存块。默认关闭，start() 之后才采样
+    // 采样间隔服从均值为 sample_bytes 的指数分布，与 tcmalloc 相同，小对象和大对象都不会被系统性地漏掉；
+    // 导出时按 1 / (1 - exp(-size / sample_bytes)) 还原出估计的申请次数与字节数
+    // 记录的是累计申请量（alloc_objects / alloc_space），释放不经过分析器，所以没有常驻量
+    class HeapProfiler {
+    public:
+        using memory_size_type = size_t;
+        constexpr static memory_size_type DEFAULT_SAMPLE_BYTES = 512 * 1024;  // 与 tcmalloc 的默认值相同
+        constexpr static int MAX_DEPTH = 32;                                  // 每个样本最多记录的栈帧数
+
+        // 开始采样，已经记录的样本保留，需要清空时调用 reset()
+        static void start(memory_size_type sample_bytes = DEFAULT_SAMPLE_BYTES);
+        static void stop();
+        static void reset();
+        [[nodiscard]] static bool running() {return running_.load(std::memory_order_relaxed);}
+        [[nodiscard]] static memory_size_type sample_bytes() {return sample_bytes_.load(std::memory_order_relaxed);}
+        [[nodiscard]] static size_t samples();  // 已经记录的样本个数（按调用栈、类型、大小类别合并之前）
+
+        // 分配路径上的钩子：关闭时只有一次 relaxed 读；开启时再加一次线程局部的减法，计数用完才进入 record
+        // size_class 是内存池的内存块大小，大于 THRESHOLD 的内存传 0
+        static void sample(const memory_size_type bytes, const std::type_info &type, const memory_size_type size_class) {
+            if (not running_.load(std::memory_order_relaxed)) [[likely]] {
+                return;
+            }
+            bytes_until_sample_ -= static_cast<int64_t>(bytes);
+            if (bytes_until_sample_ < 0) [[unlikely]] {
+                record(bytes, type, size_class);
+            }
+        }
+
+        // 折叠栈格式，每行 "调用者;...;被调用者;类型 [大小类别] 估计字节数"，可以直接交给 flamegraph.pl
+        // 可执行文件需要用 -rdynamic 链接才能看到函数名，否则只有模块名与偏移
+        static void dump_folded(std::ostream &os);
+        // pprof 的旧版堆分析格式（heap_v2），附带 /proc/self/maps，用 pprof -sample_index=alloc_space <程序> <文件> 查看
+        static void dump_pprof(std::ostream &os);
+    private:
+        static std::atomic<bool> running_;
+        static std::atomic<memory_size_type> sample_bytes_;
+        // 距离下一次采样还剩的字节数；放在头文件中定义并且常量初始化，访问时不需要经过线程局部变量的初始化函数
+        inline static thread_local int64_t bytes_until_sample_ = 0;
+
+        static void record(memory_size_type bytes, const std::type_info &type, memory_size_type size_class);
+    };
+}
+
+#endif //HEAPPROFILER_H
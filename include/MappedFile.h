@@ -0,0 +1,47 @@
+//
+// Created by 24983 on 25-3-20.
+//
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+
+namespace tinyWheels {
+    // 把整个文件 mmap(MAP_SHARED) 到内存，对映射的修改就是对文件的修改；mapped_vector 使用
+    // 打开、扩展失败时抛出异常，析构时只 munmap，不保证数据已经写到磁盘，需要时先调用 flush
+    class MappedFile {
+    public:
+        using memory_size_type = size_t;
+        enum class Mode {
+            READ_ONLY,   // 只读映射，文件必须存在
+            READ_WRITE,  // 读写映射，文件不存在时创建一个空文件
+        };
+    private:
+        int fd_{-1};
+        void *data_{nullptr};  // 文件为空时是 nullptr，长度为 0 的映射不合法
+        memory_size_type bytes_{0};
+        bool writable_{false};
+    public:
+        MappedFile() = default;
+        MappedFile(const char *path, Mode mode);
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&another) noexcept;
+        MappedFile &operator=(MappedFile &&another) noexcept;
+        ~MappedFile();
+
+        [[nodiscard]] void *data() const {return data_;}
+        [[nodiscard]] memory_size_type bytes() const {return bytes_;}
+        [[nodiscard]] bool writable() const {return writable_;}
+        [[nodiscard]] bool is_open() const {return fd_ >= 0;}
+
+        // ftruncate 把文件调整为 bytes 字节，再 mremap 映射，原来的内容保留，映射的地址可能改变；新增的部分是 0
+        void resize(memory_size_type bytes);
+        // msync 把修改过的页写回文件，async 为 true 时只发起写回不等待
+        void flush(bool async = false) const;
+        void close();
+    };
+}
+
+#endif //MAPPEDFILE_H
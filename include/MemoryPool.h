@@ -0,0 +1,258 @@
+//
+// Created by 24983 on 25-3-8.
+//
+
+#ifndef MEMORYPOOL_H
+#define MEMORYPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include "ChunkProvider.h"
+
+namespace tinyWheels {
+    // 进程级内存池：按字节大小类别管理小内存块，与类型无关，所有 Allocator<T> 都转发到这里
+    // 这样 vector<int>、vector<float>、string、list<T> 的节点可以共用同一批大内存块，释放的 32 字节内存块可以服务任意类型
+    class MemoryPool {
+        union OBJ{
+            OBJ* next;
+            char data[1];
+        };
+    public:
+        using memory_size_type = size_t;     // 表示内存大小的变量类型
+        using array_index = size_t;      // 表示数组索引的变量类型
+        using block_number = size_t;      // 表示块数量的变量类型
+    private:
+        using memory_content = OBJ;     // 内存块存储的内容
+        using null_ptr_type = void *;  // 空指针类型
+        using memory_ptr_type = char *; // 地址指针类型
+
+        constexpr static auto PTR_BYTES = sizeof(null_ptr_type);
+    public:
+        // 对齐大小，所有的块内存都是 ALIGN 的倍数，必须是 2 的次方并且能存下一个指针
+        constexpr static memory_size_type ALIGN = PTR_BYTES;
+        // 阈值，大于阈值的内存不由内存池管理，直接从堆中获取
+        constexpr static memory_size_type THRESHOLD = 32 * PTR_BYTES;
+        constexpr static block_number BLOCK_NUMBER = 20;  // 每次从堆中获取的内存块数量
+        constexpr static block_number MAGAZINE_ROUNDS = 16;  // 每个弹匣最多容纳的内存块数量
+        constexpr static memory_size_type CACHE_LINE_BYTES = 64;  // 缓存行大小，线程缓存按缓存行对齐，避免伪共享
+        constexpr static array_index FREE_LIST_LENGTH = THRESHOLD / ALIGN;  // 大小类别的数量
+        constexpr static memory_size_type LARGE_ALIGN = alignof(std::max_align_t);  // malloc 保证的对齐
+        // 不小于该值的大内存块从 ChunkProvider 获取，例如几百 MB 的 vector 可以用上大页，更小的直接 malloc
+        constexpr static memory_size_type LARGE_CHUNK_THRESHOLD = 1024 * 1024;
+        // 内存池每个大内存块的大小，同时也是它的对齐，任意内存块的地址抹掉低位就能找到所在大内存块的头部
+        // 取 2MB 与透明大页一致，使用 MmapChunkProvider 时一个大内存块正好是一个大页
+        constexpr static memory_size_type CHUNK_BYTES = 2 * 1024 * 1024;
+
+        // 计算最小需要获取的字节并向上取 ALIGN 的倍数整
+        constexpr static memory_size_type round_up(memory_size_type memory_bytes) {
+            memory_bytes = memory_bytes == 0 ? 1 : memory_bytes;
+            return ((memory_bytes + ALIGN - 1) & ~(ALIGN - 1));
+        }
+        // 计算在自由链表中的索引
+        constexpr static array_index getIndex(const memory_size_type memory_bytes) {return round_up(memory_bytes) / ALIGN - 1;}
+
+        // 统计快照：所有计数器都是常开的，分配路径上只有本线程的计数器自增，没有任何 I/O
+        struct Statistics {
+            struct SizeClass {
+                memory_size_type block_bytes{0};  // 该类别的内存块大小
+                size_t hits{0};     // 线程缓存直接满足的分配次数
+                size_t misses{0};   // 需要加锁访问仓库的分配次数
+            };
+            SizeClass size_classes[FREE_LIST_LENGTH]{};
+            size_t chunk_refills{0};                // 申请大内存块的次数
+            memory_size_type reserved_bytes{0};     // 大内存块从操作系统获取的字节数
+            size_t released_chunks{0};              // trim 还给操作系统的大内存块数量
+            memory_size_type released_bytes{0};     // trim 还给操作系统的字节数
+            memory_size_type allocated_bytes{0};    // 交给使用者的小内存块字节数（对齐后）
+            memory_size_type deallocated_bytes{0};  // 使用者归还的小内存块字节数（对齐后）
+            size_t large_allocations{0};            // 大于 THRESHOLD 直接 malloc 的次数
+            memory_size_type large_bytes{0};        // 大于 THRESHOLD 直接 malloc 的字节数
+            size_t large_reallocations{0};          // 大内存块原地扩展或者 mremap / realloc 的次数
+
+            [[nodiscard]] memory_size_type in_use_bytes() const {return allocated_bytes - deallocated_bytes;}
+            [[nodiscard]] memory_size_type retained_bytes() const {return reserved_bytes - released_bytes;}
+            friend std::ostream& operator<<(std::ostream& os, const Statistics& stats);
+        };
+
+        // 分配一个 round_up(memory_bytes) 字节的内存块，memory_bytes 不能超过 THRESHOLD
+        static void *allocate(memory_size_type memory_bytes);
+        // 释放 allocate(memory_bytes) 得到的内存块
+        static void deallocate(void *block, memory_size_type memory_bytes);
+        // 一次申请 number 个 round_up(memory_bytes) 字节的内存块写入 blocks，memory_bytes 不能超过 THRESHOLD
+        // 先取线程缓存，剩下的只加一次锁：整个取走仓库中的满弹匣，再从自由链表中取，最后直接从大内存块中连续切分
+        static void allocate_bulk(memory_size_type memory_bytes, void **blocks, size_t number);
+        // 一次释放 number 个内存块，线程缓存装不下的部分只加一次锁放回自由链表
+        static void deallocate_bulk(void **blocks, memory_size_type memory_bytes, size_t number);
+        // 大于 THRESHOLD 的内存直接从堆中获取，按 alignment 对齐，经过内存池只是为了统计
+        static void *allocate_large(memory_size_type memory_bytes, memory_size_type alignment = LARGE_ALIGN);
+        // memory_bytes 与 alignment 必须与申请时相同
+        static void deallocate_large(void *block, memory_size_type memory_bytes, memory_size_type alignment = LARGE_ALIGN);
+        // 按 alignment 对齐的内存，alignment 必须是 2 的幂，例如 SIMD 需要的 32、64 字节或者缓存行
+        // alignment 不超过 ALIGN 时与 allocate / allocate_large 相同；小内存块多申请 alignment 字节，对齐之后把原地址放在前面
+        static void *allocate_aligned(memory_size_type memory_bytes, memory_size_type alignment);
+        static void deallocate_aligned(void *block, memory_size_type memory_bytes, memory_size_type alignment);
+        // 把 allocate_large 得到的内存原地扩展到 new_bytes 字节，成功返回 true，之后按 new_bytes 释放
+        // 只有不小于 LARGE_CHUNK_THRESHOLD 的内存块可能成功：来源取整多出来的部分，或者来源支持原地扩展（mremap）
+        static bool try_expand_large(void *block, memory_size_type memory_bytes, memory_size_type new_bytes, memory_size_type alignment = LARGE_ALIGN);
+        // 把 allocate_large 得到的内存调整为 new_bytes 字节，内容按字节保留，不逐个移动对象（mremap 或 realloc）
+        // 新旧大小不在同一条分配路径上、或者来源不支持时返回 nullptr，原内存块保持不变，由调用者申请新内存再移动
+        static void *reallocate_large(void *block, memory_size_type memory_bytes, memory_size_type new_bytes, memory_size_type alignment = LARGE_ALIGN);
+        // 销毁所有的内存块，调用时不能有其他线程正在使用内存池
+        static void destroy_all();
+
+        // 设置大内存块来源，nullptr 表示使用默认的 MallocChunkProvider，provider 的生命周期必须长于内存池的使用
+        // 每个大内存块都记录了自己的来源，所以替换来源之后，之前申请的内存仍然会还给原来的来源
+        static void set_chunk_provider(ChunkProvider *provider);
+        [[nodiscard]] static ChunkProvider *get_chunk_provider();
+
+        // 汇总所有线程的计数器，得到一份统计快照
+        [[nodiscard]] static Statistics statistics();
+
+        // 把完全空闲的大内存块还给操作系统，最多保留 keep_bytes 字节的空闲大内存块应对下一次峰值，返回释放的字节数
+        // 仓库与本线程缓存中的内存块会先倒回自由链表，其他线程缓存中的内存块仍然占着所在的大内存块
+        static memory_size_type trim(memory_size_type keep_bytes);
+        // 使用水位线作为 keep_bytes：空闲大内存块超过水位线的部分才会释放
+        static memory_size_type trim();
+        static void set_release_watermark(memory_size_type bytes);
+        [[nodiscard]] static memory_size_type get_release_watermark();
+
+        // 后台清理线程：每隔 interval 调用一次 trim()，重复启动只会更新间隔
+        static void start_scavenger(std::chrono::milliseconds interval);
+        static void stop_scavenger();
+
+        MemoryPool() = delete;
+        MemoryPool(const MemoryPool&) = delete;
+        MemoryPool(MemoryPool&&) = delete;
+        MemoryPool& operator=(const MemoryPool&) = delete;
+        MemoryPool& operator=(MemoryPool&&) = delete;
+        ~MemoryPool() = default;
+    private:
+        static memory_content free_list_head[FREE_LIST_LENGTH];  // 自由链表，存储的是内存块的指针
+
+        // 大内存块头部，放在每个大内存块（以及从 ChunkProvider 获取的超大内存块）的最前面
+        // carved_bytes 与 free_bytes 记录占用情况，两者相等说明切分出去的内存块全部回到了自由链表
+        struct ChunkHeader {
+            ChunkHeader *next;        // 下一个大内存块
+            ChunkProvider *provider;  // 申请该大内存块的来源，释放时还给它
+            memory_size_type bytes;   // 向来源申请的总字节数，包括头部
+            memory_size_type carved_bytes;  // 已经切分成内存块的字节数
+            memory_size_type free_bytes;    // 位于自由链表中的字节数
+            bool releasing;           // trim 时标记即将释放的大内存块
+        };
+        // 头部占一个缓存行，保证后面的内存块仍然按缓存行对齐
+        constexpr static memory_size_type CHUNK_HEADER_BYTES = CACHE_LINE_BYTES;
+        static_assert(sizeof(ChunkHeader) <= CHUNK_HEADER_BYTES);
+
+        static std::atomic<ChunkProvider *> chunk_provider;  // 当前的大内存块来源
+        static ChunkHeader *chunks;             // 所有大内存块串成的链表，由 depot_mutex 保护
+        static ChunkHeader *current_chunk;      // 正在切分的大内存块，trim 不会释放它
+        static memory_size_type left_memory_bytes;   // 当前大内存块中剩余的内存大小
+        static memory_ptr_type current_memory;  // 当前可申请的内存块起始地址
+
+        // 弹匣：固定容量的内存块栈，线程缓存与仓库之间按整个弹匣交换内存块
+        struct Magazine {
+            Magazine *next{nullptr};  // 在仓库中串成链表
+            block_number rounds{0};   // 当前弹匣中的内存块数量
+            memory_content *blocks[MAGAZINE_ROUNDS]{};
+            [[nodiscard]] bool empty() const {return rounds == 0;}
+            [[nodiscard]] bool full() const {return rounds == MAGAZINE_ROUNDS;}
+        };
+
+        // 线程计数器：只有所属线程会写，用 relaxed 的读+写代替原子加，统计快照可以安全地并发读取
+        struct Counters {
+            using counter_type = std::atomic<size_t>;
+            counter_type hits[FREE_LIST_LENGTH]{};
+            counter_type misses[FREE_LIST_LENGTH]{};
+            counter_type allocated_bytes{0};
+            counter_type deallocated_bytes{0};
+            counter_type large_allocations{0};
+            counter_type large_bytes{0};
+            counter_type large_reallocations{0};
+
+            static void add(counter_type& counter, const size_t n = 1) {
+                counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+            void collect(Statistics& stats) const;  // 把计数累加到 stats 中
+        };
+
+        // 线程缓存：每个线程每个大小类别持有 loaded 与 previous 两个弹匣，previous 要么是满的要么是空的
+        // 分配与释放只操作本线程的弹匣，不加锁，整个结构按缓存行对齐，不与其他线程共享缓存行
+        struct alignas(CACHE_LINE_BYTES) ThreadCache {
+            Magazine *loaded[FREE_LIST_LENGTH]{};
+            Magazine *previous[FREE_LIST_LENGTH]{};
+            Counters counters;
+            ThreadCache *prev{nullptr};  // 所有线程缓存串成双向链表，统计时遍历
+            ThreadCache *next{nullptr};
+            ThreadCache();   // 线程第一次使用内存池时登记到链表中
+            ~ThreadCache();  // 线程退出时把弹匣还给仓库，计数并入 retired_statistics
+        };
+        static thread_local ThreadCache thread_cache;
+
+        // 统计：stats_mutex 保护线程缓存链表和已退出线程的计数
+        static std::mutex stats_mutex;
+        static ThreadCache *thread_caches;
+        static Statistics retired_statistics;
+        static size_t chunk_refills;              // 由 depot_mutex 保护
+        static memory_size_type reserved_bytes;   // 由 depot_mutex 保护
+        static size_t released_chunks;            // 由 depot_mutex 保护
+        static memory_size_type released_bytes;   // 由 depot_mutex 保护
+        static std::atomic<memory_size_type> release_watermark;
+
+        // 后台清理线程，析构时自动停止，程序退出前不必手动调用 stop_scavenger
+        struct Scavenger {
+            std::mutex control;  // 串行化启动与停止
+            std::mutex mutex;    // 保护 interval 与 running
+            std::condition_variable cv;
+            std::thread thread;
+            std::chrono::milliseconds interval{0};
+            bool running{false};
+            void run();
+            void stop();
+            ~Scavenger() {stop();}
+        };
+        static Scavenger scavenger;
+
+        // 仓库：所有线程共享，按大小类别保存满弹匣与空弹匣，depot_mutex 同时保护自由链表和大内存块
+        static std::mutex depot_mutex;
+        static Magazine *depot_full[FREE_LIST_LENGTH];
+        static Magazine *depot_empty[FREE_LIST_LENGTH];
+
+        static void depot_push(Magazine **depot, Magazine *magazine);
+        static Magazine *depot_pop(Magazine **depot);
+
+        static memory_content *cache_pop(array_index index);  // 从线程缓存中取出一个内存块
+        static void cache_push(array_index index, memory_content *block);  // 把一个内存块放回线程缓存
+        static memory_content *central_allocate(array_index index);  // 从自由链表中取出一个内存块，需要持有 depot_mutex
+        static void central_allocate_bulk(array_index index, void **blocks, size_t number);  // 取出 number 个内存块，需要持有 depot_mutex
+        static void drain(Magazine *magazine, array_index index);  // 把弹匣中的内存块全部还给自由链表，需要持有 depot_mutex
+
+        // 内存块所在的大内存块，只对内存池切分出来的内存块有效
+        static ChunkHeader *chunk_of(const void *block) {
+            return reinterpret_cast<ChunkHeader *>(reinterpret_cast<uintptr_t>(block) & ~(CHUNK_BYTES - 1));
+        }
+
+        // 从当前来源申请至少 bytes 字节的内存并写好头部，来源失败时回退到 malloc
+        static ChunkHeader *provide(memory_size_type bytes, memory_size_type alignment);
+        static void release(ChunkHeader *chunk);
+        // 超大内存块中数据相对头部的偏移：至少一个缓存行，对齐更大时取 alignment，偏移本身也是申请时的对齐
+        static memory_size_type large_offset(const memory_size_type alignment) {
+            return alignment > CHUNK_HEADER_BYTES ? alignment : CHUNK_HEADER_BYTES;
+        }
+        // 超大内存块向来源申请时的对齐，数据偏移是它的倍数，所以数据满足 alignment
+        static memory_size_type large_alignment(const memory_size_type alignment) {
+            return alignment > LARGE_ALIGN ? alignment : LARGE_ALIGN;
+        }
+        // 申请一大块内存，并且加入到之前的链表中，需要持有 depot_mutex
+        static void chunk_memory();
+        // 给定一大段内存资源的起始地址，单个内存块大小，内存块的数量，将这一大块内存资源初始化成自由链表，并加入到自由链表头节点中
+        static void insert_free_list(memory_ptr_type start_address, memory_size_type memory_unit_bytes, block_number block, bool update = true);
+    };
+}
+
+#endif //MEMORYPOOL_H
@@ -6,6 +6,13 @@
 #define ALGORITHM_H
 
 #include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "simd.h"
+#include "traits.h"
 
 namespace tinyWheels{
     template<class ForwardIterator, class T>
@@ -32,6 +39,211 @@ namespace tinyWheels{
     }
 
 
+    // 把 [first, last) 的对象搬到从 dst 开始的未构造内存，搬完之后原来的位置变为未构造，两个区间可以重叠
+    // 平凡可重定位的类型直接 memmove，其他类型逐个移动构造再析构，dst 在前面时从前往后搬，否则从后往前搬
+    template<class T>
+    void relocate(T *first, T *last, T *dst) {
+        if (first == last or first == dst) {
+            return;
+        }
+        if constexpr (is_trivially_relocatable_v<T>) {
+            std::memmove(static_cast<void *>(dst), static_cast<const void *>(first), (last - first) * sizeof(T));
+        }else if (dst < first) {
+            for (; first != last; ++first, ++dst) {
+                new(dst) T(std::move(*first));
+                first->~T();
+            }
+        }else {
+            for (dst += last - first; last != first;) {
+                --last, --dst;
+                new(dst) T(std::move(*last));
+                last->~T();
+            }
+        }
+    }
+
+    // 把 [first, last) 复制构造到从 dst 开始的未构造内存，平凡可复制的类型从指针复制时直接 memcpy
+    template<class InputIterator, class T>
+    void uninitialized_copy(InputIterator first, InputIterator last, T *dst) {
+        if constexpr (std::is_trivially_copyable_v<T> and std::is_pointer_v<InputIterator>
+                      and std::is_same_v<std::remove_cv_t<std::remove_pointer_t<InputIterator>>, T>) {
+            if (first != last) {
+                std::memcpy(static_cast<void *>(dst), static_cast<const void *>(first), (last - first) * sizeof(T));
+            }
+        }else {
+            for (; first != last; ++first, ++dst) {
+                new(dst) T(*first);
+            }
+        }
+    }
+
+    // 下面的查找与归约对任意迭代器逐个处理；迭代器指向连续存放的 simd_arithmetic 类型（指针、std::span 的迭代器等）时
+    // 交给 simd.h 中的向量化内核，结果与逐个处理相同（浮点数的 sum、dot 除外，见 simd.h）
+    namespace detail {
+        // 指向连续存放的 simd_arithmetic 类型，可以用 std::to_address 取得指针按连续内存处理
+        template<class Iterator>
+        concept simd_contiguous = std::contiguous_iterator<Iterator> and simd_arithmetic<std::iter_value_t<Iterator>>;
+
+        // 与 value 比较相等等价于与 U(value) 比较相等：类型相同，或者都是整数并且 value 在 U 的范围内
+        template<class U, class T>
+        bool simd_comparable(const T &value) {
+            if constexpr (std::is_same_v<U, T>) {
+                return true;
+            }else if constexpr (std::is_integral_v<U> and std::is_integral_v<T> and not std::is_same_v<T, bool>) {
+                // 转换过去再转换回来不变，并且符号相同
+                const auto converted = static_cast<U>(value);
+                return static_cast<T>(converted) == value and (converted < U{}) == (value < T{});
+            }else {
+                return false;
+            }
+        }
+
+        // 逐个比较时的相等：一边是有符号整数、一边是无符号整数时按数值比较，负数不会转换成很大的无符号数
+        // （std::cmp_equal 不接受 char 类型，所以自己写）
+        template<class A, class B>
+        bool value_equal(const A &a, const B &b) {
+            if constexpr (std::is_integral_v<A> and std::is_integral_v<B> and not std::is_same_v<A, bool> and not std::is_same_v<B, bool>
+                          and std::is_signed_v<A> != std::is_signed_v<B>) {
+                if constexpr (std::is_signed_v<A>) {
+                    return a >= 0 and static_cast<std::make_unsigned_t<A>>(a) == b;
+                }else {
+                    return b >= 0 and a == static_cast<std::make_unsigned_t<B>>(b);
+                }
+            }else {
+                return a == b;
+            }
+        }
+    }
+
+    template<class InputIterator, class T>
+    InputIterator find(InputIterator first, InputIterator last, const T& value) {
+        if constexpr (detail::simd_contiguous<InputIterator>) {
+            using U = std::iter_value_t<InputIterator>;
+            if (detail::simd_comparable<U>(value)) {
+                return first + simd::find<U>(std::to_address(first), last - first, static_cast<U>(value));
+            }
+        }
+        for (; first != last; ++first) {
+            if (detail::value_equal(*first, value)) {
+                break;
+            }
+        }
+        return first;
+    }
+
+    template<class InputIterator, class T>
+    size_t count(InputIterator first, InputIterator last, const T& value) {
+        if constexpr (detail::simd_contiguous<InputIterator>) {
+            using U = std::iter_value_t<InputIterator>;
+            if (detail::simd_comparable<U>(value)) {
+                return simd::count<U>(std::to_address(first), last - first, static_cast<U>(value));
+            }
+        }
+        size_t rst = 0;
+        for (; first != last; ++first) {
+            rst += detail::value_equal(*first, value);
+        }
+        return rst;
+    }
+
+    // 返回第一个最小（最大）的元素，区间为空时返回 last
+    template<class ForwardIterator>
+    ForwardIterator min_element(ForwardIterator first, ForwardIterator last) {
+        if (first == last) {
+            return last;
+        }
+        if constexpr (detail::simd_contiguous<ForwardIterator>) {
+            // 先求出最小值，再找第一个等于它的元素；第一个元素是 NaN 时找不到，退回逐个比较
+            const auto position = tinyWheels::find(first, last, simd::min(std::to_address(first), last - first));
+            if (position != last) {
+                return position;
+            }
+        }
+        auto rst = first;
+        for (++first; first != last; ++first) {
+            if (*first < *rst) {
+                rst = first;
+            }
+        }
+        return rst;
+    }
+
+    template<class ForwardIterator>
+    ForwardIterator max_element(ForwardIterator first, ForwardIterator last) {
+        if (first == last) {
+            return last;
+        }
+        if constexpr (detail::simd_contiguous<ForwardIterator>) {
+            const auto position = tinyWheels::find(first, last, simd::max(std::to_address(first), last - first));
+            if (position != last) {
+                return position;
+            }
+        }
+        auto rst = first;
+        for (++first; first != last; ++first) {
+            if (*rst < *first) {
+                rst = first;
+            }
+        }
+        return rst;
+    }
+
+    // 同时返回第一个最小与第一个最大的元素（与 std::minmax_element 不同，最大的也是第一个），只遍历一次求值
+    template<class ForwardIterator>
+    std::pair<ForwardIterator, ForwardIterator> minmax_element(ForwardIterator first, ForwardIterator last) {
+        if (first == last) {
+            return {last, last};
+        }
+        if constexpr (detail::simd_contiguous<ForwardIterator>) {
+            const auto [low, high] = simd::minmax(std::to_address(first), last - first);
+            const auto low_position = tinyWheels::find(first, last, low), high_position = tinyWheels::find(first, last, high);
+            if (low_position != last and high_position != last) {
+                return {low_position, high_position};
+            }
+        }
+        auto low = first, high = first;
+        for (++first; first != last; ++first) {
+            if (*first < *low) {
+                low = first;
+            }
+            if (*high < *first) {
+                high = first;
+            }
+        }
+        return {low, high};
+    }
+
+    // 所有元素的和，整数累加到 64 位，见 sum_type_t
+    template<class InputIterator>
+    auto sum(InputIterator first, InputIterator last) {
+        using U = std::remove_cvref_t<decltype(*first)>;
+        if constexpr (detail::simd_contiguous<InputIterator>) {
+            return simd::sum<U>(std::to_address(first), last - first);
+        }else {
+            sum_type_t<U> rst{};
+            for (; first != last; ++first) {
+                rst += *first;
+            }
+            return rst;
+        }
+    }
+
+    // 点积：[first1, last1) 与从 first2 开始的同样个数的元素逐个相乘再求和
+    template<class InputIterator1, class InputIterator2>
+    auto dot(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2) {
+        using U = std::remove_cvref_t<decltype(*first1)>;
+        if constexpr (detail::simd_contiguous<InputIterator1> and detail::simd_contiguous<InputIterator2>
+                      and std::is_same_v<U, std::remove_cvref_t<decltype(*first2)>>) {
+            return simd::dot<U>(std::to_address(first1), std::to_address(first2), last1 - first1);
+        }else {
+            sum_type_t<U> rst{};
+            for (; first1 != last1; ++first1, ++first2) {
+                rst += static_cast<sum_type_t<U>>(*first1) * static_cast<sum_type_t<U>>(*first2);
+            }
+            return rst;
+        }
+    }
+
     // abs函数
     template<class T>
     T abs(const T& value) {
@@ -0,0 +1,145 @@
+//
+// Created by 24983 on 25-3-13.
+//
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "allocator.h"
+#include "memory_resource.h"
+
+namespace tinyWheels {
+    // 请求级内存区域：申请只是移动指针，不能单独释放，reset() 一次性回收全部内存
+    // 与 monotonic_buffer_resource 的区别：reset() 不把内存块还给上游，而是留给下一次请求按顺序复用，稳定之后不再访问上游；
+    // 通过 create<T>() 构造的对象会登记析构函数，reset() 时按构造的相反顺序析构。不是线程安全的，一个请求（线程）一个 Arena
+    class Arena final : public memory_resource {
+        struct Block {
+            Block *next;             // 下一个内存块，reset() 之后按链表顺序复用
+            memory_size_type bytes;  // 向上游申请的总字节数，包括头部
+        };
+        // 需要析构的对象，记录本身也从 Arena 中申请
+        struct Finalizer {
+            void (*destroy)(void *);
+            void *object;
+            Finalizer *next;
+        };
+        constexpr static memory_size_type BLOCK_HEADER_BYTES = DEFAULT_ALIGNMENT;
+        static_assert(sizeof(Block) <= BLOCK_HEADER_BYTES);
+
+        memory_resource *upstream_;
+        memory_size_type next_bytes_;         // 下一次向上游申请的大小，每次翻倍，最多 MAX_BLOCK_BYTES
+        Block *first_{nullptr};
+        Block *current_{nullptr};             // 正在使用的内存块
+        char *cursor_{nullptr};               // 当前内存块中下一个可用的地址
+        char *limit_{nullptr};                // 当前内存块的末尾
+        Finalizer *finalizers_{nullptr};      // 最后登记的在最前面
+        memory_size_type reserved_bytes_{0};  // 从上游申请的总字节数
+
+        void *allocate_slow(memory_size_type bytes, memory_size_type alignment);
+    public:
+        constexpr static memory_size_type INITIAL_BYTES = 4096;        // 默认第一个内存块的大小
+        constexpr static memory_size_type MAX_BLOCK_BYTES = 1 << 20;  // 内存块翻倍的上限，更大的申请单独一个内存块
+
+        explicit Arena(memory_size_type initial_bytes = INITIAL_BYTES, memory_resource *upstream = get_default_resource());
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+        ~Arena() override {release();}
+
+        // 申请内存：对齐之后移动指针，当前内存块放不下时才进入 allocate_slow
+        [[nodiscard]] void *bump(const memory_size_type bytes, const memory_size_type alignment = DEFAULT_ALIGNMENT) {
+            const auto address = (reinterpret_cast<uintptr_t>(cursor_) + alignment - 1) & ~(alignment - 1);
+            if (cursor_ == nullptr or address + bytes > reinterpret_cast<uintptr_t>(limit_)) {
+                return allocate_slow(bytes, alignment);
+            }
+            cursor_ = reinterpret_cast<char *>(address + bytes);
+            return reinterpret_cast<void *>(address);
+        }
+
+        // 在 Arena 中构造一个对象，不需要也不能单独释放；析构函数不平凡时登记下来，reset() 时调用
+        template<class T, class... Args>
+        T *create(Args&&... args) {
+            if constexpr (std::is_trivially_destructible_v<T>) {
+                return new(bump(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            }else {
+                // 先申请记录再构造对象，构造抛出异常时记录没有挂上链表，不会析构一个不存在的对象
+                const auto finalizer = static_cast<Finalizer *>(bump(sizeof(Finalizer), alignof(Finalizer)));
+                const auto object = new(bump(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+                finalizers_ = new(finalizer) Finalizer{[](void *p) {static_cast<T *>(p)->~T();}, object, finalizers_};
+                return object;
+            }
+        }
+
+        // 析构登记的对象，回到第一个内存块的开头，之前申请的内存全部失效；除了析构之外是 O(1) 的
+        void reset();
+        // reset() 之后把所有内存块还给上游
+        void release();
+
+        [[nodiscard]] memory_size_type reserved_bytes() const {return reserved_bytes_;}
+        [[nodiscard]] memory_resource *upstream_resource() const {return upstream_;}
+    protected:
+        void *do_allocate(const memory_size_type bytes, const memory_size_type alignment) override {return bump(bytes, alignment);}
+        void do_deallocate(void *, memory_size_type, memory_size_type) override {}
+    };
+
+    // 从 Arena 申请内存的分配器，接口与 Allocator<T> 相同，可以作为 vector、list 的 Alloc 参数：
+    // vector<int, ArenaAllocator<int>> v(&arena)。deallocate 什么也不做，内存在 Arena::reset() 时统一回收，
+    // 容器析构时仍然会调用元素的析构函数
+    template<class T>
+    class ArenaAllocator {
+        using memory_size_type = size_t;
+        using variable_count = size_t;
+
+        Arena *arena_;
+    public:
+        using value_type = T;
+        template<class U>
+        struct rebind {
+            using other = ArenaAllocator<U>;
+        };
+
+        ArenaAllocator(Arena *arena) noexcept : arena_(arena) {}
+        ArenaAllocator(const ArenaAllocator &) = default;
+        template<class U>
+        ArenaAllocator(const ArenaAllocator<U> &another) noexcept : arena_(another.arena()) {}
+        ArenaAllocator &operator=(const ArenaAllocator &) = default;
+        ~ArenaAllocator() = default;
+
+        [[nodiscard]] Arena *arena() const {return arena_;}
+
+        // 申请 number 个 T 的内存，返回地址以及容量，容量就是 number
+        std::pair<T *, memory_size_type> allocate(const variable_count number) {
+            return std::make_pair(static_cast<T *>(arena_->bump(number * sizeof(T), alignof(T))), number);
+        }
+        void deallocate(T *, variable_count) {}
+        // 一次移动指针切出 number 个相邻的 T，list 的节点在内存中连续，遍历时对缓存更友好
+        void allocate_bulk(T **ptrs, const variable_count number) {
+            const auto start = static_cast<T *>(arena_->bump(number * sizeof(T), alignof(T)));
+            for (variable_count i = 0; i < number; ++i) {
+                ptrs[i] = start + i;
+            }
+        }
+        void deallocate_bulk(T **, variable_count) {}
+
+        template<class... Args>
+        static void construct(T *start_memory, const variable_count number, Args&&... args) {
+            Allocator<T>::construct(start_memory, number, std::forward<Args>(args)...);
+        }
+        static void construct(T *start_memory, const variable_count number) {
+            Allocator<T>::construct(start_memory, number);
+        }
+        static void Destruct(T *start_memory, const variable_count number) {
+            Allocator<T>::Destruct(start_memory, number);
+        }
+
+        template<class U>
+        friend bool operator==(const ArenaAllocator &a, const ArenaAllocator<U> &b) {
+            return a.arena() == b.arena();
+        }
+    };
+}
+
+#endif //ARENA_H
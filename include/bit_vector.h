@@ -0,0 +1,298 @@
+//
+// Created by 24983 on 25-3-19.
+//
+
+#ifndef BIT_VECTOR_H
+#define BIT_VECTOR_H
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include "bounds_check.h"
+#include "exception.h"
+#include "simd.h"
+#include "vector.h"
+
+namespace tinyWheels {
+    // 位图的公共部分：每 64 个标志压进一个 uint64_t，第 i 位在 words[i / 64] 的第 i % 64 位
+    // 最后一个字中超过长度的位始终是 0，count、比较、查找都不需要单独处理
+    namespace detail {
+        constexpr size_t WORD_BITS = 64;
+
+        constexpr size_t word_count(const size_t bits) {return (bits + WORD_BITS - 1) / WORD_BITS;}
+        // 最后一个字中有效位的掩码
+        constexpr uint64_t tail_mask(const size_t bits) {
+            return bits % WORD_BITS == 0 ? ~uint64_t(0) : (uint64_t(1) << bits % WORD_BITS) - 1;
+        }
+
+        // 第一个不小于 pos 的 1 的位置，没有时返回 bits
+        size_t find_next_bit(const uint64_t *words, size_t bits, size_t pos);
+        // [0, pos) 中 1 的个数
+        size_t rank_bits(const uint64_t *words, size_t pos);
+        // 第 k 个（从 0 开始）1 的位置，没有时返回 bits
+        size_t select_bit(const uint64_t *words, size_t bits, size_t k);
+        // word 中第 k 个 1 的位置，k 必须小于 word 中 1 的个数
+        size_t select_in_word(uint64_t word, size_t k);
+        void print_bits(std::ostream &os, const uint64_t *words, size_t bits);
+    }
+
+    // 指向一个位的代理，operator[] 返回它
+    class bit_reference {
+        uint64_t *word_;
+        uint64_t mask_;
+    public:
+        bit_reference(uint64_t *word, const size_t bit) : word_(word), mask_(uint64_t(1) << bit) {}
+        bit_reference(const bit_reference &) = default;
+
+        operator bool() const {return (*word_ & mask_) != 0;}
+        bool operator~() const {return (*word_ & mask_) == 0;}
+        const bit_reference &operator=(const bool value) const {
+            *word_ = value ? *word_ | mask_ : *word_ & ~mask_;
+            return *this;
+        }
+        const bit_reference &operator=(const bit_reference &another) const {
+            return *this = static_cast<bool>(another);
+        }
+        void flip() const {*word_ ^= mask_;}
+    };
+
+    // 固定长度的位图，N 个标志放在 (N + 63) / 64 个字中
+    // 位运算与 count 在字数较多时交给 simd.h 的向量化内核
+    template<size_t N>
+    class bitset {
+        constexpr static size_t WORDS = detail::word_count(N);
+        constexpr static size_t SIMD_WORDS = 8;  // 超过这么多字才调用向量化内核，更少时直接展开
+        std::array<uint64_t, WORDS> words_{};
+
+        void check(const size_t pos) const {
+            if (pos >= N) {
+                throw exception("Out of range, pos: %lu, size: %lu", pos, N);
+            }
+        }
+        void trim() {
+            if constexpr (WORDS > 0) {
+                words_[WORDS - 1] &= detail::tail_mask(N);
+            }
+        }
+        bitset &apply(const simd::bit_op op, const bitset &another) {
+            if constexpr (WORDS > SIMD_WORDS) {
+                simd::bitwise(op, words_.data(), another.words_.data(), WORDS);
+            }else {
+                for (size_t i = 0; i < WORDS; ++i) {
+                    switch (op) {
+                        case simd::bit_op::AND: words_[i] &= another.words_[i]; break;
+                        case simd::bit_op::OR: words_[i] |= another.words_[i]; break;
+                        case simd::bit_op::XOR: words_[i] ^= another.words_[i]; break;
+                        case simd::bit_op::ANDNOT: words_[i] &= ~another.words_[i]; break;
+                    }
+                }
+            }
+            return *this;
+        }
+    public:
+        constexpr static size_t npos = static_cast<size_t>(-1);
+
+        bitset() = default;
+        explicit bitset(const uint64_t value) {  // 低 64 位
+            if constexpr (WORDS > 0) {
+                words_[0] = value;
+                trim();
+            }
+        }
+
+        [[nodiscard]] constexpr size_t size() const {return N;}
+        [[nodiscard]] const uint64_t *data() const {return words_.data();}
+        [[nodiscard]] constexpr size_t word_count() const {return WORDS;}
+
+        [[nodiscard]] bool test(const size_t pos) const {
+            check(pos);
+            return words_[pos / detail::WORD_BITS] >> pos % detail::WORD_BITS & 1;
+        }
+        // 与 std::bitset 相同，test、set、reset、flip 始终检查，operator[] 按 TINYWHEELS_BOUNDS_CHECK 检查
+        bool operator[](const size_t pos) const {
+            check_index(pos, N);
+            return words_[pos / detail::WORD_BITS] >> pos % detail::WORD_BITS & 1;
+        }
+        bit_reference operator[](const size_t pos) {
+            check_index(pos, N);
+            return bit_reference(&words_[pos / detail::WORD_BITS], pos % detail::WORD_BITS);
+        }
+
+        bitset &set(const size_t pos, const bool value = true) {
+            check(pos);
+            bit_reference(&words_[pos / detail::WORD_BITS], pos % detail::WORD_BITS) = value;
+            return *this;
+        }
+        bitset &reset(const size_t pos) {return set(pos, false);}
+        bitset &flip(const size_t pos) {
+            check(pos);
+            words_[pos / detail::WORD_BITS] ^= uint64_t(1) << pos % detail::WORD_BITS;
+            return *this;
+        }
+        bitset &set() {
+            words_.fill(~uint64_t(0));
+            trim();
+            return *this;
+        }
+        bitset &reset() {
+            words_.fill(0);
+            return *this;
+        }
+        bitset &flip() {
+            for (auto &word : words_) {
+                word = ~word;
+            }
+            trim();
+            return *this;
+        }
+
+        [[nodiscard]] size_t count() const {
+            if constexpr (WORDS > SIMD_WORDS) {
+                return simd::popcount(words_.data(), WORDS);
+            }else {
+                size_t rst = 0;
+                for (const auto word : words_) {
+                    rst += __builtin_popcountll(word);
+                }
+                return rst;
+            }
+        }
+        [[nodiscard]] bool any() const {return simd::find_nonzero(words_.data(), WORDS) != WORDS;}
+        [[nodiscard]] bool none() const {return not any();}
+        [[nodiscard]] bool all() const {return count() == N;}
+
+        // 第一个 1 的位置、pos 之后的第一个 1 的位置，没有时返回 npos
+        [[nodiscard]] size_t find_first() const {
+            const auto rst = detail::find_next_bit(words_.data(), N, 0);
+            return rst == N ? npos : rst;
+        }
+        [[nodiscard]] size_t find_next(const size_t pos) const {
+            const auto rst = pos + 1 >= N ? N : detail::find_next_bit(words_.data(), N, pos + 1);
+            return rst == N ? npos : rst;
+        }
+        // [0, pos) 中 1 的个数；第 k 个（从 0 开始）1 的位置，没有时返回 npos
+        [[nodiscard]] size_t rank(const size_t pos) const {
+            return detail::rank_bits(words_.data(), pos < N ? pos : N);
+        }
+        [[nodiscard]] size_t select(const size_t k) const {
+            const auto rst = detail::select_bit(words_.data(), N, k);
+            return rst == N ? npos : rst;
+        }
+
+        bitset &operator&=(const bitset &another) {return apply(simd::bit_op::AND, another);}
+        bitset &operator|=(const bitset &another) {return apply(simd::bit_op::OR, another);}
+        bitset &operator^=(const bitset &another) {return apply(simd::bit_op::XOR, another);}
+        bitset &andnot(const bitset &another) {return apply(simd::bit_op::ANDNOT, another);}  // *this &= ~another
+        bitset operator~() const {return bitset(*this).flip();}
+        friend bitset operator&(bitset a, const bitset &b) {return a &= b;}
+        friend bitset operator|(bitset a, const bitset &b) {return a |= b;}
+        friend bitset operator^(bitset a, const bitset &b) {return a ^= b;}
+
+        bool operator==(const bitset &another) const {return words_ == another.words_;}
+        bool operator!=(const bitset &another) const {return !(*this == another);}
+
+        // 从第 0 位开始输出
+        friend std::ostream &operator<<(std::ostream &os, const bitset &bits) {
+            detail::print_bits(os, bits.words_.data(), N);
+            return os;
+        }
+    };
+
+    // 可变长度的位图，字保存在 vector<uint64_t> 中，比 vector<bool> 每个标志一个字节节省 8 倍的内存与带宽
+    // 两个 bit_vector 之间的位运算要求长度相同，否则抛出异常
+    class bit_vector {
+        vector<uint64_t> words_;
+        size_t size_{0};
+
+        void check(size_t pos) const;
+        void check_same_size(const bit_vector &another) const;
+        void trim();  // 把最后一个字中超过 size_ 的位清零
+        bit_vector &apply(simd::bit_op op, const bit_vector &another);
+    public:
+        using length_type = size_t;
+        constexpr static size_t npos = static_cast<size_t>(-1);
+
+        bit_vector() = default;
+        explicit bit_vector(size_t n, bool value = false);
+
+        [[nodiscard]] size_t size() const {return size_;}
+        [[nodiscard]] bool empty() const {return size_ == 0;}
+        [[nodiscard]] size_t capacity() const {return words_.capacity() * detail::WORD_BITS;}
+        [[nodiscard]] const uint64_t *data() const {return words_.begin();}
+        [[nodiscard]] size_t word_count() const {return words_.size();}
+
+        void resize(size_t n, bool value = false);
+        void clear() {resize(0);}
+        void push_back(bool value);
+        bool pop_back();
+
+        [[nodiscard]] bool test(const size_t pos) const {
+            check(pos);
+            return words_.begin()[pos / detail::WORD_BITS] >> pos % detail::WORD_BITS & 1;
+        }
+        // test、set、reset、flip 始终检查，operator[] 按 TINYWHEELS_BOUNDS_CHECK 检查
+        bool operator[](const size_t pos) const {
+            check_index(pos, size_);
+            return words_.begin()[pos / detail::WORD_BITS] >> pos % detail::WORD_BITS & 1;
+        }
+        bit_reference operator[](const size_t pos) {
+            check_index(pos, size_);
+            return bit_reference(words_.begin() + pos / detail::WORD_BITS, pos % detail::WORD_BITS);
+        }
+
+        bit_vector &set(size_t pos, bool value = true);
+        bit_vector &reset(const size_t pos) {return set(pos, false);}
+        bit_vector &flip(size_t pos);
+        bit_vector &set();
+        bit_vector &reset();
+        bit_vector &flip();
+
+        [[nodiscard]] size_t count() const;
+        [[nodiscard]] bool any() const;
+        [[nodiscard]] bool none() const {return not any();}
+        [[nodiscard]] bool all() const {return count() == size_;}
+
+        // 第一个 1 的位置、pos 之后的第一个 1 的位置，没有时返回 npos；for (auto i = b.find_first(); i != b.npos; i = b.find_next(i))
+        [[nodiscard]] size_t find_first() const;
+        [[nodiscard]] size_t find_next(size_t pos) const;
+        // [0, pos) 中 1 的个数，第 k 个（从 0 开始）1 的位置；都要遍历前面的字，O(n / 64)，反复查询时使用 rank_index
+        [[nodiscard]] size_t rank(size_t pos) const;
+        [[nodiscard]] size_t select(size_t k) const;
+
+        bit_vector &operator&=(const bit_vector &another) {return apply(simd::bit_op::AND, another);}
+        bit_vector &operator|=(const bit_vector &another) {return apply(simd::bit_op::OR, another);}
+        bit_vector &operator^=(const bit_vector &another) {return apply(simd::bit_op::XOR, another);}
+        bit_vector &andnot(const bit_vector &another) {return apply(simd::bit_op::ANDNOT, another);}  // *this &= ~another
+        bit_vector operator~() const {return bit_vector(*this).flip();}
+        friend bit_vector operator&(bit_vector a, const bit_vector &b) {return a &= b;}
+        friend bit_vector operator|(bit_vector a, const bit_vector &b) {return a |= b;}
+        friend bit_vector operator^(bit_vector a, const bit_vector &b) {return a ^= b;}
+
+        bool operator==(const bit_vector &another) const {return size_ == another.size_ and words_ == another.words_;}
+        bool operator!=(const bit_vector &another) const {return !(*this == another);}
+
+        friend std::ostream &operator<<(std::ostream &os, const bit_vector &bits);
+        friend void swap(bit_vector &a, bit_vector &b) noexcept {
+            a.words_.swap(b.words_);
+            tinyWheels::swap(a.size_, b.size_);
+        }
+    };
+
+    // bit_vector 的 rank/select 索引：每 512 位（8 个字）记录之前 1 的个数，rank 是 O(1)，select 先二分查找块再在块内找
+    // 只保存指针，bit_vector 修改或者销毁之后需要重新构造
+    class rank_index {
+        const bit_vector *bits_;
+        vector<uint64_t> blocks_;  // blocks_[i] 是前 i 块中 1 的个数，最后多一个元素是总数
+    public:
+        constexpr static size_t BLOCK_WORDS = 8;
+        constexpr static size_t npos = bit_vector::npos;
+
+        explicit rank_index(const bit_vector &bits);
+
+        [[nodiscard]] size_t count() const {return blocks_.end()[-1];}
+        [[nodiscard]] size_t rank(size_t pos) const;
+        [[nodiscard]] size_t select(size_t k) const;
+    };
+}
+
+#endif //BIT_VECTOR_H
@@ -0,0 +1,59 @@
+//
+// Created by 24983 on 25-3-22.
+//
+
+#ifndef BOUNDS_CHECK_H
+#define BOUNDS_CHECK_H
+
+#include <cassert>
+#include <cstddef>
+#include "exception.h"
+
+// 容器 operator[] 的越界检查，整个项目统一由 TINYWHEELS_BOUNDS_CHECK 选择（CMake 中 -DTINYWHEELS_BOUNDS_CHECK=0/1/2）：
+// 0 不检查，下标直接访问；1 只 assert，定义了 NDEBUG 时与 0 相同；2 越界抛出 exception
+// 没有定义时，定义了 NDEBUG 的发布构建为 0，其他构建为 2；at() 不受影响，始终检查
+// 不同的编译单元必须使用相同的值，否则同一个内联函数会有不同的定义
+#ifndef TINYWHEELS_BOUNDS_CHECK
+#ifdef NDEBUG
+#define TINYWHEELS_BOUNDS_CHECK 0
+#else
+#define TINYWHEELS_BOUNDS_CHECK 2
+#endif
+#endif
+
+namespace tinyWheels {
+    enum class bounds_check {
+        UNCHECKED = 0,
+        ASSERT = 1,
+        CHECKED = 2,
+    };
+    constexpr bounds_check default_bounds_check = static_cast<bounds_check>(TINYWHEELS_BOUNDS_CHECK);
+    static_assert(TINYWHEELS_BOUNDS_CHECK >= 0 and TINYWHEELS_BOUNDS_CHECK <= 2, "TINYWHEELS_BOUNDS_CHECK must be 0, 1 or 2");
+
+    namespace detail {
+        // 构造格式化的异常需要 vsnprintf 与 malloc，放在单独的冷函数里，调用处只剩一次比较与一个不常走的跳转
+        [[noreturn, gnu::cold, gnu::noinline]]
+        inline void throw_out_of_range(const size_t index, const size_t size) {
+            throw exception("Out of range, index: %lu, size: %lu", index, size);
+        }
+    }
+
+    // index 必须小于 size；Policy 为 UNCHECKED 时不生成任何代码
+    template<bounds_check Policy = default_bounds_check>
+    inline void check_index(const size_t index, const size_t size) {
+        if constexpr (Policy == bounds_check::CHECKED) {
+            if (index >= size) [[unlikely]] {
+                detail::throw_out_of_range(index, size);
+            }
+        }else if constexpr (Policy == bounds_check::ASSERT) {
+            assert(index < size && "index out of range");
+        }
+    }
+
+    // at() 使用的检查，与 TINYWHEELS_BOUNDS_CHECK 无关
+    inline void check_at(const size_t index, const size_t size) {
+        check_index<bounds_check::CHECKED>(index, size);
+    }
+}
+
+#endif //BOUNDS_CHECK_H
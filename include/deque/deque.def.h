@@ -4,7 +4,22 @@
 
 #ifndef DEQUE_DEF_H
 #define DEQUE_DEF_H
-#include "list.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+
+#include "allocator.h"
+#include "bounds_check.h"
+#include "iterator.h"
+#include "memory_resource.h"
+#include "traits.h"
+#include "utility.h"
+
 namespace tinyWheels {
 
     struct DEQUE {
@@ -15,78 +30,360 @@ namespace tinyWheels {
         static constexpr DEQUE_TYPE FRONT_OUTPUT = 0x2;
         static constexpr DEQUE_TYPE BACK_OUTPUT = 0x4;
         static constexpr DEQUE_TYPE BACK_INPUT = 0x8;
+        static constexpr DEQUE_TYPE ALL = FRONT_INPUT | FRONT_OUTPUT | BACK_OUTPUT | BACK_INPUT;
     };
 
-    // 使用list来实现的
-    template<class T,DEQUE::DEQUE_TYPE MODE = 0xF>
-    class deque {
-        using container = list<T>;
-        using Iterator = typename container::Iterator;
-        container data;
-    public:
-        deque() = default;
-        deque(const deque&) = default;
-        deque(deque&&) = default;
-        deque& operator=(const deque&) = default;
-        deque& operator=(deque&&) = default;
-        deque& operator=(const container& other) {
-            data = other;
-            return *this;
-        }
-        deque& operator=(container&& other) {
-            data = std::move(other);
-            return *this;
+    namespace mzDeque {
+        // 每块的元素个数：一块不超过内存池的阈值（从内存池中申请），至少 16 个，取 2 的幂让下标换算成为移位
+        template <class T>
+        constexpr size_t default_block_elements() {
+            constexpr size_t elements = MemoryPool::THRESHOLD / sizeof(T);
+            return elements < 16 ? 16 : std::bit_floor(elements);
         }
-        ~deque() = default;
 
-        void push_front(const T& value) {
-            if (MODE & 0x1) {
-                data.push_front(value);
+        // 迭代器是 (块在中控数组中的位置, 块的首地址, 当前元素)，块内移动只是指针加减，跨块时才读中控数组
+        // 末尾所在的块可能还没有申请（首地址为 nullptr），此时 cur_ 也是 nullptr，只用来比较与计算距离
+        template <class T, size_t B>
+        class DequeIterator {
+            template <class, size_t> friend class DequeIterator;
+            constexpr static ptrdiff_t BLOCK = B;
+        public:
+            using iterator_category = random_access_iterator_tag;
+            using value_type = std::remove_cv_t<T>;
+            using difference_type = ptrdiff_t;
+            using pointer = T*;
+            using reference = T&;
+            using map_pointer = value_type* const*;
+        private:
+            pointer cur_ = nullptr;
+            pointer first_ = nullptr;
+            map_pointer node_ = nullptr;
+
+            void set_node(const map_pointer node) {
+                node_ = node;
+                first_ = *node;
             }
-        }
-        void push_back(const T& value) {
-            if (MODE & 0x8) {
-                data.push_back(value);
+        public:
+            DequeIterator() = default;
+            DequeIterator(const map_pointer node, const size_t offset) : cur_(*node + offset), first_(*node), node_(node) {}
+            // Iterator 可以转换为 ConstIterator
+            template <class U>
+            requires(std::is_const_v<T> and std::is_same_v<U, std::remove_const_t<T>>)
+            DequeIterator(const DequeIterator<U, B>& it) : cur_(it.cur_), first_(it.first_), node_(it.node_) {}
+
+            reference operator*() const {return *cur_;}
+            pointer operator->() const {return cur_;}
+            reference operator[](const difference_type n) const {return *(*this + n);}
+
+            DequeIterator& operator++() {
+                if (++cur_ == first_ + BLOCK) {
+                    set_node(node_ + 1);
+                    cur_ = first_;
+                }
+                return *this;
             }
-        }
-        void pop_front() {
-            if (MODE & 0x2) {
-                data.pop_front();
+            DequeIterator operator++(int) {
+                auto tmp = *this;
+                ++(*this);
+                return tmp;
             }
-        }
-        void pop_back() {
-            if (MODE & 0x4) {
-                data.pop_back();
+            DequeIterator& operator--() {
+                if (cur_ == first_) {
+                    set_node(node_ - 1);
+                    cur_ = first_ + BLOCK;
+                }
+                --cur_;
+                return *this;
+            }
+            DequeIterator operator--(int) {
+                auto tmp = *this;
+                --(*this);
+                return tmp;
+            }
+
+            // 先算出目标在第几块，再定位块内的偏移，O(1)
+            DequeIterator& operator+=(const difference_type n) {
+                const auto offset = n + (cur_ - first_);
+                if (offset >= 0 and offset < BLOCK) {
+                    cur_ += n;
+                }else {
+                    const auto node_offset = offset > 0 ? offset / BLOCK : -((-offset - 1) / BLOCK) - 1;
+                    set_node(node_ + node_offset);
+                    cur_ = first_ + (offset - node_offset * BLOCK);
+                }
+                return *this;
+            }
+            DequeIterator& operator-=(const difference_type n) {
+                return *this += -n;
+            }
+            friend DequeIterator operator+(const DequeIterator& it, const difference_type n) {
+                auto tmp = it;
+                tmp += n;
+                return tmp;
+            }
+            friend DequeIterator operator+(const difference_type n, const DequeIterator& it) {
+                return it + n;
+            }
+            DequeIterator operator-(const difference_type n) const {
+                auto tmp = *this;
+                tmp -= n;
+                return tmp;
+            }
+            difference_type operator-(const DequeIterator& another) const {
+                return (node_ - another.node_) * BLOCK + (cur_ - first_) - (another.cur_ - another.first_);
+            }
+
+            bool operator==(const DequeIterator& another) const {
+                return node_ == another.node_ and cur_ == another.cur_;
+            }
+            bool operator!=(const DequeIterator& another) const {
+                return !(*this == another);
+            }
+            bool operator<(const DequeIterator& another) const {
+                return node_ == another.node_ ? cur_ < another.cur_ : node_ < another.node_;
+            }
+            bool operator>(const DequeIterator& another) const {
+                return another < *this;
+            }
+            bool operator<=(const DequeIterator& another) const {
+                return !(*this > another);
+            }
+            bool operator>=(const DequeIterator& another) const {
+                return !(*this < another);
+            }
+            friend void swap(DequeIterator& a, DequeIterator& b) noexcept {
+                a.swap(b);
+            }
+            void swap(DequeIterator& a) noexcept {
+                tinyWheels::swap(cur_, a.cur_);
+                tinyWheels::swap(first_, a.first_);
+                tinyWheels::swap(node_, a.node_);
+            }
+        };
+
+        // 反向迭代器保存它后面一个位置的正向迭代器，解引用时取前一个元素；rend() 就是 begin()，不会越过第一块
+        template <class Iterator>
+        class ReverseDequeIterator {
+        public:
+            using iterator_category = random_access_iterator_tag;
+            using value_type = typename Iterator::value_type;
+            using difference_type = ptrdiff_t;
+            using pointer = typename Iterator::pointer;
+            using reference = typename Iterator::reference;
+        private:
+            Iterator base_;
+        public:
+            ReverseDequeIterator() = default;
+            explicit ReverseDequeIterator(const Iterator& base) : base_(base) {}
+
+            [[nodiscard]] Iterator base() const {return base_;}
+            reference operator*() const {
+                auto tmp = base_;
+                return *--tmp;
+            }
+            pointer operator->() const {return &operator*();}
+            reference operator[](const difference_type n) const {return *(*this + n);}
+
+            ReverseDequeIterator& operator++() {
+                --base_;
+                return *this;
+            }
+            ReverseDequeIterator operator++(int) {
+                auto tmp = *this;
+                --base_;
+                return tmp;
+            }
+            ReverseDequeIterator& operator--() {
+                ++base_;
+                return *this;
+            }
+            ReverseDequeIterator operator--(int) {
+                auto tmp = *this;
+                ++base_;
+                return tmp;
+            }
+            ReverseDequeIterator& operator+=(const difference_type n) {
+                base_ -= n;
+                return *this;
+            }
+            ReverseDequeIterator& operator-=(const difference_type n) {
+                base_ += n;
+                return *this;
+            }
+            friend ReverseDequeIterator operator+(const ReverseDequeIterator& it, const difference_type n) {
+                return ReverseDequeIterator(it.base_ - n);
+            }
+            ReverseDequeIterator operator-(const difference_type n) const {
+                return ReverseDequeIterator(base_ + n);
+            }
+            difference_type operator-(const ReverseDequeIterator& another) const {
+                return another.base_ - base_;
             }
+
+            bool operator==(const ReverseDequeIterator& another) const {
+                return base_ == another.base_;
+            }
+            bool operator!=(const ReverseDequeIterator& another) const {
+                return !(*this == another);
+            }
+            bool operator<(const ReverseDequeIterator& another) const {
+                return another.base_ < base_;
+            }
+        };
+    }
+
+    // 分块的双端队列：元素放在固定大小的块中，中控数组 map_ 按顺序保存各块的首地址
+    // 第 i 个元素的位置是 start_ + i，块号是位置 / B，块内偏移是位置 % B，所以随机访问是 O(1)
+    // 两端插入时最多申请一块，中控数组不够时先在原数组中居中，放不下才加倍，均摊 O(1)；元素本身永远不会搬动
+    // 两端插入、删除之后迭代器失效，但其他元素的引用保持有效
+    // 一端删空的块留一块备用，队列这种一端进一端出的用法稳定之后不再申请内存
+    // MODE 表示哪些端可以进出，关闭的操作不能调用（编译期报错）
+    template <class T, DEQUE::DEQUE_TYPE MODE = DEQUE::ALL, class Alloc = Allocator<T>>
+    class deque {
+        using block_point = T*;
+        using map_point = block_point*;
+        using mapAllocator = typename Alloc::template rebind<block_point>::other;
+        using length_type = size_t;
+    public:
+        constexpr static length_type BLOCK_ELEMENTS = mzDeque::default_block_elements<T>();
+        using data_type = T;
+        using allocator_type = Alloc;
+        using Iterator = mzDeque::DequeIterator<T, BLOCK_ELEMENTS>;
+        using ConstIterator = mzDeque::DequeIterator<const T, BLOCK_ELEMENTS>;
+        using ReverseIterator = mzDeque::ReverseDequeIterator<Iterator>;
+        using ConstReverseIterator = mzDeque::ReverseDequeIterator<ConstIterator>;
+
+    private:
+        constexpr static length_type MIN_MAP_SIZE = 8;
+
+        map_point map_{nullptr};
+        length_type map_size_{0};
+        length_type start_{0};  // 第一个元素的位置；为空时对齐到块的开头
+        length_type size_{0};
+        block_point spare_{nullptr};  // 备用的空块
+        [[no_unique_address]] Alloc alloc_;
+
+        // [start_ / B, (start_ + size_ - 1) / B] 中的块已经申请，其余都是 nullptr；末尾位置 (start_ + size_) 所在的块号小于 map_size_
+        block_point& block_of(const length_type position) const {return map_[position / BLOCK_ELEMENTS];}
+        T* address_of(const length_type position) const {return block_of(position) + position % BLOCK_ELEMENTS;}
+        Iterator iterator_at(const length_type position) const {
+            return map_ == nullptr ? Iterator() : Iterator(map_ + position / BLOCK_ELEMENTS, position % BLOCK_ELEMENTS);
         }
-        T& front() {
-            return data.front();
+        // position 所在的块没有申请就申请（优先用备用块），返回是否新申请
+        bool acquire_block(length_type position);
+        // 块中已经没有元素，放回备用或释放
+        void release_block(length_type position);
+        // 中控数组在 at_front 一端留出一个空位；只修改块的位置，不搬动元素
+        void reserve_map(bool at_front);
+        // 为空时回到中控数组的中间，两端都有空位
+        void recenter() {start_ = map_size_ / 2 * BLOCK_ELEMENTS;}
+        // 两端的插入与删除，不受 MODE 限制，拷贝与构造时也用它们
+        template<class... Args>
+        T& construct_back(Args&&... args);
+        template<class... Args>
+        T& construct_front(Args&&... args);
+        bool destroy_back();
+        bool destroy_front();
+
+        deque& copy_from(const deque& another);
+
+    public:
+        deque() = default;
+        explicit deque(const Alloc& alloc) : alloc_(alloc) {}
+        deque(const deque& another);
+        deque(deque&& another) noexcept;
+        deque(length_type n, const T& value, const Alloc& alloc = Alloc());
+        template<class InputIterator>
+        requires(not std::is_integral_v<InputIterator>)
+        deque(InputIterator first, InputIterator last, const Alloc& alloc = Alloc());
+        deque(const std::initializer_list<T>& il, const Alloc& alloc = Alloc());
+        ~deque();
+
+        [[nodiscard]] Alloc get_allocator() const {return alloc_;}
+
+        deque& operator=(const deque& another);
+        deque& operator=(deque&& another) noexcept;
+        deque& operator=(const std::initializer_list<T>& il);
+
+        bool operator==(const deque& another) const;
+        bool operator!=(const deque& another) const {return !(*this == another);}
+
+        // 迭代器相关
+        Iterator begin() {return iterator_at(start_);}
+        Iterator end() {return iterator_at(start_ + size_);}
+        ConstIterator begin() const {return iterator_at(start_);}
+        ConstIterator end() const {return iterator_at(start_ + size_);}
+        ConstIterator cbegin() const {return iterator_at(start_);}
+        ConstIterator cend() const {return iterator_at(start_ + size_);}
+        ReverseIterator rbegin() {return ReverseIterator(end());}
+        ReverseIterator rend() {return ReverseIterator(begin());}
+        ConstReverseIterator crbegin() const {return ConstReverseIterator(cend());}
+        ConstReverseIterator crend() const {return ConstReverseIterator(cbegin());}
+
+        // 获取大小
+        [[nodiscard]] length_type size() const {return size_;}
+        [[nodiscard]] bool empty() const {return size_ == 0;}
+
+        // 获取元素，O(1)；operator[] 按 TINYWHEELS_BOUNDS_CHECK 检查下标，at() 始终检查
+        T& operator[](length_type index) {check_index(index, size_); return *address_of(start_ + index);}
+        const T& operator[](length_type index) const {check_index(index, size_); return *address_of(start_ + index);}
+        T& at(length_type index) {check_at(index, size_); return *address_of(start_ + index);}
+        const T& at(length_type index) const {check_at(index, size_); return *address_of(start_ + index);}
+        T& front() {return *address_of(start_);}
+        const T& front() const {return *address_of(start_);}
+        T& back() {return *address_of(start_ + size_ - 1);}
+        const T& back() const {return *address_of(start_ + size_ - 1);}
+
+        // 两端插入与删除，均摊 O(1)；参数可以引用容器中的元素，因为元素不会搬动
+        void push_back(const T& value) requires(bool(MODE & DEQUE::BACK_INPUT)) {construct_back(value);}
+        void push_back(T&& value) requires(bool(MODE & DEQUE::BACK_INPUT)) {construct_back(std::move(value));}
+        template<class... Args>
+        T& emplace_back(Args&&... args) requires(bool(MODE & DEQUE::BACK_INPUT)) {
+            return construct_back(std::forward<Args>(args)...);
         }
-        T& back() {
-            return data.back();
+        void push_front(const T& value) requires(bool(MODE & DEQUE::FRONT_INPUT)) {construct_front(value);}
+        void push_front(T&& value) requires(bool(MODE & DEQUE::FRONT_INPUT)) {construct_front(std::move(value));}
+        template<class... Args>
+        T& emplace_front(Args&&... args) requires(bool(MODE & DEQUE::FRONT_INPUT)) {
+            return construct_front(std::forward<Args>(args)...);
         }
-        bool empty() {
-            return data.empty();
+        bool pop_back() requires(bool(MODE & DEQUE::BACK_OUTPUT)) {return destroy_back();}
+        bool pop_front() requires(bool(MODE & DEQUE::FRONT_OUTPUT)) {return destroy_front();}
+        // 析构所有元素，释放所有块，中控数组保留
+        void clear();
+
+        // swap
+        // 成员 swap 会挡住友元 swap 的查找，所以成员函数中直接交换，友元转调成员
+        void swap(deque& another) noexcept {
+            tinyWheels::swap(map_, another.map_);
+            tinyWheels::swap(map_size_, another.map_size_);
+            tinyWheels::swap(start_, another.start_);
+            tinyWheels::swap(size_, another.size_);
+            tinyWheels::swap(spare_, another.spare_);
+            tinyWheels::swap(alloc_, another.alloc_);
         }
-        size_t size() {
-            return data.size();
+        friend void swap(deque& a, deque& b) noexcept {
+            a.swap(b);
         }
 
-        Iterator begin() {return data.begin();}
-        Iterator end() {return data.end();}
-        Iterator rbegin() {return data.rbegin();}
-        Iterator rend() {return data.rend();}
-        Iterator cbegin() {return data.cbegin();}
-        Iterator cend() {return data.cend();}
-        Iterator crbegin() {return data.crbegin();}
-        Iterator crend() {return data.crend();}
-
-        friend void swap(deque& lhs, deque& rhs) noexcept{
-            tinyWheels::swap(lhs.data, rhs.data);
-        }
-        void swap(deque& other) noexcept{
-            swap(*this, other);
+        friend std::ostream& operator<<(std::ostream& os, const deque& d) {
+            if constexpr (is_ostream_writable_v<T>) {
+                for (auto it = d.cbegin(); it != d.cend(); ++it) {
+                    if (it != d.cbegin()) os << ", ";
+                    os << *it;
+                }
+                os << " (" << d.size_ << ")";
+            }else {
+                os << "deque<" << typeid(T).name() << ">" << " size: " << d.size_;
+            }
+            return os;
         }
     };
+
+    // 使用 memory_resource 的 deque，块与中控数组都从同一个内存资源中申请
+    namespace pmr {
+        template<class T, DEQUE::DEQUE_TYPE MODE = DEQUE::ALL>
+        using deque = tinyWheels::deque<T, MODE, PolymorphicAllocator<T>>;
+    }
 }
 #endif //DEQUE_DEF_H
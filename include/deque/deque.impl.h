@@ -4,5 +4,239 @@
 
 #ifndef DEQUE_IMPL_H
 #define DEQUE_IMPL_H
+#include "deque.def.h"
+
+namespace tinyWheels {
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    bool deque<T, MODE, Alloc>::acquire_block(const length_type position) {
+        auto &block = block_of(position);
+        if (block != nullptr) {
+            return false;
+        }
+        if (spare_ != nullptr) {
+            block = spare_;
+            spare_ = nullptr;
+        }else {
+            block = alloc_.allocate(BLOCK_ELEMENTS).first;
+        }
+        return true;
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    void deque<T, MODE, Alloc>::release_block(const length_type position) {
+        auto &block = block_of(position);
+        if (spare_ == nullptr) {
+            spare_ = block;
+        }else {
+            alloc_.deallocate(block, BLOCK_ELEMENTS);
+        }
+        block = nullptr;
+    }
+
+    // 已用的块（包括末尾位置所在的块）加上要留出的一块，不超过中控数组的一半就在原数组中居中，否则换成至少两倍大的数组
+    // 居中之后两端的空位一样多，所以队列这种一直向一端移动的用法每走过半个数组才居中一次，均摊 O(1)
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    void deque<T, MODE, Alloc>::reserve_map(const bool at_front) {
+        const auto first_block = start_ / BLOCK_ELEMENTS;
+        const auto live = (start_ + size_) / BLOCK_ELEMENTS - first_block + 1;
+        const auto need = live + 1;
+        map_point map = map_;
+        auto map_size = map_size_;
+        if (need * 2 > map_size_) {
+            mapAllocator map_alloc(alloc_);
+            const auto [memory, capacity] = map_alloc.allocate(std::max({map_size_ * 2, need * 2, MIN_MAP_SIZE}));
+            map = memory;
+            map_size = capacity;
+            std::fill(map, map + map_size, nullptr);
+        }
+        const auto new_first = (map_size - need) / 2 + (at_front ? 1 : 0);
+        if (map_ != nullptr) {
+            if (map == map_) {
+                std::memmove(map + new_first, map_ + first_block, live * sizeof(block_point));
+                // 移走之后空出来的位置清空
+                if (new_first < first_block) {
+                    std::fill(map + std::max(new_first + live, first_block), map + first_block + live, nullptr);
+                }else {
+                    std::fill(map + first_block, map + std::min(new_first, first_block + live), nullptr);
+                }
+            }else {
+                std::copy(map_ + first_block, map_ + first_block + live, map + new_first);
+                mapAllocator(alloc_).deallocate(map_, map_size_);
+            }
+        }
+        map_ = map;
+        map_size_ = map_size;
+        start_ = new_first * BLOCK_ELEMENTS + start_ % BLOCK_ELEMENTS;
+    }
+
+    // 构造抛出异常时，刚申请的块放回去，什么都没有改变
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    template<class... Args>
+    T &deque<T, MODE, Alloc>::construct_back(Args &&... args) {
+        if ((start_ + size_ + 1) / BLOCK_ELEMENTS >= map_size_) {
+            reserve_map(false);
+        }
+        const auto position = start_ + size_;
+        const auto fresh = acquire_block(position);
+        try {
+            std::construct_at(address_of(position), std::forward<Args>(args)...);
+        }catch (...) {
+            if (fresh) release_block(position);
+            throw;
+        }
+        ++size_;
+        return *address_of(position);
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    template<class... Args>
+    T &deque<T, MODE, Alloc>::construct_front(Args &&... args) {
+        if (start_ == 0) {
+            reserve_map(true);
+        }
+        const auto position = start_ - 1;
+        const auto fresh = acquire_block(position);
+        try {
+            std::construct_at(address_of(position), std::forward<Args>(args)...);
+        }catch (...) {
+            if (fresh) release_block(position);
+            throw;
+        }
+        start_ = position;
+        ++size_;
+        return *address_of(position);
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    bool deque<T, MODE, Alloc>::destroy_back() {
+        if (size_ == 0) return false;
+        const auto position = start_ + size_ - 1;
+        std::destroy_at(address_of(position));
+        --size_;
+        if (size_ == 0) {
+            release_block(position);
+            recenter();
+        }else if (position % BLOCK_ELEMENTS == 0) {
+            release_block(position);
+        }
+        return true;
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    bool deque<T, MODE, Alloc>::destroy_front() {
+        if (size_ == 0) return false;
+        const auto position = start_;
+        std::destroy_at(address_of(position));
+        --size_;
+        ++start_;
+        if (size_ == 0) {
+            release_block(position);
+            recenter();
+        }else if (start_ % BLOCK_ELEMENTS == 0) {
+            release_block(position);
+        }
+        return true;
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    void deque<T, MODE, Alloc>::clear() {
+        if (size_ == 0) return;
+        const auto last = start_ + size_;
+        for (auto position = start_; position < last;) {
+            const auto block_end = std::min(last, (position / BLOCK_ELEMENTS + 1) * BLOCK_ELEMENTS);
+            std::destroy(address_of(position), address_of(position) + (block_end - position));
+            release_block(position);
+            position = block_end;
+        }
+        size_ = 0;
+        recenter();
+    }
+
+    // 只拷贝元素，分配器保持不变；拷贝不受 MODE 限制
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    deque<T, MODE, Alloc> &deque<T, MODE, Alloc>::copy_from(const deque &another) {
+        if (this != &another) {
+            clear();
+            for (auto it = another.cbegin(); it != another.cend(); ++it) {
+                construct_back(*it);
+            }
+        }
+        return *this;
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    deque<T, MODE, Alloc>::deque(const deque &another) : alloc_(another.alloc_) {
+        copy_from(another);
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    deque<T, MODE, Alloc>::deque(deque &&another) noexcept : alloc_(another.alloc_) {
+        swap(another);
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    deque<T, MODE, Alloc>::deque(const length_type n, const T &value, const Alloc &alloc) : alloc_(alloc) {
+        for (length_type i = 0; i < n; ++i) {
+            construct_back(value);
+        }
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    template<class InputIterator>
+    requires(not std::is_integral_v<InputIterator>)
+    deque<T, MODE, Alloc>::deque(InputIterator first, InputIterator last, const Alloc &alloc) : alloc_(alloc) {
+        for (; first != last; ++first) {
+            construct_back(*first);
+        }
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    deque<T, MODE, Alloc>::deque(const std::initializer_list<T> &il, const Alloc &alloc)
+        : deque(il.begin(), il.end(), alloc) {
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    deque<T, MODE, Alloc>::~deque() {
+        clear();
+        if (spare_ != nullptr) {
+            alloc_.deallocate(spare_, BLOCK_ELEMENTS);
+        }
+        if (map_ != nullptr) {
+            mapAllocator(alloc_).deallocate(map_, map_size_);
+        }
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    deque<T, MODE, Alloc> &deque<T, MODE, Alloc>::operator=(const deque &another) {
+        return copy_from(another);
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    deque<T, MODE, Alloc> &deque<T, MODE, Alloc>::operator=(deque &&another) noexcept {
+        if (this != &another) {
+            swap(another);
+        }
+        return *this;
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    deque<T, MODE, Alloc> &deque<T, MODE, Alloc>::operator=(const std::initializer_list<T> &il) {
+        clear();
+        for (const auto &value : il) {
+            construct_back(value);
+        }
+        return *this;
+    }
+
+    template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+    bool deque<T, MODE, Alloc>::operator==(const deque &another) const {
+        if (size_ != another.size_) return false;
+        for (auto a = cbegin(), b = another.cbegin(); a != cend(); ++a, ++b) {
+            if (not (*a == *b)) return false;
+        }
+        return true;
+    }
+}
 
 #endif //DEQUE_IMPL_H
@@ -9,6 +9,7 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 namespace tinyWheels{
     class exception final : public std::exception {
@@ -25,8 +26,11 @@ namespace tinyWheels{
             vsnprintf(msg, len+1, fmt, args);
             va_end(args);
         }
+        // 消息由 malloc 申请，复制时另外复制一份，否则两个对象析构时会释放两次
+        exception(const exception &e) : msg(strdup(e.msg)) {}
+        exception &operator=(const exception &) = delete;
         ~exception() override {
-            delete[] msg;
+            free(msg);
         };
         [[nodiscard]] const char *what() const noexcept override { return msg; }
     };
@@ -0,0 +1,316 @@
+//
+// Created by 24983 on 25-3-25.
+//
+
+#ifndef INTRUSIVE_LIST_H
+#define INTRUSIVE_LIST_H
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include "exception.h"
+#include "iterator.h"
+#include "utility.h"
+
+namespace tinyWheels {
+    template<class T, class Tag> class intrusive_list;
+    template<class T, class Tag> class IntrusiveListIterator;
+
+    // 侵入式链表的钩子：对象继承它，链表只链接钩子，不申请节点，也不复制对象
+    // 一个对象要同时在几个链表中（例如 LRU 链与超时队列），就继承几个 Tag 不同的钩子
+    // 复制对象时不复制链接状态，新对象不在任何链表中；对象析构之前必须先从链表中删除
+    template<class Tag = void>
+    class intrusive_list_hook {
+        template<class, class> friend class intrusive_list;
+        template<class, class> friend class IntrusiveListIterator;
+
+        intrusive_list_hook *prev_{nullptr};
+        intrusive_list_hook *next_{nullptr};
+    public:
+        intrusive_list_hook() = default;
+        intrusive_list_hook(const intrusive_list_hook &) noexcept {}
+        intrusive_list_hook &operator=(const intrusive_list_hook &) noexcept {return *this;}
+        ~intrusive_list_hook() {
+            assert(not is_linked() && "object destroyed while still in an intrusive_list");
+        }
+        [[nodiscard]] bool is_linked() const {return next_ != nullptr;}
+    };
+
+    // 迭代器只保存钩子的指针，end() 是链表自己的哨兵钩子，只有指向元素时才转换为 T
+    template<class T, class Tag>
+    class IntrusiveListIterator {
+        template<class, class> friend class intrusive_list;
+        template<class, class> friend class IntrusiveListIterator;
+        using hook_type = std::conditional_t<std::is_const_v<T>, const intrusive_list_hook<Tag>, intrusive_list_hook<Tag>>;
+    public:
+        using iterator_category = bidirectional_iterator_tag;
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+    private:
+        hook_type *cur_{nullptr};
+    public:
+        IntrusiveListIterator() = default;
+        explicit IntrusiveListIterator(hook_type *cur) : cur_(cur) {}
+        // Iterator 可以转换为 ConstIterator
+        template<class U>
+        requires(std::is_const_v<T> and std::is_same_v<U, std::remove_const_t<T>>)
+        IntrusiveListIterator(const IntrusiveListIterator<U, Tag> &it) : cur_(it.cur_) {}
+
+        reference operator*() const {return static_cast<reference>(*cur_);}
+        pointer operator->() const {return &operator*();}
+
+        IntrusiveListIterator &operator++() {
+            cur_ = cur_->next_;
+            return *this;
+        }
+        IntrusiveListIterator operator++(int) {
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+        IntrusiveListIterator &operator--() {
+            cur_ = cur_->prev_;
+            return *this;
+        }
+        IntrusiveListIterator operator--(int) {
+            auto tmp = *this;
+            --(*this);
+            return tmp;
+        }
+
+        bool operator==(const IntrusiveListIterator &another) const {
+            return cur_ == another.cur_;
+        }
+        bool operator!=(const IntrusiveListIterator &another) const {
+            return !(*this == another);
+        }
+        friend void swap(IntrusiveListIterator &a, IntrusiveListIterator &b) noexcept {
+            a.swap(b);
+        }
+        void swap(IntrusiveListIterator &a) noexcept {
+            tinyWheels::swap(cur_, a.cur_);
+        }
+    };
+
+    // 侵入式双向链表：元素是继承了 intrusive_list_hook<Tag> 的对象，链表不拥有它们，插入、删除都是 O(1)，不申请内存
+    // 只知道对象的指针或引用就能 erase，适合连接的超时队列、LRU 链、定时器这种对象本来就放在别处的场景
+    // 链表是以自己的哨兵钩子为头的环，所以不能复制；移动时修正首尾元素指向哨兵的指针
+    // 链表析构或 clear 时只断开所有元素的链接，不析构元素
+    template<class T, class Tag = void>
+    class intrusive_list {
+        using hook = intrusive_list_hook<Tag>;
+        static_assert(std::is_base_of_v<hook, T>, "intrusive_list element must derive from intrusive_list_hook<Tag>");
+        using length_type = size_t;
+
+        hook head_;
+        length_type size_{0};
+
+        static hook *hook_of(T &value) {return static_cast<hook *>(&value);}
+        void reset() {
+            head_.prev_ = head_.next_ = &head_;
+            size_ = 0;
+        }
+        // 把 value 链接在 position 之前，value 已经在某个链表中时抛出异常
+        static void link_before(hook *position, hook *value);
+        static void unlink(hook *value);
+        // 把 [first, last] 摘下，链接在 position 之前
+        static void transfer(hook *position, hook *first, hook *last);
+        // 接管 another 的所有元素，another 变为空
+        void take(intrusive_list &another);
+
+    public:
+        using data_type = T;
+        using Iterator = IntrusiveListIterator<T, Tag>;
+        using ConstIterator = IntrusiveListIterator<const T, Tag>;
+
+        intrusive_list() {reset();}
+        intrusive_list(const intrusive_list &) = delete;
+        intrusive_list &operator=(const intrusive_list &) = delete;
+        intrusive_list(intrusive_list &&another) noexcept {
+            reset();
+            take(another);
+        }
+        intrusive_list &operator=(intrusive_list &&another) noexcept {
+            if (this != &another) {
+                clear();
+                take(another);
+            }
+            return *this;
+        }
+        ~intrusive_list() {
+            clear();
+            head_.prev_ = head_.next_ = nullptr;  // 哨兵自己也是钩子，析构时不能处于链接状态
+        }
+
+        // 获取大小
+        [[nodiscard]] length_type size() const {return size_;}
+        [[nodiscard]] bool empty() const {return size_ == 0;}
+
+        // 迭代器相关
+        Iterator begin() {return Iterator(head_.next_);}
+        Iterator end() {return Iterator(&head_);}
+        ConstIterator begin() const {return ConstIterator(head_.next_);}
+        ConstIterator end() const {return ConstIterator(&head_);}
+        ConstIterator cbegin() const {return ConstIterator(head_.next_);}
+        ConstIterator cend() const {return ConstIterator(&head_);}
+        // 由对象得到指向它的迭代器，O(1)
+        static Iterator iterator_to(T &value) {return Iterator(hook_of(value));}
+        static ConstIterator iterator_to(const T &value) {return ConstIterator(static_cast<const hook *>(&value));}
+
+        T &front() {return static_cast<T &>(*head_.next_);}
+        T &back() {return static_cast<T &>(*head_.prev_);}
+        const T &front() const {return static_cast<const T &>(*head_.next_);}
+        const T &back() const {return static_cast<const T &>(*head_.prev_);}
+
+        // 插入与删除元素；插入已经在链表中的对象会抛出异常
+        void push_back(T &value) {insert(end(), value);}
+        void push_front(T &value) {insert(begin(), value);}
+        bool pop_back();
+        bool pop_front();
+        // 把 value 插入到 position 之前，返回指向它的迭代器
+        Iterator insert(Iterator position, T &value);
+        // 删除 value，value 必须在这个链表中；返回下一个元素的位置
+        Iterator erase(T &value);
+        Iterator erase(Iterator position) {return erase(*position);}
+        // 删除满足 pred 的元素，返回删除的个数
+        template<class Predicate>
+        length_type remove_if(Predicate pred);
+        void clear();
+
+        // 把 other 中的 value 移到 position 之前，other 可以就是这个链表，O(1)；LRU 把访问过的元素移到开头就是这个操作
+        void splice(Iterator position, intrusive_list &other, T &value);
+        // 把 other 的所有元素移到 position 之前，O(1)
+        void splice(Iterator position, intrusive_list &other);
+
+        // swap
+        // 成员 swap 会挡住友元 swap 的查找，所以成员函数中直接交换，友元转调成员
+        void swap(intrusive_list &another) noexcept {
+            intrusive_list tmp(std::move(another));
+            another.take(*this);
+            take(tmp);
+        }
+        friend void swap(intrusive_list &a, intrusive_list &b) noexcept {
+            a.swap(b);
+        }
+    };
+
+    template<class T, class Tag>
+    void intrusive_list<T, Tag>::link_before(hook *position, hook *value) {
+        if (value->is_linked()) {
+            throw exception("对象已经在 intrusive_list 中，不能重复插入");
+        }
+        value->prev_ = position->prev_;
+        value->next_ = position;
+        position->prev_->next_ = value;
+        position->prev_ = value;
+    }
+
+    template<class T, class Tag>
+    void intrusive_list<T, Tag>::unlink(hook *value) {
+        value->prev_->next_ = value->next_;
+        value->next_->prev_ = value->prev_;
+        value->prev_ = value->next_ = nullptr;
+    }
+
+    template<class T, class Tag>
+    void intrusive_list<T, Tag>::transfer(hook *position, hook *first, hook *last) {
+        first->prev_->next_ = last->next_;
+        last->next_->prev_ = first->prev_;
+        first->prev_ = position->prev_;
+        last->next_ = position;
+        position->prev_->next_ = first;
+        position->prev_ = last;
+    }
+
+    template<class T, class Tag>
+    void intrusive_list<T, Tag>::take(intrusive_list &another) {
+        if (another.empty()) {
+            return;
+        }
+        transfer(&head_, another.head_.next_, another.head_.prev_);
+        size_ += another.size_;
+        another.size_ = 0;
+    }
+
+    template<class T, class Tag>
+    bool intrusive_list<T, Tag>::pop_back() {
+        if (size_ == 0) return false;
+        erase(back());
+        return true;
+    }
+
+    template<class T, class Tag>
+    bool intrusive_list<T, Tag>::pop_front() {
+        if (size_ == 0) return false;
+        erase(front());
+        return true;
+    }
+
+    template<class T, class Tag>
+    typename intrusive_list<T, Tag>::Iterator intrusive_list<T, Tag>::insert(Iterator position, T &value) {
+        link_before(position.cur_, hook_of(value));
+        ++size_;
+        return Iterator(hook_of(value));
+    }
+
+    template<class T, class Tag>
+    typename intrusive_list<T, Tag>::Iterator intrusive_list<T, Tag>::erase(T &value) {
+        const auto h = hook_of(value);
+        const auto next = h->next_;
+        unlink(h);
+        --size_;
+        return Iterator(next);
+    }
+
+    template<class T, class Tag>
+    template<class Predicate>
+    typename intrusive_list<T, Tag>::length_type intrusive_list<T, Tag>::remove_if(Predicate pred) {
+        length_type removed = 0;
+        for (auto it = begin(); it != end();) {
+            if (pred(*it)) {
+                it = erase(it);
+                ++removed;
+            }else {
+                ++it;
+            }
+        }
+        return removed;
+    }
+
+    template<class T, class Tag>
+    void intrusive_list<T, Tag>::clear() {
+        for (auto cur = head_.next_; cur != &head_;) {
+            const auto next = cur->next_;
+            cur->prev_ = cur->next_ = nullptr;
+            cur = next;
+        }
+        reset();
+    }
+
+    template<class T, class Tag>
+    void intrusive_list<T, Tag>::splice(Iterator position, intrusive_list &other, T &value) {
+        const auto h = hook_of(value);
+        if (h == position.cur_ or h->next_ == position.cur_) {
+            return;  // 已经在 position 之前
+        }
+        transfer(position.cur_, h, h);
+        if (&other != this) {
+            --other.size_;
+            ++size_;
+        }
+    }
+
+    template<class T, class Tag>
+    void intrusive_list<T, Tag>::splice(Iterator position, intrusive_list &other) {
+        if (&other == this or other.empty()) {
+            return;
+        }
+        transfer(position.cur_, other.head_.next_, other.head_.prev_);
+        size_ += other.size_;
+        other.size_ = 0;
+    }
+}
+
+#endif //INTRUSIVE_LIST_H
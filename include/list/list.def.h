@@ -6,10 +6,13 @@
 #define LIST_DEF_H
 
 #include <algorithm>
+#include <memory>
 #include <ostream>
 
 #include "iterator.h"
 #include "allocator.h"
+#include "bounds_check.h"
+#include "memory_resource.h"
 #include "traits.h"
 #include "utility.h"
 
@@ -30,6 +33,7 @@ namespace tinyWheels {
                     : data_(data), prev_(prev), next_(next) {}
             ~ListNode() = default;
             const T& data() const {return data_;}
+            T& data() {return data_;}
             void data(const T& data){data_ = data;}
             void data(T&& data) noexcept {data_ = std::move(data);}
             ListNode* prev() const {return prev_;}
@@ -158,21 +162,16 @@ namespace tinyWheels {
                 tmp -= n;
                 return tmp;
             }
-            difference_type operator-(const ListIterator& another) { // *this - another
+            // *this - another：同时从 another 和 *this 向后走，先遇到对方的一边决定正负，复杂度是 O(距离)，不会走到链表头
+            difference_type operator-(const ListIterator& another) const {
                 difference_type n = 0;
-                auto tmp = another;
-                while (tmp != *this and tmp.cur_ != nullptr) {
-                    --tmp;
-                    ++n;
+                for (auto a = another, b = *this; a.cur_ != nullptr or b.cur_ != nullptr; ++n) {
+                    if (a == *this) return n;
+                    if (b == another) return -n;
+                    if (a.cur_ != nullptr) ++a;
+                    if (b.cur_ != nullptr) ++b;
                 }
-                if (tmp == *this) return n;
-                tmp = *this;
-                n = 0;
-                while (tmp != another and tmp.cur_ != nullptr) {
-                    --tmp;
-                    --n;
-                }
-                return n;
+                return n;  // 不在同一个链表中
             }
 
             bool operator==(const ListIterator &another) const {
@@ -183,11 +182,7 @@ namespace tinyWheels {
             }
 
             bool operator<(const ListIterator &another) const {
-                auto it = *this;
-                while (it != another and it != nullptr) {
-                    ++it;
-                }
-                return it == another;
+                return another - *this > 0;
             }
             bool operator>(const ListIterator &another) const {
                 return another < *this;
@@ -199,10 +194,10 @@ namespace tinyWheels {
                 return !(*this < another);
             }
             friend void swap(ListIterator& a, ListIterator& b) noexcept {
-                swap(a.cur_, b.cur_);
+                a.swap(b);
             }
             void swap(ListIterator& a) noexcept {
-                swap(*this, a);
+                tinyWheels::swap(cur_, a.cur_);
             }
         };
 
@@ -283,19 +278,14 @@ namespace tinyWheels {
                 tmp -= n;
                 return tmp;
             }
-            difference_type operator-(const ReverseListIterator& another) { // *this - another
+            // 与 ListIterator 相同，只是向前走
+            difference_type operator-(const ReverseListIterator& another) const {
                 difference_type n = 0;
-                auto tmp = another;
-                while (tmp != another and tmp.cur_ != nullptr) {
-                    --tmp;
-                    ++n;
-                }
-                if (tmp == *this) return n;
-                tmp = *this;
-                n = 0;
-                while (tmp != another and tmp.cur_ != nullptr) {
-                    --tmp;
-                    --n;
+                for (auto a = another, b = *this; a.cur_ != nullptr or b.cur_ != nullptr; ++n) {
+                    if (a == *this) return n;
+                    if (b == another) return -n;
+                    if (a.cur_ != nullptr) ++a;
+                    if (b.cur_ != nullptr) ++b;
                 }
                 return n;
             }
@@ -308,11 +298,7 @@ namespace tinyWheels {
             }
 
             bool operator<(const ReverseListIterator &another) const {
-                auto it = *this;
-                while (it != another and it.cur_ != nullptr) {
-                    ++it;
-                }
-                return it == another;
+                return another - *this > 0;
             }
             bool operator>(const ReverseListIterator &another) const {
                 return another < *this;
@@ -324,23 +310,24 @@ namespace tinyWheels {
                 return !(*this < another);
             }
             friend void swap(ReverseListIterator& a, ReverseListIterator& b) noexcept {
-                swap(a.cur_, b.cur_);
+                a.swap(b);
             }
             void swap(ReverseListIterator& a) noexcept {
-                swap(*this, a);
+                tinyWheels::swap(cur_, a.cur_);
             }
         };
 
     }
 
-    template <class T>
+    template <class T, class Alloc = Allocator<T>>
     class list {
         using node = mzList::ListNode<T>;
         using node_point = node*;
-        using nodeAllocator = Allocator<node>;
+        using nodeAllocator = typename Alloc::template rebind<node>::other;  // 实际申请的是节点
         using length_type = size_t;
     public:
         using data_type = T;
+        using allocator_type = Alloc;
         using Iterator = mzList::ListIterator<node_point>;
         using ReverseIterator = mzList::ReverseListIterator<node*>;
         using ConstIterator = mzList::ListIterator<const node*>;
@@ -350,40 +337,79 @@ namespace tinyWheels {
         Iterator head_{nullptr};
         Iterator tail_{nullptr};
         length_type size_{0};
+        length_type churn_{0};       // 上次 compact 之后插入与删除的节点数
+        double compact_ratio_{0};    // auto_compact 设置的比例，0 表示不自动整理
+        [[no_unique_address]] nodeAllocator alloc_;
 
         list& copy_from(const list& l);
         list& move_from(list&& l) noexcept;
 
+        // 节点按批向分配器申请与释放，每批的地址放在栈上的数组里
+        constexpr static length_type BULK_NODES = 64;
+        void allocate_nodes(node_point *nodes, length_type n);    // 分配器提供 allocate_bulk 时整批申请，否则逐个申请
+        void deallocate_nodes(node_point *nodes, length_type n);  // 节点已经析构
+        // 申请 n 个节点，依次用 value_of() 的返回值构造，按顺序链接在 position 之前
+        template<class ValueOf>
+        void link_nodes(node_point position, length_type n, ValueOf&& value_of);
+
         void allocateAndFill(length_type n, const T& value);
         void allocateAndFill(length_type n, T&& value);
         void allocateAndFill(length_type n);
 
+        void destroy_nodes(node_point *nodes, length_type n);  // 析构并释放已经摘下的节点
+        // 把 [first, last) 从所在的链表摘下，链接到 position 之前，只修改指针，不修改 size_
+        static void transfer(node_point position, node_point first, node_point last);
+        // 节点由目标 list 的分配器释放，在两个 list 之间移动节点要求分配器相等
+        void check_same_allocator(const list& another) const;
+        // 合并两条以 nullptr 结尾、只用 next 链接的有序链，相等时 a 的节点在前
+        template<class Compare>
+        static node_point merge_runs(node_point a, node_point b, Compare& comp);
+        // 记录插入或删除了 n 个节点，达到 auto_compact 的比例时整理一次
+        constexpr static length_type AUTO_COMPACT_MIN_NODES = 1024;  // 太短的链表整理没有意义
+        void note_churn(length_type n);
+        // compact 中按地址排序的节点；std::sort 交换 node_point 时，T 在 tinyWheels 中（例如 string）会让
+        // tinyWheels::swap 与 std::swap 产生歧义，包一层并提供非模板的 swap
+        struct NodeAddress {
+            node_point node;
+            bool operator<(const NodeAddress& another) const {return std::less<node_point>()(node, another.node);}
+            friend void swap(NodeAddress& a, NodeAddress& b) noexcept {
+                const auto tmp = a.node;
+                a.node = b.node;
+                b.node = tmp;
+            }
+        };
+
     public:
 
+        // 同一个 list 的所有节点都由同一个分配器申请，拷贝构造会复制分配器
         list();
+        explicit list(const Alloc& alloc);
         list(const list& l);  // 拷贝构造函数
         // 移动构造函数
         list(list&& l) noexcept;
-        explicit list(length_type n);
-        list(length_type n, const T& value);
-        list(length_type n, T&& value);
+        explicit list(length_type n, const Alloc& alloc = Alloc());
+        list(length_type n, const T& value, const Alloc& alloc = Alloc());
+        list(length_type n, T&& value, const Alloc& alloc = Alloc());
         template<class InputIterator>
         requires(not std::is_integral_v<InputIterator>)
-        list(InputIterator first, InputIterator last);
-        list(const std::initializer_list<T>& il);
-        list(std::initializer_list<T>&& il);
+        list(InputIterator first, InputIterator last, const Alloc& alloc = Alloc());
+        list(const std::initializer_list<T>& il, const Alloc& alloc = Alloc());
+        list(std::initializer_list<T>&& il, const Alloc& alloc = Alloc());
         ~list();  // 析构函数
 
+        [[nodiscard]] Alloc get_allocator() const {return Alloc(alloc_);}
+        void clear();
+
         // 迭代器相关
         Iterator begin() const {return head_+1;}
         Iterator end() const {return tail_;}
-        ConstIterator cbegin() const {return head_+1;}
-        ConstIterator cend() const {return tail_;}
+        ConstIterator cbegin() const {return ConstIterator(head_.get()->next());}
+        ConstIterator cend() const {return ConstIterator(tail_.get());}
 
-        ReverseIterator rbegin() const {return ReverseIterator(tail_-1);}
-        ReverseIterator rend() const {return ReverseIterator(head_);}
-        ConstReverseIterator crbegin() const {return ConstReverseIterator(tail_-1);}
-        ConstReverseIterator crend() const {return ConstReverseIterator(head_);}
+        ReverseIterator rbegin() const {return ReverseIterator(tail_.get()->prev());}
+        ReverseIterator rend() const {return ReverseIterator(head_.get());}
+        ConstReverseIterator crbegin() const {return ConstReverseIterator(tail_.get()->prev());}
+        ConstReverseIterator crend() const {return ConstReverseIterator(head_.get());}
 
         list& operator=(const list& l);
         list& operator=(list&& l) noexcept;
@@ -394,7 +420,9 @@ namespace tinyWheels {
         bool operator!=(const list &another) const {return !(*this == another);}
 
         // 获取元素，效率很慢的
-        T& operator[](length_type index);  // 保证复杂度在 O(n/2) 完成
+        T& operator[](length_type index);  // 保证复杂度在 O(n/2) 完成，按 TINYWHEELS_BOUNDS_CHECK 检查下标
+        T& front() {return head_.get()->next()->data();}
+        T& back() {return tail_.get()->prev()->data();}
 
         // 插入与删除元素
         void push_back(const T& value);
@@ -410,7 +438,7 @@ namespace tinyWheels {
         template<class InputIterator> void insert(InputIterator it, length_type n, const T& value);
         template<class InputIterator> void insert(InputIterator it, length_type n, T&& value);
         template<class InputIterator, class InputIterator2>
-        requires(not std::is_integral_v<InputIterator>)
+        requires(not std::is_integral_v<InputIterator2>)
         void insert(InputIterator it, InputIterator2 first, InputIterator2 last);
 
         // 删除元素
@@ -424,15 +452,49 @@ namespace tinyWheels {
         template<class InputIterator, class InputIterator2>
         list& merge(InputIterator it, InputIterator2 first, InputIterator2 last, length_type n);
 
+        // 下面的操作都只修改节点的 prev、next，不复制元素，也不申请内存，迭代器与引用保持有效
+
+        // 稳定的自底向上归并排序，O(n log n)；有序链放在栈上的数组里，不申请内存；comp 抛出异常时恢复原来的顺序
+        template<class Compare = std::less<T>>
+        void sort(Compare comp = Compare());
+        // 把有序的 other 合并进来，other 变为空；两个 list 的分配器不相等时抛出异常
+        template<class Compare = std::less<T>>
+        void merge(list& other, Compare comp = Compare());
+        // 把 other 的节点移到 position 之前：整个 other 与单个节点是 O(1)；
+        // 一段节点需要数出个数，是 O(这一段的长度)，已经知道个数 n 时是 O(1)；同一个 list 内移动不需要计数
+        void splice(Iterator position, list& other);
+        void splice(Iterator position, list&& other) {splice(position, other);}
+        void splice(Iterator position, list& other, Iterator it);
+        void splice(Iterator position, list& other, Iterator first, Iterator last);
+        void splice(Iterator position, list& other, Iterator first, Iterator last, length_type n);
+        // 删除相邻的重复元素、等于 value 的元素、满足 pred 的元素，返回删除的个数；节点按批还给分配器
+        template<class BinaryPredicate = std::equal_to<T>>
+        length_type unique(BinaryPredicate pred = BinaryPredicate());
+        length_type remove(const T& value);
+        template<class Predicate>
+        length_type remove_if(Predicate pred);
+
+        // 按遍历顺序整理节点：第 i 个元素放到地址第 i 小的节点中，再按地址顺序重新链接，遍历时访问的地址单调递增
+        // 节点不重新申请（重新申请也只会拿到同样分散的空闲块），只移动元素，临时申请 (sizeof(T) + 8) * size() 字节，O(n log n)
+        // 元素换了节点，所有迭代器与引用失效；要求 T 的移动不抛出异常
+        void compact();
+        // ratio > 0 时，插入与删除的节点数累计达到 ratio * size() 之后，在那一次插入或删除的最后自动 compact，
+        // 均摊到每次操作是 O(log n)；会让迭代器失效，所以默认关闭，传入 0 关闭；T 的移动可能抛出异常时不自动整理
+        void auto_compact(const double ratio) {compact_ratio_ = ratio < 0 ? 0 : ratio;}
+
         // swap
-        friend void swap(list& l1, list& l2) noexcept {
-            tinyWheels::swap(l1.head_, l2.head_);
-            tinyWheels::swap(l1.tail_, l2.tail_);
-            tinyWheels::swap(l1.size_, l2.size_);
+        // 成员 swap 会挡住友元 swap 的查找，所以成员函数中直接交换，友元转调成员
+        void swap(list& l) noexcept {
+            tinyWheels::swap(head_, l.head_);
+            tinyWheels::swap(tail_, l.tail_);
+            tinyWheels::swap(size_, l.size_);
+            tinyWheels::swap(churn_, l.churn_);
+            tinyWheels::swap(compact_ratio_, l.compact_ratio_);
+            tinyWheels::swap(alloc_, l.alloc_);
         }
 
-        void swap(list& l) noexcept {
-            swap(*this, l);
+        friend void swap(list& l1, list& l2) noexcept {
+            l1.swap(l2);
         }
 
         friend std::ostream& operator<<(std::ostream& os, const list& l) {
@@ -448,6 +510,12 @@ namespace tinyWheels {
             return os;
         }
     };
+
+    // 使用 memory_resource 的 list，例如 pmr::list<int> l(&arena)，所有元素都从 arena 中申请
+    namespace pmr {
+        template<class T>
+        using list = tinyWheels::list<T, PolymorphicAllocator<T>>;
+    }
 }
 
 #endif //LIST_DEF_H
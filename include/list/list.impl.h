@@ -9,188 +9,222 @@
 
 namespace tinyWheels {
 
-    template<class T>
-    void list<T>::allocateAndFill(length_type n) {
-        auto [ptr, cap] = nodeAllocator::allocate(n);
-        auto prev_address = head_;
-        Iterator next_address(nullptr);
-        for (auto i = 0; i < n; ++i) {
-            next_address = i < n - 1 ? Iterator(ptr+i+1): tail_;
-            nodeAllocator::construct(ptr + i, 1, T(), prev_address.get(), next_address.get());
-            prev_address = ptr + i;
-        }
-        head_.get()->next(ptr);
-        tail_.get()->prev(ptr + n - 1);
-        size_ = n;
-    }
-
-    template<class T>
-    void list<T>::allocateAndFill(length_type n, const T &value) {
-        auto [ptr, cap] = nodeAllocator::allocate(n);
-        auto prev_address = head_;
-        Iterator next_address(nullptr);
-        for (auto i = 0; i < n; ++i) {
-            next_address = i < n - 1 ? Iterator(ptr+i+1): tail_;
-            nodeAllocator::construct(ptr + i, 1, value, prev_address.get(), next_address.get());
-            prev_address = ptr + i;
-        }
-        head_.get()->next(ptr);
-        tail_.get()->prev(ptr + n - 1);
-        size_ = n;
-    }
-    template<class T>
-    void list<T>::allocateAndFill(length_type n, T &&value) {
-        auto [ptr, cap] = nodeAllocator::allocate(n);
-        auto prev_address = head_;
-        Iterator next_address(nullptr);
-        for (auto i = 0; i < n; ++i) {
-            next_address = i < n - 1 ? Iterator(ptr+i+1): tail_;
-            nodeAllocator::construct(ptr + i, 1, std::forward<T>(value), prev_address.get(), next_address.get());
-            prev_address = ptr + i;
-        }
-        head_.get()->next(ptr);
-        tail_.get()->prev(ptr + n - 1);
-        size_ = n;
-    }
-
-
-    template<class T>
-    list<T>& list<T>::copy_from(const list &l) {
+    template<class T, class Alloc>
+    void list<T, Alloc>::allocate_nodes(node_point *nodes, const length_type n) {
+        if constexpr (bulk_allocator<nodeAllocator, node>) {
+            alloc_.allocate_bulk(nodes, n);
+        }else {
+            for (length_type i = 0; i < n; ++i) {
+                nodes[i] = alloc_.allocate(1).first;
+            }
+        }
+    }
+
+    template<class T, class Alloc>
+    void list<T, Alloc>::deallocate_nodes(node_point *nodes, const length_type n) {
+        if constexpr (bulk_allocator<nodeAllocator, node>) {
+            alloc_.deallocate_bulk(nodes, n);
+        }else {
+            for (length_type i = 0; i < n; ++i) {
+                alloc_.deallocate(nodes[i], 1);
+            }
+        }
+    }
+
+    template<class T, class Alloc>
+    void list<T, Alloc>::destroy_nodes(node_point *nodes, const length_type n) {
+        for (length_type i = 0; i < n; ++i) {
+            nodeAllocator::Destruct(nodes[i], 1);
+        }
+        deallocate_nodes(nodes, n);
+    }
+
+    // 每个节点仍然是一个独立的内存块，可以逐个 erase；构造抛出异常时已经链接的节点保留，这一批剩下的节点还给分配器
+    template<class T, class Alloc>
+    template<class ValueOf>
+    void list<T, Alloc>::link_nodes(const node_point position, length_type n, ValueOf &&value_of) {
+        node_point nodes[BULK_NODES];
+        auto prev = position->prev();
+        while (n > 0) {
+            const auto batch = n < BULK_NODES ? n : BULK_NODES;
+            allocate_nodes(nodes, batch);
+            length_type i = 0;
+            try {
+                for (; i < batch; ++i) {
+                    nodeAllocator::construct(nodes[i], 1, value_of(), prev, position);
+                    prev->next(nodes[i]);
+                    prev = nodes[i];
+                }
+            }catch (...) {
+                position->prev(prev);
+                size_ += i;
+                deallocate_nodes(nodes + i, batch - i);
+                throw;
+            }
+            position->prev(prev);
+            size_ += batch;
+            n -= batch;
+        }
+    }
+
+    template<class T, class Alloc>
+    void list<T, Alloc>::allocateAndFill(length_type n) {
+        link_nodes(tail_.get(), n, [] {return T();});
+    }
+
+    template<class T, class Alloc>
+    void list<T, Alloc>::allocateAndFill(length_type n, const T &value) {
+        link_nodes(tail_.get(), n, [&value]() -> const T & {return value;});
+    }
+    template<class T, class Alloc>
+    void list<T, Alloc>::allocateAndFill(length_type n, T &&value) {
+        allocateAndFill(n, static_cast<const T &>(value));  // 每个节点都需要一份拷贝，不能多次移动同一个值
+    }
+
+
+    // 只拷贝元素，分配器保持不变
+    template<class T, class Alloc>
+    list<T, Alloc>& list<T, Alloc>::copy_from(const list &l) {
         if (this != &l) {
-            ~list();
-            auto size = l.size_;
-            auto [start, cap] = nodeAllocator::allocate(size);
+            clear();
             auto it = l.begin();
-            auto prev_address = head_;
-            Iterator next_address(nullptr);
-            for (auto i = 0; i < size; ++i, ++it) {
-                next_address = i < size - 1 ? Iterator(start+i+1) : tail_;
-                nodeAllocator::construct(start + i, 1, *it, prev_address.get(), next_address.get());
-                prev_address = start + i;
-            }
-            head_.get()->next(start);
-            tail_.get()->prev(start + size - 1);
-            size_ = size;
+            link_nodes(tail_.get(), l.size_, [&it]() -> const T & {
+                const auto node = it.get();
+                ++it;
+                return node->data();
+            });
         }
         return *this;
     }
 
-    template<class T>
-    list<T> &list<T>::move_from(list &&l) noexcept {
+    // 交换整条链表（包括头尾哨兵与分配器），原来的节点随 l 析构，由申请它们的分配器释放
+    template<class T, class Alloc>
+    list<T, Alloc> &list<T, Alloc>::move_from(list &&l) noexcept {
         if (this != &l) {
-            ~list();
-            *this = std::move(l);
+            this->swap(l);
         }
         return *this;
     }
 
-    template<class T>
-    list<T>::list() {  // 默认初始化
-        auto[ptr, cap] = nodeAllocator::allocate(2);
+    template<class T, class Alloc>
+    list<T, Alloc>::list() : list(Alloc()) {  // 默认初始化
+    }
+
+    // 头尾两个哨兵节点一起申请，析构时一起释放
+    template<class T, class Alloc>
+    list<T, Alloc>::list(const Alloc &alloc) : alloc_(alloc) {
+        auto[ptr, cap] = alloc_.allocate(2);
         nodeAllocator::construct(ptr, 1, T(), nullptr, ptr + 1);
         nodeAllocator::construct(ptr + 1, 1, T(), ptr, nullptr);
         head_ = ptr;
         tail_ = ptr + 1;
     }
 
-    template<class T>
-    list<T>::list(const list &l):list() {
-        copy_from(std::forward<list>(l));
+    template<class T, class Alloc>
+    list<T, Alloc>::list(const list &l):list(l.alloc_) {
+        copy_from(l);
     }
 
-    template<class T>
-    list<T>::list(list &&l) noexcept :list() {
+    template<class T, class Alloc>
+    list<T, Alloc>::list(list &&l) noexcept :list(l.alloc_) {
         move_from(std::forward<list>(l));
     }
 
-    template<class T>
-    list<T>::list(const length_type n) :list(){
+    template<class T, class Alloc>
+    list<T, Alloc>::list(const length_type n, const Alloc &alloc) :list(alloc){
         allocateAndFill(n);
     }
-    template<class T>
-    list<T>::list(length_type n, const T &value) :list(){
+    template<class T, class Alloc>
+    list<T, Alloc>::list(length_type n, const T &value, const Alloc &alloc) :list(alloc){
         allocateAndFill(n, value);
     }
-    template<class T>
-    list<T>::list(length_type n, T &&value) :list(){
+    template<class T, class Alloc>
+    list<T, Alloc>::list(length_type n, T &&value, const Alloc &alloc) :list(alloc){
         allocateAndFill(n, value);
     }
 
-    template<class T>
+    template<class T, class Alloc>
     template<class InputIterator>
     requires(not std::is_integral_v<InputIterator>)
-    list<T>::list(InputIterator first, InputIterator last) :list(){
-        if constexpr (std::is_integral_v<InputIterator>) {
-            allocateAndFill(first, last);
-        }else {
-            auto it = first;
-            auto prev_address = head_;
-            while (it != last) {
-                auto [ptr, cap] = nodeAllocator::allocate(1);
-                if constexpr (std::is_same_v<InputIterator, Iterator>) {
-                    nodeAllocator::construct(ptr, 1, (*it).data(), prev_address.get(), tail_.get());
-                }else {
-                    nodeAllocator::construct(ptr, 1, *it, prev_address.get(), tail_.get());
-                }
-                prev_address->next(ptr);  // 上一个地址的下一个地址是ptr
-                prev_address = ptr;
+    list<T, Alloc>::list(InputIterator first, InputIterator last, const Alloc &alloc) :list(alloc){
+        auto it = first;
+        link_nodes(tail_.get(), abs(last - first), [&it]() -> const T & {
+            if constexpr (std::is_same_v<InputIterator, Iterator>) {
+                const auto node = it.get();
                 ++it;
-                ++size_;
+                return node->data();
+            }else {
+                const T &value = *it;
+                ++it;
+                return value;
             }
-            tail_.get()->prev(prev_address.get());
-        }
+        });
     }
 
-    template<class T>
-    list<T>::list(const std::initializer_list<T> &il):list(il.begin(), il.end()) {
+    template<class T, class Alloc>
+    list<T, Alloc>::list(const std::initializer_list<T> &il, const Alloc &alloc):list(il.begin(), il.end(), alloc) {
     }
-    template<class T>
-    list<T>::list(std::initializer_list<T> &&il):list(il.begin(), il.end()) {
+    template<class T, class Alloc>
+    list<T, Alloc>::list(std::initializer_list<T> &&il, const Alloc &alloc):list(il.begin(), il.end(), alloc) {
     }
 
-    template<class T>
-    list<T>::~list() {
-        auto it = begin();
-        while (it != end()) {
-            auto tmp = it;
-            ++it;
-            // 删除tmp并回收空间
-            nodeAllocator::Destruct(tmp.get(), 1);
-            nodeAllocator::deallocate(tmp.get(), 1);
+    template<class T, class Alloc>
+    list<T, Alloc>::~list() {
+        clear();
+        nodeAllocator::Destruct(head_.get(), 1);
+        nodeAllocator::Destruct(tail_.get(), 1);
+        alloc_.deallocate(head_.get(), 2);
+    }
+
+    // 删除所有元素，只保留头尾哨兵，节点按批还给分配器
+    template<class T, class Alloc>
+    void list<T, Alloc>::clear() {
+        node_point nodes[BULK_NODES];
+        length_type count = 0;
+        for (auto cur = head_.get()->next(); cur != tail_.get();) {
+            const auto next = cur->next();
+            nodes[count++] = cur;
+            if (count == BULK_NODES) {
+                destroy_nodes(nodes, count);
+                count = 0;
+            }
+            cur = next;
         }
+        destroy_nodes(nodes, count);
+        head_.get()->next(tail_.get());
+        tail_.get()->prev(head_.get());
+        size_ = 0;
     }
 
-    template<class T>
-    list<T> &list<T>::operator=(const list &l) {
+    template<class T, class Alloc>
+    list<T, Alloc> &list<T, Alloc>::operator=(const list &l) {
         if (this != &l) {
-            copy_from(std::forward<list>(l));
+            copy_from(l);
         }
         return *this;
     }
-    template<class T>
-    list<T> &list<T>::operator=(list &&l) noexcept {
+    template<class T, class Alloc>
+    list<T, Alloc> &list<T, Alloc>::operator=(list &&l) noexcept {
         if (this != &l) {
             move_from(std::forward<list>(l));
         }
         return *this;
     }
 
-    template<class T>
-    list<T> &list<T>::operator=(const std::initializer_list<T> &il) {
-        ~list();
-        *this = list(std::forward<std::initializer_list<T>>(il));
+    template<class T, class Alloc>
+    list<T, Alloc> &list<T, Alloc>::operator=(const std::initializer_list<T> &il) {
+        *this = list(il, alloc_);
         return *this;
     }
 
-    template<class T>
-    list<T> &list<T>::operator=(std::initializer_list<T> &&il) {
-        ~list();
-        *this = list(std::forward<std::initializer_list<T>>(il));
+    template<class T, class Alloc>
+    list<T, Alloc> &list<T, Alloc>::operator=(std::initializer_list<T> &&il) {
+        *this = list(il, alloc_);
         return *this;
     }
 
-    template<class T>
-    bool list<T>::operator==(const list &l) const {
+    template<class T, class Alloc>
+    bool list<T, Alloc>::operator==(const list &l) const {
         if (size_ != l.size_) return false;
         auto it1 = begin();
         auto it2 = l.begin();
@@ -202,141 +236,436 @@ namespace tinyWheels {
         return true;
     }
 
-    template<class T>
-    T &list<T>::operator[](length_type index) {
-        if (index >= size_) throw exception("index out of range, index: %lu, size: %lu", index, size_);
+    // 从离 index 较近的一端开始走
+    template<class T, class Alloc>
+    T &list<T, Alloc>::operator[](length_type index) {
+        check_index(index, size_);
+        node_point cur;
         if (index < size_ / 2) {
-            auto it = begin();
-            while (index) {
-                --index;
-                ++it;
+            for (cur = head_.get()->next(); index > 0; --index) {
+                cur = cur->next();
+            }
+        }else {
+            for (cur = tail_.get()->prev(), index = size_ - index - 1; index > 0; --index) {
+                cur = cur->prev();
             }
-            return *it;
-        }
-        index = size_ - index - 1;
-        auto it = rbegin();
-        while (index) {
-            --index;
-            ++it;
         }
-        return *it;
+        return cur->data();
     }
 
     // 插入与删除元素
-    template<class T>
-    void list<T>::push_back(const T& value) {
-        insert(end(), std::forward<T>(value));
+    template<class T, class Alloc>
+    void list<T, Alloc>::push_back(const T& value) {
+        insert(end(), value);
     }
-    template<class T>
-    void list<T>::push_back(T&& value) {
+    template<class T, class Alloc>
+    void list<T, Alloc>::push_back(T&& value) {
         insert(end(), std::forward<T>(value));
     }
-    template<class T>
-    void list<T>::push_front(const T &value) {
-        insert(begin(), std::forward<T>(value));
+    template<class T, class Alloc>
+    void list<T, Alloc>::push_front(const T &value) {
+        insert(begin(), value);
     }
-    template<class T>
-    void list<T>::push_front(T &&value) {
+    template<class T, class Alloc>
+    void list<T, Alloc>::push_front(T &&value) {
         insert(begin(), std::forward<T>(value));
     }
 
-    template<class T>
-    bool list<T>::pop_back() {
+    template<class T, class Alloc>
+    bool list<T, Alloc>::pop_back() {
         if (size_ == 0) return false;
         auto it = tail_.get()->prev();
-        it.get()->prev()->next(it->next());
-        it.get()->next()->prev(it->prev());
+        it->prev()->next(it->next());
+        it->next()->prev(it->prev());
         nodeAllocator::Destruct(it, 1);
-        nodeAllocator::deallocate(it, 1);
+        alloc_.deallocate(it, 1);
         --size_;
+        note_churn(1);
         return true;
     }
-    template<class T>
-    bool list<T>::pop_front() {
+    template<class T, class Alloc>
+    bool list<T, Alloc>::pop_front() {
         if (size_ == 0) return false;
         auto it = head_->next();
-        it.get()->prev()->next(it.get()->next());
-        it.get()->next()->prev(it.get()->prev());
+        it->prev()->next(it->next());
+        it->next()->prev(it->prev());
         nodeAllocator::Destruct(it, 1);
-        nodeAllocator::deallocate(it, 1);
+        alloc_.deallocate(it, 1);
         --size_;
+        note_churn(1);
         return true;
     }
 
-    template<class T>
+    template<class T, class Alloc>
     template<class InputIterator>
-    void list<T>::insert(InputIterator it, const T &value) {
-        insert(it, 1, std::forward<T>(value));
+    void list<T, Alloc>::insert(InputIterator it, const T &value) {
+        insert(it, 1, value);
     }
-    template<class T>
+    template<class T, class Alloc>
     template<class InputIterator>
-    void list<T>::insert(InputIterator it, T &&value) {
+    void list<T, Alloc>::insert(InputIterator it, T &&value) {
         insert(it, 1, std::forward<T>(value));
     }
-    template<class T>
+    template<class T, class Alloc>
     template<class InputIterator>
-    void list<T>::insert(InputIterator it, length_type n, const T &value) {
-        list l(n, std::forward<T>(value));
-        merge(it, l.begin(), l.end(), n);
+    void list<T, Alloc>::insert(InputIterator it, length_type n, const T &value) {
+        link_nodes(it.get(), n, [&value]() -> const T & {return value;});  // 直接链接在 it 之前，不需要临时链表
+        note_churn(n);
     }
-    template<class T>
+    template<class T, class Alloc>
     template<class InputIterator>
-    void list<T>::insert(InputIterator it, length_type n, T &&value) {
-        list l(n, std::forward<T>(value));
-        merge(it, l.begin(), l.end(), n);
+    void list<T, Alloc>::insert(InputIterator it, length_type n, T &&value) {
+        link_nodes(it.get(), n, [&value]() -> const T & {return value;});  // 直接链接在 it 之前，不需要临时链表
+        note_churn(n);
     }
 
-    template<class T>
+    template<class T, class Alloc>
     template<class InputIterator, class InputIterator2>
-    requires(not std::is_integral_v<InputIterator>)
-    void list<T>::insert(InputIterator it, InputIterator2 first, InputIterator2 last) {
+    requires(not std::is_integral_v<InputIterator2>)
+    void list<T, Alloc>::insert(InputIterator it, InputIterator2 first, InputIterator2 last) {
         // if constexpr (std::is_integral_v<InputIterator2>) {
         //     insert(it, static_cast<length_type>(first), static_cast<InputIterator2>(last));
         // }else {
-            list l(first, last);
-            merge(it, l.begin(), l.end(), abs(last - first));
+            list l(first, last, alloc_);
+            const length_type n = abs(last - first);
+            merge(it, l.begin(), l.end(), n);
+            note_churn(n);
         // }
     }
 
-    template<class T>
+    template<class T, class Alloc>
     template<class InputIterator>
-    void list<T>::erase(InputIterator it) {
+    void list<T, Alloc>::erase(InputIterator it) {
         erase(it, it+1);
     }
 
     // 删除 [first, last)
-    template<class T>
+    template<class T, class Alloc>
     template<class InputIterator>
-    void list<T>::erase(InputIterator first, InputIterator last) {
+    void list<T, Alloc>::erase(InputIterator first, InputIterator last) {
         // 提取 [first, last) 之间的节点到新链表，等l自然析构即可
-        list l;
+        list l(alloc_);  // 节点最后由 l 释放，必须使用同一个分配器
         auto length = abs(last - first);
         l.merge(l.begin(), first, last, length);  // 无所谓多长
         size_ -= length;
+        note_churn(length);
     }
 
 
-    template<class T>
+    template<class T, class Alloc>
     template<class InputIterator, class InputIterator2>
-    list<T>& list<T>::merge(InputIterator it, InputIterator2 first, InputIterator2 last, length_type n) {
-        auto head = first.get();
-        auto tail = (*last).prev();
+    list<T, Alloc>& list<T, Alloc>::merge(InputIterator it, InputIterator2 first, InputIterator2 last, length_type n) {
+        transfer(it.get(), first.get(), last.get());
+        size_ += n;
+        return *this;
+    }
+
+    template<class T, class Alloc>
+    void list<T, Alloc>::transfer(const node_point position, const node_point first, const node_point last) {
+        if (first == last or position == last) {
+            return;
+        }
+        const auto tail = last->prev();
 
         // 1. 脱离
-        head->prev()->next(tail->next());
-        tail->next()->prev(head->prev());
+        first->prev()->next(last);
+        last->prev(first->prev());
 
         // 2. 加入
-        auto it_prev = (*it).prev();
-        auto cur = it.get();
+        const auto before = position->prev();
+        before->next(first);
+        first->prev(before);
+        tail->next(position);
+        position->prev(tail);
+    }
 
-        it_prev->next(head);
-        head->prev(it_prev);
+    template<class T, class Alloc>
+    void list<T, Alloc>::check_same_allocator(const list &another) const {
+        if (not (alloc_ == another.alloc_)) {
+            throw exception("list 的分配器不相等，不能移动节点");
+        }
+    }
 
-        tail->next(cur);
-        cur->prev(tail);
-        size_ += n;
-        return *this;
+    template<class T, class Alloc>
+    template<class Compare>
+    typename list<T, Alloc>::node_point list<T, Alloc>::merge_runs(node_point a, node_point b, Compare &comp) {
+        node_point first;
+        if (comp(b->data(), a->data())) {
+            first = b;
+            b = b->next();
+        }else {
+            first = a;
+            a = a->next();
+        }
+        auto last = first;
+        while (a != nullptr and b != nullptr) {
+            if (comp(b->data(), a->data())) {
+                last->next(b);
+                last = b;
+                b = b->next();
+            }else {
+                last->next(a);
+                last = a;
+                a = a->next();
+            }
+        }
+        last->next(a != nullptr ? a : b);
+        return first;
+    }
+
+    // runs[i] 是长度为 2^i 的有序链（或者为空），每取下一个节点就像二进制加一那样向上合并，最后从低到高合并剩下的链
+    // 排序过程中只修改 next，prev 保持原来的顺序，所以 comp 抛出异常时可以沿着 prev 恢复；排完之后再一次性重建 prev
+    template<class T, class Alloc>
+    template<class Compare>
+    void list<T, Alloc>::sort(Compare comp) {
+        if (size_ < 2) {
+            return;
+        }
+        const auto head = head_.get(), tail = tail_.get();
+        node_point runs[sizeof(length_type) * 8] = {};
+        length_type levels = 0;
+        tail->prev()->next(nullptr);
+        try {
+            for (auto cur = head->next(); cur != nullptr;) {
+                const auto next = cur->next();
+                cur->next(nullptr);
+                auto carry = cur;
+                length_type i = 0;
+                for (; runs[i] != nullptr; ++i) {
+                    carry = merge_runs(runs[i], carry, comp);  // runs[i] 中的节点更早，放在前面保证稳定
+                    runs[i] = nullptr;
+                }
+                runs[i] = carry;
+                levels = i + 1 > levels ? i + 1 : levels;
+                cur = next;
+            }
+            node_point sorted = nullptr;
+            for (length_type i = 0; i < levels; ++i) {
+                if (runs[i] != nullptr) {
+                    sorted = sorted == nullptr ? runs[i] : merge_runs(runs[i], sorted, comp);
+                }
+            }
+            auto prev = head;
+            for (auto cur = sorted; cur != nullptr; cur = cur->next()) {
+                prev->next(cur);
+                cur->prev(prev);
+                prev = cur;
+            }
+            prev->next(tail);
+            tail->prev(prev);
+        }catch (...) {
+            for (auto cur = tail; cur != head; cur = cur->prev()) {
+                cur->prev()->next(cur);
+            }
+            throw;
+        }
+    }
+
+    template<class T, class Alloc>
+    void list<T, Alloc>::note_churn(const length_type n) {
+        churn_ += n;
+        // 移动可能抛出异常的类型不自动整理，否则每个修改操作都要实例化 compact 中的 static_assert
+        if constexpr (std::is_nothrow_move_constructible_v<T> and std::is_nothrow_move_assignable_v<T>) {
+            if (compact_ratio_ > 0 and size_ >= AUTO_COMPACT_MIN_NODES and static_cast<double>(churn_) >= compact_ratio_ * static_cast<double>(size_)) {
+                compact();
+            }
+        }
+    }
+
+    // 沿着链表把元素依次移到临时数组 values 中，同时记下节点地址；地址排序之后，
+    // 地址第 i 小的节点放入第 i 个元素，按地址顺序写回并重新链接。只有收集的那一遍是随机访问，写回是顺序的
+    // 临时数组申请失败时链表保持不变
+    template<class T, class Alloc>
+    void list<T, Alloc>::compact() {
+        static_assert(std::is_nothrow_move_constructible_v<T> and std::is_nothrow_move_assignable_v<T>,
+                      "list::compact requires nothrow move");
+        churn_ = 0;
+        if (size_ < 2) {
+            return;
+        }
+        using valueAllocator = typename Alloc::template rebind<T>::other;
+        using addressAllocator = typename Alloc::template rebind<NodeAddress>::other;
+        valueAllocator value_alloc(alloc_);
+        addressAllocator address_alloc(alloc_);
+        const auto [values, values_cap] = value_alloc.allocate(size_);
+        decltype(address_alloc.allocate(size_)) node_block;
+        try {
+            node_block = address_alloc.allocate(size_);
+        }catch (...) {
+            value_alloc.deallocate(values, values_cap);
+            throw;
+        }
+        const auto nodes = node_block.first;
+        const auto head = head_.get(), tail = tail_.get();
+        length_type n = 0;
+        for (auto cur = head->next(); cur != tail; cur = cur->next()) {
+            std::construct_at(values + n, std::move(cur->data()));
+            nodes[n] = NodeAddress{cur};
+            ++n;
+        }
+        std::sort(nodes, nodes + n);
+
+        auto prev = head;
+        for (length_type i = 0; i < n; ++i) {
+            const auto cur = nodes[i].node;
+            cur->data() = std::move(values[i]);
+            std::destroy_at(values + i);
+            prev->next(cur);
+            cur->prev(prev);
+            prev = cur;
+        }
+        prev->next(tail);
+        tail->prev(prev);
+        address_alloc.deallocate(nodes, node_block.second);
+        value_alloc.deallocate(values, values_cap);
+    }
+
+    // 每次把 other 中从 b 开始、小于 a 的一段整体移过来；comp 抛出异常时已经移过来的节点留在这里，两边的 size_ 保持正确
+    template<class T, class Alloc>
+    template<class Compare>
+    void list<T, Alloc>::merge(list &other, Compare comp) {
+        if (&other == this or other.empty()) {
+            return;
+        }
+        check_same_allocator(other);
+        const auto other_end = other.tail_.get();
+        auto a = head_.get()->next();
+        auto b = other.head_.get()->next();
+        while (a != tail_.get() and b != other_end) {
+            if (not comp(b->data(), a->data())) {
+                a = a->next();
+                continue;
+            }
+            auto run_end = b->next();
+            length_type n = 1;
+            while (run_end != other_end and comp(run_end->data(), a->data())) {
+                run_end = run_end->next();
+                ++n;
+            }
+            transfer(a, b, run_end);
+            size_ += n;
+            other.size_ -= n;
+            b = run_end;
+        }
+        if (b != other_end) {
+            transfer(tail_.get(), b, other_end);
+            size_ += other.size_;
+            other.size_ = 0;
+        }
+    }
+
+    template<class T, class Alloc>
+    void list<T, Alloc>::splice(Iterator position, list &other) {
+        if (&other == this or other.empty()) {
+            return;
+        }
+        check_same_allocator(other);
+        transfer(position.get(), other.head_.get()->next(), other.tail_.get());
+        size_ += other.size_;
+        other.size_ = 0;
+    }
+
+    template<class T, class Alloc>
+    void list<T, Alloc>::splice(Iterator position, list &other, Iterator it) {
+        if (position == it) {
+            return;  // 移到自己之前，位置不变；transfer 会把节点摘下之后链接到自己身上
+        }
+        if (&other != this) {
+            check_same_allocator(other);
+            --other.size_;
+            ++size_;
+        }
+        transfer(position.get(), it.get(), it.get()->next());
+    }
+
+    template<class T, class Alloc>
+    void list<T, Alloc>::splice(Iterator position, list &other, Iterator first, Iterator last) {
+        length_type n = 0;
+        if (&other != this) {
+            for (auto cur = first.get(); cur != last.get(); cur = cur->next()) {
+                ++n;
+            }
+        }
+        splice(position, other, first, last, n);
+    }
+
+    // position 不能在 [first, last) 之中
+    template<class T, class Alloc>
+    void list<T, Alloc>::splice(Iterator position, list &other, Iterator first, Iterator last, const length_type n) {
+        if (&other != this) {
+            check_same_allocator(other);
+            other.size_ -= n;
+            size_ += n;
+        }
+        transfer(position.get(), first.get(), last.get());
+    }
+
+    // 删除的节点先摘下放进数组，攒满一批再析构、释放；pred 抛出异常时释放已经摘下的节点
+    template<class T, class Alloc>
+    template<class BinaryPredicate>
+    typename list<T, Alloc>::length_type list<T, Alloc>::unique(BinaryPredicate pred) {
+        node_point nodes[BULK_NODES];
+        length_type count = 0, removed = 0;
+        try {
+            for (auto kept = head_.get()->next(); kept != tail_.get() and kept->next() != tail_.get();) {
+                const auto cur = kept->next();
+                if (not pred(kept->data(), cur->data())) {
+                    kept = cur;
+                    continue;
+                }
+                kept->next(cur->next());
+                cur->next()->prev(kept);
+                --size_;
+                ++removed;
+                nodes[count++] = cur;
+                if (count == BULK_NODES) {
+                    destroy_nodes(nodes, count);
+                    count = 0;
+                }
+            }
+        }catch (...) {
+            destroy_nodes(nodes, count);
+            throw;
+        }
+        destroy_nodes(nodes, count);
+        note_churn(removed);
+        return removed;
+    }
+
+    template<class T, class Alloc>
+    template<class Predicate>
+    typename list<T, Alloc>::length_type list<T, Alloc>::remove_if(Predicate pred) {
+        node_point nodes[BULK_NODES];
+        length_type count = 0, removed = 0;
+        try {
+            for (auto cur = head_.get()->next(); cur != tail_.get();) {
+                const auto next = cur->next();
+                if (pred(cur->data())) {
+                    cur->prev()->next(next);
+                    next->prev(cur->prev());
+                    --size_;
+                    ++removed;
+                    nodes[count++] = cur;
+                    if (count == BULK_NODES) {
+                        destroy_nodes(nodes, count);
+                        count = 0;
+                    }
+                }
+                cur = next;
+            }
+        }catch (...) {
+            destroy_nodes(nodes, count);
+            throw;
+        }
+        destroy_nodes(nodes, count);
+        note_churn(removed);
+        return removed;
+    }
+
+    // value 可能就是某个要删除的元素，节点按批释放之后它会失效，所以先复制一份
+    template<class T, class Alloc>
+    typename list<T, Alloc>::length_type list<T, Alloc>::remove(const T &value) {
+        return remove_if([copy = value](const T &x) {return x == copy;});
     }
 
 }
@@ -0,0 +1,152 @@
+//
+// Created by 24983 on 25-3-20.
+//
+
+#ifndef MAPPED_VECTOR_H
+#define MAPPED_VECTOR_H
+
+#include <cstdint>
+#include <type_traits>
+#include "MappedFile.h"
+#include "bounds_check.h"
+#include "exception.h"
+#include "span.h"
+
+namespace tinyWheels {
+    // 元素保存在文件中的 vector：文件整个映射到内存，元素直接在映射上读写，进程重启之后打开文件就能继续使用，不需要重新构建
+    // 只能保存平凡可复制的类型（不能有指针指向进程内的内存）；文件格式是 64 字节的文件头加上连续的元素，
+    // 文件头记录魔数、元素大小与元素个数，不记录字节序，只能在同一种机器上读写
+    // 文件的大小就是容量，扩容时 ftruncate 之后重新映射，容量至少翻倍；修改在 flush 之后才保证写到磁盘
+    template<class T>
+    class mapped_vector {
+        static_assert(std::is_trivially_copyable_v<T>, "mapped_vector only stores trivially copyable types");
+    public:
+        using length_type = size_t;
+        using Iterator = T*;
+        using ConstIterator = const T*;
+        constexpr static size_t HEADER_BYTES = 64;  // 元素从这里开始，映射按页对齐，所以对齐不超过 64 的类型都能直接访问
+        static_assert(alignof(T) <= HEADER_BYTES, "mapped_vector element alignment must not exceed 64");
+    private:
+        struct Header {
+            uint64_t magic;
+            uint64_t element_bytes;
+            uint64_t size;
+        };
+        constexpr static uint64_t MAGIC = 0x31304345564d5754;  // "TWMVEC01"
+        constexpr static length_type MIN_CAPACITY = 64;
+
+        MappedFile file_;
+
+        [[nodiscard]] Header *header() const {return static_cast<Header *>(file_.data());}
+        [[nodiscard]] T *data_pointer() const {
+            return file_.data() == nullptr ? nullptr : reinterpret_cast<T *>(static_cast<char *>(file_.data()) + HEADER_BYTES);
+        }
+        void check_writable() const {
+            if (not file_.writable()) {
+                throw exception("mapped_vector 以只读方式打开，不能修改");
+            }
+        }
+        // 检查已有文件的文件头；空文件并且可写时写入新的文件头
+        void validate(const char *path) {
+            if (file_.bytes() == 0 and file_.writable()) {
+                file_.resize(HEADER_BYTES);
+                *header() = Header{MAGIC, sizeof(T), 0};
+                return;
+            }
+            if (file_.bytes() < HEADER_BYTES or header()->magic != MAGIC) {
+                throw exception("不是 mapped_vector 文件：%s", path);
+            }
+            if (header()->element_bytes != sizeof(T)) {
+                throw exception("元素大小不一致：%s 中是 %lu 字节，需要 %lu 字节", path, header()->element_bytes, sizeof(T));
+            }
+            if (header()->size > capacity()) {
+                throw exception("文件被截断：%s 记录了 %lu 个元素，只能放下 %lu 个", path, header()->size, capacity());
+            }
+        }
+    public:
+        mapped_vector() = default;
+        // 打开 path，read_only 为 false 时文件不存在就创建；只读打开只映射文件，检查文件头，不读取元素，是 O(1) 的
+        explicit mapped_vector(const char *path, const bool read_only = false)
+            : file_(path, read_only ? MappedFile::Mode::READ_ONLY : MappedFile::Mode::READ_WRITE) {
+            validate(path);
+        }
+        mapped_vector(mapped_vector &&) noexcept = default;
+        mapped_vector &operator=(mapped_vector &&) noexcept = default;
+
+        [[nodiscard]] length_type size() const {return file_.data() == nullptr ? 0 : header()->size;}
+        [[nodiscard]] length_type capacity() const {
+            return file_.bytes() < HEADER_BYTES ? 0 : (file_.bytes() - HEADER_BYTES) / sizeof(T);
+        }
+        [[nodiscard]] bool empty() const {return size() == 0;}
+        [[nodiscard]] bool read_only() const {return not file_.writable();}
+        [[nodiscard]] bool is_open() const {return file_.is_open();}
+
+        // 把文件扩展到能放下 n 个元素，映射的地址可能改变，之前的指针与迭代器失效
+        void reserve(const length_type n) {
+            check_writable();
+            if (n > capacity()) {
+                file_.resize(HEADER_BYTES + n * sizeof(T));
+            }
+        }
+        void resize(const length_type n, const T &value = T()) {
+            reserve(n);
+            for (auto i = size(); i < n; ++i) {
+                data_pointer()[i] = value;
+            }
+            header()->size = n;
+        }
+        void push_back(const T &value) {
+            if (size() == capacity()) {
+                const T copy = value;  // value 可能就在映射中，扩容之后地址会失效
+                reserve(capacity() < MIN_CAPACITY ? MIN_CAPACITY : capacity() * 2);
+                data_pointer()[header()->size++] = copy;
+                return;
+            }
+            check_writable();
+            data_pointer()[header()->size++] = value;
+        }
+        bool pop_back() {
+            check_writable();
+            if (empty()) {
+                return false;
+            }
+            --header()->size;
+            return true;
+        }
+        void clear() {
+            check_writable();
+            header()->size = 0;
+        }
+        // 把文件截断到正好放下 size() 个元素
+        void shrink_to_fit() {
+            check_writable();
+            file_.resize(HEADER_BYTES + size() * sizeof(T));
+        }
+        // 把修改写回文件，async 为 true 时只发起写回不等待
+        void flush(const bool async = false) const {
+            file_.flush(async);
+        }
+
+        // 只读打开时映射不可写，通过非 const 的引用写入会收到 SIGSEGV
+        // operator[] 按 TINYWHEELS_BOUNDS_CHECK 检查，at() 始终检查
+        T &operator[](const length_type index) {check_index(index, size()); return data_pointer()[index];}
+        const T &operator[](const length_type index) const {check_index(index, size()); return data_pointer()[index];}
+        T &at(const length_type index) {check_at(index, size()); return data_pointer()[index];}
+        const T &at(const length_type index) const {check_at(index, size()); return data_pointer()[index];}
+        T &back() {return data_pointer()[size() - 1];}
+
+        Iterator begin() {return data_pointer();}
+        Iterator end() {return data_pointer() + size();}
+        ConstIterator begin() const {return data_pointer();}
+        ConstIterator end() const {return data_pointer() + size();}
+        ConstIterator cbegin() const {return data_pointer();}
+        ConstIterator cend() const {return data_pointer() + size();}
+        T *data() {return data_pointer();}
+        const T *data() const {return data_pointer();}
+        // 不复制元素的视图，reserve 重新映射之后失效
+        span<T> as_span() {return span<T>(data_pointer(), size());}
+        span<const T> as_span() const {return span<const T>(data_pointer(), size());}
+    };
+}
+
+#endif //MAPPED_VECTOR_H
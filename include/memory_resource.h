@@ -0,0 +1,195 @@
+//
+// Created by 24983 on 25-3-12.
+//
+
+#ifndef MEMORY_RESOURCE_H
+#define MEMORY_RESOURCE_H
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include "allocator.h"
+
+namespace tinyWheels {
+    // 内存资源：与 std::pmr::memory_resource 相同的接口，容器持有一个指针，不同的容器实例可以使用不同的内存来源
+    class memory_resource {
+    public:
+        using memory_size_type = size_t;
+        constexpr static memory_size_type DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+
+        virtual ~memory_resource() = default;
+
+        [[nodiscard]] void *allocate(const memory_size_type bytes, const memory_size_type alignment = DEFAULT_ALIGNMENT) {
+            return do_allocate(bytes, alignment);
+        }
+        // bytes 与 alignment 必须与申请时相同
+        void deallocate(void *address, const memory_size_type bytes, const memory_size_type alignment = DEFAULT_ALIGNMENT) {
+            do_deallocate(address, bytes, alignment);
+        }
+        // 一个资源申请的内存能否由另一个资源释放
+        [[nodiscard]] bool is_equal(const memory_resource &other) const noexcept {
+            return this == &other or do_is_equal(other);
+        }
+        friend bool operator==(const memory_resource &a, const memory_resource &b) noexcept {return a.is_equal(b);}
+    protected:
+        virtual void *do_allocate(memory_size_type bytes, memory_size_type alignment) = 0;
+        virtual void do_deallocate(void *address, memory_size_type bytes, memory_size_type alignment) = 0;
+        [[nodiscard]] virtual bool do_is_equal(const memory_resource &other) const noexcept {return this == &other;}
+    };
+
+    // 进程级内存池作为内存资源：小内存块走 MemoryPool 的大小类别，其他的走 allocate_large，对齐要求由 allocate_aligned 处理
+    class pool_memory_resource final : public memory_resource {
+    public:
+        static pool_memory_resource &instance();
+    protected:
+        void *do_allocate(memory_size_type bytes, memory_size_type alignment) override;
+        void do_deallocate(void *address, memory_size_type bytes, memory_size_type alignment) override;
+    };
+
+    // 默认内存资源，初始为 pool_memory_resource，设置为 nullptr 时恢复初始值，返回之前的默认资源
+    memory_resource *get_default_resource() noexcept;
+    memory_resource *set_default_resource(memory_resource *resource) noexcept;
+
+    // 单调缓冲区：只申请不释放，deallocate 什么也不做，release() 或析构时一次性把所有内存还给上游
+    // 适合一次请求内的临时容器：全部建在同一块区域里，请求结束时整体释放。不是线程安全的
+    class monotonic_buffer_resource final : public memory_resource {
+        struct Buffer {
+            Buffer *next;            // 上一次从上游申请的缓冲区
+            memory_size_type bytes;  // 向上游申请的总字节数，包括头部
+        };
+        constexpr static memory_size_type BUFFER_HEADER_BYTES = DEFAULT_ALIGNMENT;
+        static_assert(sizeof(Buffer) <= BUFFER_HEADER_BYTES);
+
+        memory_resource *upstream_;
+        void *initial_buffer_{nullptr};       // 使用者提供的初始缓冲区，不归本资源释放
+        memory_size_type initial_bytes_{0};
+        memory_size_type next_bytes_;         // 下一次向上游申请的大小，每次翻倍，release() 时改为最大的缓冲区
+        Buffer *buffers_{nullptr};            // 从上游申请的缓冲区串成的链表
+        char *current_{nullptr};              // 当前缓冲区中下一个可用的地址
+        memory_size_type left_bytes_{0};      // 当前缓冲区剩余的字节数
+    public:
+        constexpr static memory_size_type INITIAL_BYTES = 1024;  // 默认第一次向上游申请的大小
+
+        explicit monotonic_buffer_resource(memory_resource *upstream = get_default_resource());
+        explicit monotonic_buffer_resource(memory_size_type initial_bytes, memory_resource *upstream = get_default_resource());
+        monotonic_buffer_resource(void *buffer, memory_size_type bytes, memory_resource *upstream = get_default_resource());
+        monotonic_buffer_resource(const monotonic_buffer_resource &) = delete;
+        monotonic_buffer_resource &operator=(const monotonic_buffer_resource &) = delete;
+        ~monotonic_buffer_resource() override {release();}
+
+        // 把从上游申请的内存全部还回去，重新从初始缓冲区开始分配，之前分配的内存全部失效
+        void release();
+        [[nodiscard]] memory_resource *upstream_resource() const {return upstream_;}
+    protected:
+        void *do_allocate(memory_size_type bytes, memory_size_type alignment) override;
+        void do_deallocate(void *, memory_size_type, memory_size_type) override {}
+    };
+
+    // 加锁的池化资源：按 2 的幂划分大小类别，每个类别一条自由链表，大块内存从上游申请并按类别切分
+    // 超过 LARGEST_BLOCK 或者对齐超过 DEFAULT_ALIGNMENT 的内存直接向上游申请；release() 或析构时全部还给上游
+    class synchronized_pool_resource final : public memory_resource {
+        union Block {
+            Block *next;
+            char data[1];
+        };
+        // 从上游申请的大内存块，以及直接向上游申请的超大内存块，头部都放在最前面
+        struct Chunk {
+            Chunk *prev;
+            Chunk *next;
+            memory_size_type bytes;      // 向上游申请的总字节数
+            memory_size_type alignment;  // 向上游申请时的对齐，释放时原样传回
+        };
+        constexpr static memory_size_type CHUNK_HEADER_BYTES = 2 * DEFAULT_ALIGNMENT;
+        static_assert(sizeof(Chunk) <= CHUNK_HEADER_BYTES);
+    public:
+        constexpr static memory_size_type SMALLEST_BLOCK = 8;
+        constexpr static memory_size_type LARGEST_BLOCK = 4096;
+        constexpr static size_t POOL_NUMBER = 10;  // 8, 16, ..., 4096
+        constexpr static size_t MIN_BLOCKS_PER_CHUNK = 16;
+        constexpr static size_t MAX_BLOCKS_PER_CHUNK = 1024;
+    private:
+        struct Pool {
+            Block *free_list{nullptr};
+            size_t blocks_per_chunk{MIN_BLOCKS_PER_CHUNK};  // 每次申请大内存块时切分的数量，每次翻倍
+        };
+
+        memory_resource *upstream_;
+        std::mutex mutex_;
+        Pool pools_[POOL_NUMBER];
+        Chunk *chunks_{nullptr};   // 按类别切分的大内存块
+        Chunk *large_{nullptr};    // 直接向上游申请的超大内存块，双向链表，单独释放时摘下
+
+        static size_t pool_index(memory_size_type bytes);
+        Chunk *upstream_allocate(memory_size_type bytes, memory_size_type alignment, Chunk *&list);
+        void upstream_deallocate(Chunk *chunk, Chunk *&list);
+        void release_all(Chunk *&list);
+    public:
+        explicit synchronized_pool_resource(memory_resource *upstream = get_default_resource());
+        synchronized_pool_resource(const synchronized_pool_resource &) = delete;
+        synchronized_pool_resource &operator=(const synchronized_pool_resource &) = delete;
+        ~synchronized_pool_resource() override {release();}
+
+        // 把所有内存还给上游，之前分配的内存全部失效
+        void release();
+        [[nodiscard]] memory_resource *upstream_resource() const {return upstream_;}
+    protected:
+        void *do_allocate(memory_size_type bytes, memory_size_type alignment) override;
+        void do_deallocate(void *address, memory_size_type bytes, memory_size_type alignment) override;
+    };
+
+    // 持有 memory_resource 指针的分配器，接口与 Allocator<T> 相同，可以作为 vector、list 的 Alloc 参数
+    template<class T>
+    class PolymorphicAllocator {
+        using memory_size_type = size_t;
+        using variable_count = size_t;
+
+        memory_resource *resource_;
+    public:
+        using value_type = T;
+        template<class U>
+        struct rebind {
+            using other = PolymorphicAllocator<U>;
+        };
+
+        PolymorphicAllocator() noexcept : resource_(get_default_resource()) {}
+        // nullptr 表示默认资源
+        PolymorphicAllocator(memory_resource *resource) noexcept : resource_(resource != nullptr ? resource : get_default_resource()) {}
+        PolymorphicAllocator(const PolymorphicAllocator &) = default;
+        template<class U>
+        PolymorphicAllocator(const PolymorphicAllocator<U> &another) noexcept : resource_(another.resource()) {}
+        PolymorphicAllocator &operator=(const PolymorphicAllocator &) = default;
+        ~PolymorphicAllocator() = default;
+
+        [[nodiscard]] memory_resource *resource() const {return resource_;}
+
+        // 申请 number 个 T 的内存，返回地址以及容量，容量就是 number
+        std::pair<T *, memory_size_type> allocate(const variable_count number) {
+            return std::make_pair(static_cast<T *>(resource_->allocate(number * sizeof(T), alignof(T))), number);
+        }
+        void deallocate(T *start_memory, const variable_count number) {
+            if (start_memory == nullptr) {
+                return;
+            }
+            resource_->deallocate(start_memory, number * sizeof(T), alignof(T));
+        }
+
+        // 对象的构造与析构与内存来源无关，直接使用 Allocator<T> 的实现
+        template<class... Args>
+        static void construct(T *start_memory, const variable_count number, Args&&... args) {
+            Allocator<T>::construct(start_memory, number, std::forward<Args>(args)...);
+        }
+        static void construct(T *start_memory, const variable_count number) {
+            Allocator<T>::construct(start_memory, number);
+        }
+        static void Destruct(T *start_memory, const variable_count number) {
+            Allocator<T>::Destruct(start_memory, number);
+        }
+
+        template<class U>
+        friend bool operator==(const PolymorphicAllocator &a, const PolymorphicAllocator<U> &b) {
+            return a.resource()->is_equal(*b.resource());
+        }
+    };
+}
+
+#endif //MEMORY_RESOURCE_H
@@ -6,6 +6,10 @@
 #define MYSTRINGS_H
 
 #include "allocator.h"
+#include "bounds_check.h"
+#include "memory_resource.h"
+#include "string_view.h"
+#include "traits.h"
 
 namespace tinyWheels{
     class string {
@@ -25,15 +29,18 @@ namespace tinyWheels{
         char_point data_{nullptr};
         size_type size_{0};   // 包括了'\0'
         size_type capacity_{0};
+        memory_resource *resource_{nullptr};  // 内存来源，nullptr 表示直接使用 Allocator<char>
 
     private: // 定义函数
+        std::pair<char_point, size_type> allocate(size_type n) const;  // 从 resource_ 申请，返回地址与容量
+        void deallocate(char_point ptr, size_type n) const;
         void copy_from(const string& str);
         void move_from(string&& str) noexcept;
         static void move_forward(Iterator first, const Iterator last, Iterator dst);  // 向前移动
         static void move_back(const ReverseIterator &first, const ReverseIterator& last, const ReverseIterator& dst); // 向后移动
     public:
 
-        [[nodiscard]] size_type size() const {return size_ - 1 < 0 ? 0 : size_ - 1;}
+        [[nodiscard]] size_type size() const {return size_ == 0 ? 0 : size_ - 1;}
         [[nodiscard]] size_type length() const {return size();}
         [[nodiscard]] Iterator begin() const {return data_;}
         [[nodiscard]] Iterator end() const {return data_ + size();}
@@ -45,22 +52,31 @@ namespace tinyWheels{
         [[nodiscard]] ConsReverseIterator crend() const {return ConsReverseIterator(cbegin());}
 
 
+        // 拷贝构造沿用原字符串的内存来源；赋值时保持自己的内存来源，来源不同的移动赋值退化为拷贝
         ~string();
         string() = default;
+        explicit string(memory_resource *resource) : resource_(resource) {}
         string(const string&);
         string(string&&) noexcept;
-        string(char_type);
-        string(c_string);
-        string(size_type, char_type);
-        string(size_type, c_string);
+        string(char_type, memory_resource *resource = nullptr);
+        string(c_string, memory_resource *resource = nullptr);
+        string(size_type, char_type, memory_resource *resource = nullptr);
+        string(size_type, c_string, memory_resource *resource = nullptr);
+        explicit string(string_view, memory_resource *resource = nullptr);  // 复制视图中的字符
+
+        [[nodiscard]] memory_resource *resource() const {return resource_;}
 
         [[nodiscard]] c_string c_str() const {return data_;}
-        [[nodiscard]] char_type operator[](const size_type n) const {
-            if (n >= size_) {
-                throw tinyWheels::exception("超出范围, index: %lu, size: %lu", n, size_);
-            }
-            return data_[n];
-        }
+        // 不复制字符的视图，字符串修改或者扩容之后失效；比较运算符、查找都通过它实现
+        [[nodiscard]] string_view view() const {return {data_, size()};}
+        operator string_view() const {return view();}
+        // 从 pos 开始最多 n 个字符组成的新字符串，使用相同的内存来源；只需要读取时用 view().substr 避免复制
+        [[nodiscard]] string substr(size_type pos, size_type n = string_view::npos) const;
+        [[nodiscard]] size_type find(const char_type ch, const size_type pos = 0) const {return view().find(ch, pos);}
+        [[nodiscard]] size_type find(const string_view target, const size_type pos = 0) const {return view().find(target, pos);}
+        // operator[] 可以读到结尾的 '\0'，按 TINYWHEELS_BOUNDS_CHECK 检查（见 bounds_check.h）；at() 始终检查，只能读 size() 个字符
+        [[nodiscard]] char_type operator[](const size_type n) const {check_index(n, size_); return data_[n];}
+        [[nodiscard]] char_type at(const size_type n) const {check_at(n, size()); return data_[n];}
 
         void insert(Iterator it, const string& s);
         void insert(Iterator it, char_type);
@@ -74,6 +90,7 @@ namespace tinyWheels{
         string& operator+=(const string&);
         string& operator+=(char_type);
         string& operator+=(c_string);
+        string& operator+=(string_view);
         // template<class Number>
         // string& operator+=(Number);
 
@@ -85,13 +102,13 @@ namespace tinyWheels{
 
         friend string operator+(const string&, char_type);
         friend string operator+(char_type, const string&);
-        friend string operator+(string&&, char_type) noexcept;
-        friend string operator+(char_type, string&&) noexcept;
+        friend string operator+(string&&, char_type);
+        friend string operator+(char_type, string&&);
 
         friend string operator+(const string&, c_string);
         friend string operator+(c_string, const string&);
-        friend string operator+(string&&, c_string) noexcept;
-        friend string operator+(c_string, string&&) noexcept;
+        friend string operator+(string&&, c_string);
+        friend string operator+(c_string, string&&);
 
         friend bool operator==(const string &, const string &);
         friend bool operator==(const string &, c_string);
@@ -127,6 +144,10 @@ namespace tinyWheels{
         // friend string& operator+(string&&, Number) noexcept;
         void reserve(size_type);
     };
+
+    // string 只持有指向堆内存的指针，可以按字节搬移
+    template<>
+    struct is_trivially_relocatable<string> : std::true_type {};
 }
 
 #endif //MYSTRINGS_H
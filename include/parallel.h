@@ -0,0 +1,253 @@
+//
+// Created by 24983 on 25-3-17.
+//
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "ThreadPoll.h"
+#include "vector.h"
+
+namespace tinyWheels {
+    // 在 ThreadPoll 上的数据并行算法：parallel_for、parallel_reduce、parallel_transform、parallel_sort
+    // 调用线程自己也参与计算，并且阻塞到所有分块完成才返回，所以在线程池的任务中再调用也不会死锁；
+    // 分块中抛出的第一个异常在调用线程中重新抛出
+    namespace detail {
+        // 一次并行调用的共享状态；线程池中的任务可能在调用返回之后才开始执行，所以用 shared_ptr 管理，
+        // 那时 next_ 已经不小于 n_，任务什么也不做就退出，不会再访问 body_
+        template<class Body>
+        struct ParallelState {
+            Body *body_;
+            size_t n_;
+            size_t min_grain_;
+            size_t workers_;
+            std::atomic<size_t> next_{0};  // 下一个还没有被领取的下标
+            std::atomic<size_t> done_{0};  // 已经完成的元素个数，等于 n_ 时唤醒调用线程
+            std::mutex error_mutex_;
+            std::exception_ptr error_;
+
+            ParallelState(Body *body, const size_t n, const size_t min_grain, const size_t workers)
+                : body_(body), n_(n), min_grain_(min_grain), workers_(workers) {}
+
+            // 自适应分块：每次领取剩余元素的 1 / (2 * workers)，开始时块大，负载不均时越往后块越小，最小 min_grain
+            void work(const size_t worker) {
+                auto begin = next_.load(std::memory_order_relaxed);
+                while (begin < n_) {
+                    const auto size = std::max(min_grain_, (n_ - begin) / (2 * workers_));
+                    if (not next_.compare_exchange_weak(begin, begin + size, std::memory_order_relaxed)) {
+                        continue;  // begin 已经更新为最新值
+                    }
+                    const auto end = std::min(n_, begin + size);
+                    try {
+                        (*body_)(worker, begin, end);
+                    }catch (...) {
+                        std::lock_guard lock(error_mutex_);
+                        if (not error_) {
+                            error_ = std::current_exception();
+                        }
+                    }
+                    if (done_.fetch_add(end - begin, std::memory_order_acq_rel) + (end - begin) == n_) {
+                        done_.notify_all();
+                    }
+                    begin = next_.load(std::memory_order_relaxed);
+                }
+            }
+        };
+
+        // 参与计算的线程数：线程池中的线程加上调用线程
+        inline size_t parallel_workers(const ThreadPoll &pool) {
+            return pool.get_max_threads() + 1;
+        }
+
+        // 把 [0, n) 分块交给线程池与调用线程一起执行，body(worker, begin, end) 处理一块，worker 是 [0, workers) 中的编号；
+        // grain 为 0 时按 n 与线程数自动选择最小块
+        template<class Body>
+        void parallel_run(ThreadPoll &pool, const size_t n, const size_t grain, Body &&body) {
+            if (n == 0) {
+                return;
+            }
+            const auto workers = parallel_workers(pool);
+            const auto min_grain = grain != 0 ? grain : std::clamp<size_t>(n / (workers * 16), 1, 4096);
+            const auto helpers = std::min(workers - 1, (n - 1) / min_grain);  // 只有一块时不需要线程池
+            auto state = std::make_shared<ParallelState<std::remove_reference_t<Body>>>(&body, n, min_grain, helpers + 1);
+            for (size_t worker = 1; worker <= helpers; ++worker) {
+                pool.add_task([state, worker] {state->work(worker);});
+            }
+            state->work(0);
+            for (auto done = state->done_.load(std::memory_order_acquire); done < n; done = state->done_.load(std::memory_order_acquire)) {
+                state->done_.wait(done, std::memory_order_acquire);
+            }
+            if (state->error_) {
+                std::rethrow_exception(state->error_);
+            }
+        }
+
+        // 归并路径：合并 a[0, na) 与 b[0, nb) 时，输出的前 d 个元素中有多少个来自 a；相等时 a 在前，与 std::merge 相同
+        template<class Iterator, class Compare>
+        size_t merge_path(Iterator a, const size_t na, Iterator b, const size_t nb, const size_t d, Compare &comp) {
+            size_t low = d > nb ? d - nb : 0, high = std::min(d, na);
+            while (low < high) {
+                const auto middle = low + (high - low) / 2;
+                if (comp(b[d - middle - 1], a[middle])) {
+                    high = middle;
+                }else {
+                    low = middle + 1;
+                }
+            }
+            return low;
+        }
+    }
+
+    // 对 [first, last) 中的每个元素调用 function(element)；first、last 是整数时对每个下标调用 function(i)
+    template<class Iterator, class Function>
+    void parallel_for(ThreadPoll &pool, Iterator first, Iterator last, Function function, const size_t grain = 0) {
+        detail::parallel_run(pool, static_cast<size_t>(last - first), grain, [&](size_t, const size_t begin, const size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                if constexpr (std::is_integral_v<Iterator>) {
+                    function(static_cast<Iterator>(first + i));
+                }else {
+                    function(first[i]);
+                }
+            }
+        });
+    }
+
+    // 归约：op 需要满足结合律与交换律（与 std::reduce 相同），每个线程先归约自己领取的块，最后与 init 合并
+    template<class Iterator, class T, class BinaryOp = std::plus<>>
+    T parallel_reduce(ThreadPoll &pool, Iterator first, Iterator last, T init, BinaryOp op = BinaryOp(), const size_t grain = 0) {
+        // 每个线程的部分结果独占一个缓存行，避免伪共享
+        struct alignas(64) Partial {
+            std::optional<T> value;
+        };
+        vector<Partial> partials(detail::parallel_workers(pool));
+        detail::parallel_run(pool, static_cast<size_t>(last - first), grain, [&](const size_t worker, const size_t begin, const size_t end) {
+            auto &partial = partials[worker].value;
+            auto i = begin;
+            T value = partial ? std::move(*partial) : T(first[i++]);
+            for (; i < end; ++i) {
+                value = op(std::move(value), first[i]);
+            }
+            partial = std::move(value);
+        });
+        for (auto &partial : partials) {
+            if (partial.value) {
+                init = op(std::move(init), std::move(*partial.value));
+            }
+        }
+        return init;
+    }
+
+    // d_first[i] = function(first[i])，返回输出区间的末尾；输出区间可以就是输入区间
+    template<class Iterator, class OutputIterator, class Function>
+    OutputIterator parallel_transform(ThreadPoll &pool, Iterator first, Iterator last, OutputIterator d_first, Function function, const size_t grain = 0) {
+        const auto n = static_cast<size_t>(last - first);
+        detail::parallel_run(pool, n, grain, [&](size_t, const size_t begin, const size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                d_first[i] = function(first[i]);
+            }
+        });
+        return d_first + n;
+    }
+
+    // 并行归并排序，不稳定：先把区间分成若干块各自 std::sort，再逐轮两两归并，每一轮按归并路径把输出切成大小相同的片，
+    // 所有片并行合并，最后一轮也能用满所有线程。需要 n 个元素的临时 vector，元素要能默认构造与移动赋值
+    template<class Iterator, class Compare = std::less<>>
+    void parallel_sort(ThreadPoll &pool, Iterator first, Iterator last, Compare comp = Compare()) {
+        using T = std::remove_cvref_t<decltype(*first)>;
+        constexpr size_t MIN_BLOCK = 1 << 14;  // 小于这个长度的块不再切分
+        const auto n = static_cast<size_t>(last - first);
+        const auto workers = detail::parallel_workers(pool);
+        if (n <= MIN_BLOCK or workers == 1) {
+            std::sort(first, last, comp);
+            return;
+        }
+
+        size_t blocks = 1;
+        while (blocks < workers and n / (blocks * 2) >= MIN_BLOCK) {
+            blocks *= 2;
+        }
+        const auto width = (n + blocks - 1) / blocks;
+        detail::parallel_run(pool, blocks, 1, [&](size_t, const size_t begin, const size_t end) {
+            for (auto block = begin; block < end; ++block) {
+                std::sort(first + std::min(n, block * width), first + std::min(n, (block + 1) * width), comp);
+            }
+        });
+        if (blocks == 1) {
+            return;
+        }
+
+        vector<T> buffer(n);
+        const auto pieces = workers * 4;
+        vector<size_t> splits(pieces + 1);  // 每一片的起点在它所属的那对有序段中，有多少个输出来自前一段
+        bool in_buffer = false;  // 当前的有序段在 buffer 中还是在原区间中
+        for (auto run = width; run < n; run *= 2) {
+            auto merge_round = [&](auto from, auto to) {
+                // 分界点要在任何元素被移走之前全部算好，否则二分查找会读到相邻片已经移走的元素
+                parallel_for(pool, size_t(0), pieces + 1, [&](const size_t piece) {
+                    const auto position = n * piece / pieces;
+                    const auto pair = position / (2 * run) * (2 * run);
+                    const auto middle = std::min(n, pair + run), pair_end = std::min(n, pair + 2 * run);
+                    splits[piece] = detail::merge_path(from + pair, middle - pair, from + middle, pair_end - middle, position - pair, comp);
+                }, 1);
+                detail::parallel_run(pool, pieces, 1, [&](size_t, const size_t begin, const size_t end) {
+                    for (auto piece = begin; piece < end; ++piece) {
+                        // 这一片负责输出的 [position, stop)，可能跨过几对有序段，按对切开；
+                        // 除了片的两端，其他切点都在有序段对的边界上，不需要查找
+                        auto position = n * piece / pieces;
+                        const auto stop = n * (piece + 1) / pieces;
+                        while (position < stop) {
+                            const auto pair = position / (2 * run) * (2 * run);
+                            const auto middle = std::min(n, pair + run), pair_end = std::min(n, pair + 2 * run);
+                            const auto end_position = std::min(stop, pair_end);
+                            const auto a = from + pair, b = from + middle;
+                            const auto na = middle - pair;
+                            const auto d0 = position - pair, d1 = end_position - pair;
+                            const auto i0 = position == pair ? 0 : splits[piece];
+                            const auto i1 = end_position == pair_end ? na : splits[piece + 1];
+                            std::merge(std::make_move_iterator(a + i0), std::make_move_iterator(a + i1),
+                                       std::make_move_iterator(b + (d0 - i0)), std::make_move_iterator(b + (d1 - i1)),
+                                       to + position, comp);
+                            position = end_position;
+                        }
+                    }
+                });
+            };
+            if (in_buffer) {
+                merge_round(buffer.begin(), first);
+            }else {
+                merge_round(first, buffer.begin());
+            }
+            in_buffer = not in_buffer;
+        }
+        if (in_buffer) {
+            auto source = buffer.begin();
+            parallel_for(pool, size_t(0), n, [&](const size_t i) {first[i] = std::move(source[i]);});
+        }
+    }
+
+    // vector 的便捷版本
+    template<class T, class Alloc, class Function>
+    void parallel_for(ThreadPoll &pool, vector<T, Alloc> &v, Function function, const size_t grain = 0) {
+        parallel_for(pool, v.begin(), v.end(), std::move(function), grain);
+    }
+    template<class T, class Alloc, class U, class BinaryOp = std::plus<>>
+    U parallel_reduce(ThreadPoll &pool, const vector<T, Alloc> &v, U init, BinaryOp op = BinaryOp(), const size_t grain = 0) {
+        return parallel_reduce(pool, v.begin(), v.end(), std::move(init), std::move(op), grain);
+    }
+    template<class T, class Alloc, class Compare = std::less<>>
+    void parallel_sort(ThreadPoll &pool, vector<T, Alloc> &v, Compare comp = Compare()) {
+        parallel_sort(pool, v.begin(), v.end(), std::move(comp));
+    }
+}
+
+#endif //PARALLEL_H
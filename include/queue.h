@@ -6,25 +6,52 @@
 #define QUEUE_H
 #include "deque.h"
 namespace tinyWheels {
-    template<class T>
+    // 先进先出：从 deque 的尾部进、头部出，front() 是下一个出队的元素，back() 是最后入队的元素
+    template<class T, class Alloc = Allocator<T>>
     class queue {
-        using container = deque<T, DEQUE::FRONT_INPUT | DEQUE::BACK_OUTPUT>;
-        using Iterator = typename container::Iterator;
+        using container = deque<T, DEQUE::BACK_INPUT | DEQUE::FRONT_OUTPUT, Alloc>;
         container data;
     public:
+        queue() = default;
+        explicit queue(const Alloc& alloc) : data(alloc) {}
+
         void push(const T& value) {
-            data.push_front(value);
+            data.push_back(value);
+        }
+        void push(T&& value) {
+            data.push_back(std::move(value));
+        }
+        template<class... Args>
+        T& emplace(Args&&... args) {
+            return data.emplace_back(std::forward<Args>(args)...);
         }
-        void pop() {
-            data.pop_back();
+        bool pop() {
+            return data.pop_front();
         }
         T& front() {
             return data.front();
         }
+        const T& front() const {
+            return data.front();
+        }
         T& back() {
             return data.back();
         }
+        const T& back() const {
+            return data.back();
+        }
+
+        [[nodiscard]] size_t size() const {return data.size();}
+        [[nodiscard]] bool empty() const {return data.empty();}
 
+        // swap
+        // 成员 swap 会挡住友元 swap 的查找，所以成员函数中直接交换，友元转调成员
+        void swap(queue& another) noexcept {
+            data.swap(another.data);
+        }
+        friend void swap(queue& a, queue& b) noexcept {
+            a.swap(b);
+        }
     };
 }
 #endif //QUEUE_H
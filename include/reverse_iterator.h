@@ -10,6 +10,8 @@
 
 namespace tinyWheels{
     // 反向迭代器，用于连续存储的容器
+    // 与 ReverseDequeIterator 相同，保存它后面一个位置的迭代器，解引用时取前一个元素：rbegin() 是 end()，rend() 是 begin()
+    // 不会构造出第一个元素之前的指针，空容器的 nullptr 也不用做减法
     template<class Iterator>
     class ReverseIterator
     {
@@ -86,7 +88,8 @@ namespace tinyWheels{
         }
 
         reference operator*() { // *it
-            return *cur_;
+            auto tmp = cur_;
+            return *--tmp;
         }
         pointer operator->() { // it->member
             return &(operator*());
@@ -0,0 +1,65 @@
+//
+// Created by 24983 on 25-3-16.
+//
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace tinyWheels {
+    // 有向量化实现的元素类型：标准整数类型（不含 bool）以及 float、double
+    template<class T>
+    concept simd_arithmetic = std::is_same_v<T, char> or std::is_same_v<T, signed char> or std::is_same_v<T, unsigned char>
+                              or std::is_same_v<T, short> or std::is_same_v<T, unsigned short>
+                              or std::is_same_v<T, int> or std::is_same_v<T, unsigned int>
+                              or std::is_same_v<T, long> or std::is_same_v<T, unsigned long>
+                              or std::is_same_v<T, long long> or std::is_same_v<T, unsigned long long>
+                              or std::is_same_v<T, float> or std::is_same_v<T, double>;
+
+    // sum、dot 的结果类型：整数累加到同符号的 64 位整数（溢出时按 2^64 取模），浮点数以及其他类型累加到自身类型
+    template<class T>
+    using sum_type_t = std::conditional_t<not std::is_integral_v<T>, T,
+                                          std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+    // 连续内存上的向量化内核，定义在 src/Simd.cpp
+    // x86-64 上运行时检测 AVX2，可用时每次处理 32 字节，否则使用 SSE2 每次处理 16 字节；其他平台使用编译器的 16 字节向量
+    // 浮点数的 sum、dot 分成多路累加，相加的顺序与逐个累加不同，结果可能有舍入误差
+    namespace simd {
+        [[nodiscard]] bool avx2_supported();  // CPU 是否支持 AVX2
+        [[nodiscard]] bool avx2_enabled();    // 当前是否使用 AVX2 内核
+        // 关闭或者重新打开 AVX2 内核，用来对比两种宽度；CPU 不支持时打开也无效
+        void enable_avx2(bool enable);
+
+        // 第一个等于 value 的下标，没有时返回 n
+        template<simd_arithmetic T>
+        size_t find(const T *data, size_t n, T value);
+        template<simd_arithmetic T>
+        size_t count(const T *data, size_t n, T value);
+        // 最小值与最大值，n 必须大于 0；data[0] 是 NaN 时结果也是 NaN，其他位置的 NaN 被忽略
+        template<simd_arithmetic T>
+        T min(const T *data, size_t n);
+        template<simd_arithmetic T>
+        T max(const T *data, size_t n);
+        template<simd_arithmetic T>
+        std::pair<T, T> minmax(const T *data, size_t n);
+        template<simd_arithmetic T>
+        sum_type_t<T> sum(const T *data, size_t n);
+        template<simd_arithmetic T>
+        sum_type_t<T> dot(const T *a, const T *b, size_t n);
+
+        // 64 位字数组上的位运算，bit_vector、bitset 使用
+        enum class bit_op {AND, OR, XOR, ANDNOT};
+        // dst[i] = dst[i] op src[i]，ANDNOT 是 dst[i] & ~src[i]
+        void bitwise(bit_op op, uint64_t *dst, const uint64_t *src, size_t n);
+        // 所有字中 1 的个数；CPU 支持 POPCNT 时逐字使用 popcnt 指令，否则按向量做并行的位计数
+        size_t popcount(const uint64_t *words, size_t n);
+        // 第一个不为 0 的字的下标，没有时返回 n，稀疏的位图可以一次跳过很多字
+        size_t find_nonzero(const uint64_t *words, size_t n);
+    }
+}
+
+#endif //SIMD_H
@@ -0,0 +1,11 @@
+//
+// Created by 24983 on 25-3-15.
+//
+
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include "small_vector/small_vector.def.h"
+#include "small_vector/small_vector.impl.h"
+
+#endif //SMALL_VECTOR_H
@@ -0,0 +1,153 @@
+//
+// Created by 24983 on 25-3-15.
+//
+
+#ifndef SMALL_VECTOR_DEFINE_H
+#define SMALL_VECTOR_DEFINE_H
+
+#include <algorithm>
+#include <iosfwd>
+#include "allocator.h"
+#include "bounds_check.h"
+#include "memory_resource.h"
+#include "traits.h"
+#include "reverse_iterator.h"
+#include "span.h"
+
+namespace tinyWheels {
+    // 带内联存储的 vector：元素个数不超过 N 时放在对象内部的数组里，不申请内存；超过 N 时才向 Alloc 申请，之后与 vector 相同
+    // 接口与 vector 相同，可以直接替换连接对象中大多数时候只有几个元素的 vector
+    // data_ 可能指向自己的内联数组，所以不是平凡可重定位的，移动时内联的元素要逐个搬
+    template<class T, size_t N, class Alloc = Allocator<T>>
+    class small_vector {
+        static_assert(N > 0, "small_vector needs at least one inline element, use vector instead");
+    public:
+        using dataAllocator = Alloc;
+        using length_type = size_t;
+        constexpr static length_type INLINE_CAPACITY = N;
+    private:
+        T* data_{inline_data()};
+        length_type size_{0};
+        length_type capacity_{N};
+        [[no_unique_address]] Alloc alloc_;
+        alignas(T) unsigned char buffer_[N * sizeof(T)];  // 内联存储，不构造任何元素
+
+        T* inline_data() {return reinterpret_cast<T*>(buffer_);}
+        T* recapacity(length_type new_size, T* it);  // 扩容之后返回 it 对应的新位置
+        // 在 position 之前空出 n 个未构造的位置，返回扩容之后的 position，size_ 不变，由调用者构造之后再增加
+        T* open_gap(T* position, length_type n);
+        void release();  // 析构所有元素，堆上的内存还给分配器，回到内联存储
+    public:
+        using Iterator = T*;
+        using ConstIterator = const T*;
+        using reverseIterator = ReverseIterator<T*>;
+        using constReverseIterator = ReverseIterator<const T*>;
+
+        void resize(length_type s);
+
+        // 构造函数与析构函数
+        small_vector() = default;
+        explicit small_vector(const Alloc& alloc);
+        small_vector(const small_vector&);
+        small_vector(small_vector&&) noexcept;
+        explicit small_vector(length_type n, const Alloc& alloc = Alloc());
+        small_vector(length_type n, const T& value, const Alloc& alloc = Alloc());
+        small_vector(const std::initializer_list<T>& il, const Alloc& alloc = Alloc());
+        template<class InputIterator>
+        requires(not std::is_integral_v<InputIterator>)
+        small_vector(InputIterator first, InputIterator last, const Alloc& alloc = Alloc());
+        ~small_vector();
+
+        [[nodiscard]] Alloc get_allocator() const {return alloc_;}
+
+        small_vector& operator=(const small_vector&);
+        small_vector& operator=(small_vector&&) noexcept;
+        small_vector& operator=(const std::initializer_list<T>& il);
+
+        [[nodiscard]] length_type size() const {return size_;}
+        [[nodiscard]] length_type capacity() const {return capacity_;}
+        [[nodiscard]] bool empty() const {return size_ == 0;}
+        [[nodiscard]] bool is_inline() const {return data_ == reinterpret_cast<const T*>(buffer_);}  // 元素是否还在内联存储中
+
+        // 移动时元素在内联存储中就逐个搬过来，在堆上就直接接管指针
+        small_vector& move_from(small_vector&&) noexcept;
+        small_vector& copy_from(const small_vector&);
+
+        bool operator==(const small_vector&) const;
+        bool operator!=(const small_vector& another) const {return !(*this == another);}
+
+        void push_back(const T& value);
+        void push_back(T&& value);
+        template<class... Args>
+        void emplace_back(Args&&... args);
+        bool pop_back();
+
+        // 插入元素
+        template<class InputIterator>
+        void insert(InputIterator it, const T& value);
+        template<class InputIterator>
+        void insert(InputIterator it, T&& value);
+        template<class InputIterator>
+        void insert(InputIterator it, length_type n, const T& value);
+        template<class InputIterator, class InputIterator2>
+        requires(not std::is_integral_v<InputIterator2>)
+        void insert(InputIterator it, InputIterator2 first, InputIterator2 last);
+
+        // 删除元素
+        template<class InputIterator>
+        void erase(InputIterator it);
+        template<class InputIterator>
+        void erase(InputIterator first, InputIterator last);
+
+        // 获取元素：operator[] 按 TINYWHEELS_BOUNDS_CHECK 检查下标（见 bounds_check.h），at() 始终检查
+        T& operator[](const length_type index) {check_index(index, size_); return data_[index];}
+        const T& operator[](const length_type index) const {check_index(index, size_); return data_[index];}
+        T& at(const length_type index) {check_at(index, size_); return data_[index];}
+        const T& at(const length_type index) const {check_at(index, size_); return data_[index];}
+        T& back() {
+            return data_[size_ - 1];
+        }
+
+        Iterator begin() const {return data_;}
+        ConstIterator cbegin() const {return data_;}
+        Iterator end() const {return data_ + size_;}
+        ConstIterator cend() const {return data_ + size_;}
+        reverseIterator rbegin() const {return reverseIterator(end());}
+        constReverseIterator crbegin() const {return constReverseIterator(end());}
+        reverseIterator rend() const {return reverseIterator(begin());}
+        constReverseIterator crend() const {return constReverseIterator(begin());}
+        // 不复制元素的视图，扩容之后失效
+        span<T> as_span() {return span<T>(data_, size_);}
+        span<const T> as_span() const {return span<const T>(data_, size_);}
+
+        friend std::ostream& operator<<(std::ostream& os, const small_vector& vec) {
+            if constexpr (is_ostream_writable_v<T>) {
+                for (auto it = vec.begin(); it != vec.end(); ++it) {
+                    if (it != vec.begin()) os << ", ";
+                    os << *it;
+                }
+                os << " (" << vec.size_ << ")";
+            }else {
+                os << "small_vector<`" << typeid(T).name() << "`, " << N << ">" << " size: " << vec.size() << " capacity: " << vec.capacity_ << " data: " << vec.data_;
+            }
+            return os;
+        }
+        // 内联的元素不能交换指针，借助一个临时对象移动三次
+        friend void swap(small_vector& v1, small_vector& v2) noexcept {
+            small_vector tmp(std::move(v1));
+            v1.move_from(std::move(v2));
+            v2.move_from(std::move(tmp));
+        }
+        void swap(small_vector& v) noexcept {
+            tinyWheels::swap(*this, v);
+        }
+    };
+
+    // 使用 memory_resource 的 small_vector，超过 N 个元素之后从内存资源中申请
+    namespace pmr {
+        template<class T, size_t N>
+        using small_vector = tinyWheels::small_vector<T, N, PolymorphicAllocator<T>>;
+    }
+}
+
+#endif //SMALL_VECTOR_DEFINE_H
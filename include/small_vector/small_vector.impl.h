@@ -0,0 +1,259 @@
+//
+// Created by 24983 on 25-3-15.
+//
+
+#ifndef SMALL_VECTOR_IMPL_H
+#define SMALL_VECTOR_IMPL_H
+
+#include "small_vector.def.h"
+#include "algorithm.h"
+
+namespace tinyWheels {
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::release() {
+        dataAllocator::Destruct(data_, size_);
+        if (not is_inline()) {
+            alloc_.deallocate(data_, capacity_);  // 按容量释放，才能还给正确的大小类别
+        }
+        data_ = inline_data();
+        size_ = 0;
+        capacity_ = N;
+    }
+
+    template<class T, size_t N, class Alloc>
+    T *small_vector<T, N, Alloc>::recapacity(length_type new_size, T *it) {
+        if (new_size <= capacity_) {
+            return it;
+        }
+        new_size = new_size < 2 * capacity_ ? 2 * capacity_ : new_size;  // 至少翻倍，连续 push_back 均摊 O(1)
+        const auto difference = it - data_;
+        // 已经在堆上时与 vector 相同，平凡可重定位的类型交给分配器整体搬移
+        if constexpr (is_trivially_relocatable_v<T> and reallocatable_allocator<Alloc, T>) {
+            if (not is_inline()) {
+                if (auto [ptr, cap] = alloc_.reallocate(data_, capacity_, new_size); ptr != nullptr) {
+                    data_ = ptr;
+                    capacity_ = cap;
+                    return data_ + difference;
+                }
+            }
+        }
+        auto [ptr, cap] = alloc_.allocate(new_size);
+        relocate(data_, data_ + size_, ptr);
+        if (not is_inline()) {
+            alloc_.deallocate(data_, capacity_);
+        }
+        data_ = ptr;
+        capacity_ = cap;
+        return data_ + difference;
+    }
+
+    template<class T, size_t N, class Alloc>
+    T *small_vector<T, N, Alloc>::open_gap(T *position, const length_type n) {
+        position = recapacity(size_ + n, position);
+        relocate(position, end(), position + n);  // 把 [position, end()) 向后移动 n 个位置
+        return position;
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::resize(const length_type s) {
+        if (s < size_) {
+            dataAllocator::Destruct(data_ + s, size_ - s);
+        }else {
+            recapacity(s, data_);
+            dataAllocator::construct(data_ + size_, s - size_);
+        }
+        size_ = s;
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>::small_vector(const Alloc &alloc) : alloc_(alloc) {
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>::small_vector(const small_vector &vec) : alloc_(vec.alloc_) {
+        copy_from(vec);
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>::small_vector(small_vector &&vec) noexcept : alloc_(vec.alloc_) {
+        move_from(std::forward<small_vector>(vec));
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>::small_vector(const length_type n, const Alloc &alloc) : alloc_(alloc) {
+        resize(n);
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>::small_vector(const length_type n, const T &value, const Alloc &alloc) : alloc_(alloc) {
+        insert(data_, n, value);
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>::small_vector(const std::initializer_list<T> &il, const Alloc &alloc)
+        : small_vector(il.begin(), il.end(), alloc) {
+    }
+
+    template<class T, size_t N, class Alloc>
+    template<class InputIterator>
+    requires(not std::is_integral_v<InputIterator>)
+    small_vector<T, N, Alloc>::small_vector(InputIterator first, InputIterator last, const Alloc &alloc) : alloc_(alloc) {
+        insert(data_, first, last);
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>::~small_vector() {
+        release();
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc> &small_vector<T, N, Alloc>::operator=(const small_vector &vec) {
+        return copy_from(vec);
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc> &small_vector<T, N, Alloc>::operator=(small_vector &&vec) noexcept {
+        return move_from(std::forward<small_vector>(vec));
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc> &small_vector<T, N, Alloc>::operator=(const std::initializer_list<T> &il) {
+        release();
+        insert(data_, il.begin(), il.end());
+        return *this;
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc> &small_vector<T, N, Alloc>::move_from(small_vector &&vec) noexcept {
+        if (this == &vec) {
+            return *this;
+        }
+        release();
+        alloc_ = vec.alloc_;  // 堆上的内存由原来的分配器申请，必须一起带走
+        if (vec.is_inline()) {
+            // 内联时 size_ 不超过 N，写成 min 让编译器看到内联数组的边界，否则 -O2 会误报 -Warray-bounds
+            const auto n = std::min(vec.size_, N);
+            relocate(vec.inline_data(), vec.inline_data() + n, inline_data());
+        }else {
+            data_ = vec.data_;
+            capacity_ = vec.capacity_;
+            vec.data_ = vec.inline_data();
+            vec.capacity_ = N;
+        }
+        size_ = vec.size_;
+        vec.size_ = 0;
+        return *this;
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc> &small_vector<T, N, Alloc>::copy_from(const small_vector &vec) {
+        if (this != &vec) {
+            release();
+            recapacity(vec.size_, data_);
+            uninitialized_copy(vec.cbegin(), vec.cend(), data_);
+            size_ = vec.size_;
+        }
+        return *this;
+    }
+
+    template<class T, size_t N, class Alloc>
+    bool small_vector<T, N, Alloc>::operator==(const small_vector &vec) const {
+        if (this == &vec) {
+            return true;
+        }
+        if (size_ != vec.size_) {
+            return false;
+        }
+        for (length_type i = 0; i < size_; ++i) {
+            if (data_[i] != vec.data_[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::push_back(const T &value) {
+        insert(end(), value);
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::push_back(T &&value) {
+        insert(end(), std::move(value));
+    }
+
+    template<class T, size_t N, class Alloc>
+    template<class... Args>
+    void small_vector<T, N, Alloc>::emplace_back(Args &&... args) {
+        insert(end(), T(std::forward<Args>(args)...));
+    }
+
+    template<class T, size_t N, class Alloc>
+    bool small_vector<T, N, Alloc>::pop_back() {
+        if (size_ == 0) {
+            return false;
+        }
+        dataAllocator::Destruct(data_ + size_ - 1, 1);
+        --size_;
+        return true;
+    }
+
+    template<class T, size_t N, class Alloc>
+    template<class InputIterator>
+    void small_vector<T, N, Alloc>::insert(InputIterator it, const T &value) {
+        insert(it, 1, value);
+    }
+
+    template<class T, size_t N, class Alloc>
+    template<class InputIterator>
+    void small_vector<T, N, Alloc>::insert(InputIterator it, T &&value) {
+        if (&value >= data_ and &value < end()) {  // value 是自己的元素，扩容或者搬移之后就失效了，先移出来
+            T copy(std::move(value));
+            insert(it, std::move(copy));
+            return;
+        }
+        it = open_gap(it, 1);
+        new(it) T(std::move(value));
+        ++size_;
+    }
+
+    template<class T, size_t N, class Alloc>
+    template<class InputIterator>
+    void small_vector<T, N, Alloc>::insert(InputIterator it, const length_type n, const T &value) {
+        if (&value >= data_ and &value < end()) {  // value 是自己的元素，扩容或者搬移之后就失效了，先复制出来
+            const T copy(value);
+            insert(it, n, copy);
+            return;
+        }
+        it = open_gap(it, n);
+        dataAllocator::construct(it, n, value);
+        size_ += n;
+    }
+
+    template<class T, size_t N, class Alloc>
+    template<class InputIterator, class InputIterator2>
+    requires(not std::is_integral_v<InputIterator2>)
+    void small_vector<T, N, Alloc>::insert(InputIterator it, InputIterator2 first, InputIterator2 last) {
+        const length_type n = last - first;
+        it = open_gap(it, n);
+        uninitialized_copy(first, last, it);
+        size_ += n;
+    }
+
+    template<class T, size_t N, class Alloc>
+    template<class InputIterator>
+    void small_vector<T, N, Alloc>::erase(InputIterator it) {
+        erase(it, it + 1);
+    }
+
+    template<class T, size_t N, class Alloc>
+    template<class InputIterator>
+    void small_vector<T, N, Alloc>::erase(InputIterator first, InputIterator last) {
+        dataAllocator::Destruct(first, last - first);
+        relocate(last, end(), first);  // 后面的元素向前搬到空出来的位置
+        size_ -= last - first;
+    }
+}
+
+#endif //SMALL_VECTOR_IMPL_H
@@ -0,0 +1,11 @@
+//
+// Created by 24983 on 25-3-18.
+//
+
+#ifndef SOA_VECTOR_H
+#define SOA_VECTOR_H
+
+#include "soa_vector/soa_vector.def.h"
+#include "soa_vector/soa_vector.impl.h"
+
+#endif //SOA_VECTOR_H
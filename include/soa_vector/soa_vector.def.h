@@ -0,0 +1,186 @@
+//
+// Created by 24983 on 25-3-18.
+//
+
+#ifndef SOA_VECTOR_DEFINE_H
+#define SOA_VECTOR_DEFINE_H
+
+#include <algorithm>
+#include <compare>
+#include <tuple>
+#include <utility>
+#include "bounds_check.h"
+#include "span.h"
+#include "vector.h"
+
+namespace tinyWheels {
+    template<class... Fields>
+    class soa_vector;
+
+    // soa_vector 的一行：不保存元素，只保存容器与行号，get<I>() 返回第 I 列中这一行的引用
+    // 支持结构化绑定 auto [id, price] = soa[i]，绑定到的是各列中的引用
+    template<bool Const, class... Fields>
+    class soa_row {
+        using owner_type = std::conditional_t<Const, const soa_vector<Fields...>, soa_vector<Fields...>>;
+        owner_type* owner_;
+        size_t index_;
+    public:
+        using value_type = std::tuple<Fields...>;
+
+        soa_row(owner_type* owner, const size_t index) : owner_(owner), index_(index) {}
+        soa_row(const soa_row&) = default;
+        // 非 const 的行可以转换为 const 的行
+        template<bool OtherConst>
+        requires(Const and not OtherConst)
+        soa_row(const soa_row<OtherConst, Fields...>& row) : owner_(row.owner_), index_(row.index_) {}
+
+        template<size_t I>
+        decltype(auto) get() const {return owner_->template column<I>().data()[index_];}
+        [[nodiscard]] size_t index() const {return index_;}
+
+        // 复制出这一行的值
+        operator value_type() const {
+            return [this]<size_t... I>(std::index_sequence<I...>) {
+                return value_type(get<I>()...);
+            }(std::index_sequence_for<Fields...>{});
+        }
+        // 给这一行的每一列赋值，行代理本身不会被改成指向别的行
+        const soa_row& operator=(const value_type& value) const requires(not Const) {
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                ((get<I>() = std::get<I>(value)), ...);
+            }(std::index_sequence_for<Fields...>{});
+            return *this;
+        }
+        const soa_row& operator=(const soa_row& row) const requires(not Const) {
+            return *this = static_cast<value_type>(row);
+        }
+
+        bool operator==(const value_type& value) const {return static_cast<value_type>(*this) == value;}
+
+        template<bool, class...>
+        friend class soa_row;
+    };
+
+    // 行迭代器，解引用得到 soa_row
+    template<bool Const, class... Fields>
+    class soa_iterator {
+        using owner_type = std::conditional_t<Const, const soa_vector<Fields...>, soa_vector<Fields...>>;
+        owner_type* owner_{nullptr};
+        size_t index_{0};
+    public:
+        using value_type = std::tuple<Fields...>;
+        using reference = soa_row<Const, Fields...>;
+        using difference_type = ptrdiff_t;
+
+        soa_iterator() = default;
+        soa_iterator(owner_type* owner, const size_t index) : owner_(owner), index_(index) {}
+
+        reference operator*() const {return reference(owner_, index_);}
+        reference operator[](const difference_type n) const {return reference(owner_, index_ + n);}
+
+        soa_iterator& operator++() {++index_; return *this;}
+        soa_iterator operator++(int) {auto tmp = *this; ++index_; return tmp;}
+        soa_iterator& operator--() {--index_; return *this;}
+        soa_iterator operator--(int) {auto tmp = *this; --index_; return tmp;}
+        soa_iterator& operator+=(const difference_type n) {index_ += n; return *this;}
+        soa_iterator& operator-=(const difference_type n) {index_ -= n; return *this;}
+        soa_iterator operator+(const difference_type n) const {return soa_iterator(owner_, index_ + n);}
+        soa_iterator operator-(const difference_type n) const {return soa_iterator(owner_, index_ - n);}
+        difference_type operator-(const soa_iterator& it) const {return static_cast<difference_type>(index_) - static_cast<difference_type>(it.index_);}
+
+        bool operator==(const soa_iterator& it) const {return index_ == it.index_;}
+        auto operator<=>(const soa_iterator& it) const {return index_ <=> it.index_;}
+    };
+
+    // 列式存储的记录数组：每个字段放在自己的 vector 里，soa_vector<int, double, int> 有三个连续的数组
+    // 只扫描一两个字段时只读这几列，不会把整条记录读进缓存；column<I>() 返回第 I 列的 span，可以直接交给 sum、find 等向量化算法
+    // 按行访问时 operator[] 返回行代理 soa_row，所有列的长度始终相同
+    template<class... Fields>
+    class soa_vector {
+        static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one field");
+    public:
+        using length_type = size_t;
+        using value_type = std::tuple<Fields...>;
+        using reference = soa_row<false, Fields...>;
+        using const_reference = soa_row<true, Fields...>;
+        using Iterator = soa_iterator<false, Fields...>;
+        using ConstIterator = soa_iterator<true, Fields...>;
+        template<size_t I>
+        using field_type = std::tuple_element_t<I, value_type>;
+        constexpr static size_t FIELDS = sizeof...(Fields);
+    private:
+        std::tuple<vector<Fields>...> columns_;
+
+        void pop_columns(size_t columns);  // 撤销前 columns 列中最后一个元素，push_back 中途失败时保持各列等长
+    public:
+        soa_vector() = default;
+        explicit soa_vector(length_type n);  // n 行，每个字段值初始化
+        soa_vector(const std::initializer_list<value_type>& il);
+
+        [[nodiscard]] length_type size() const {return std::get<0>(columns_).size();}
+        [[nodiscard]] bool empty() const {return size() == 0;}
+        [[nodiscard]] length_type capacity() const;  // 所有列中最小的容量，不超过它追加不会申请内存
+
+        void resize(length_type n);
+        void clear() {resize(0);}
+
+        void push_back(const value_type& row);
+        template<class... Args>
+        requires(sizeof...(Args) == sizeof...(Fields))
+        void emplace_back(Args&&... args);  // 每个字段一个参数
+        bool pop_back();
+        void erase(length_type index);  // 删除一行，后面的行依次前移
+
+        // 按行访问，越界抛出异常
+        // operator[] 与 get 按 TINYWHEELS_BOUNDS_CHECK 检查，at() 始终检查
+        reference operator[](const length_type index) {check_index(index, size()); return reference(this, index);}
+        const_reference operator[](const length_type index) const {check_index(index, size()); return const_reference(this, index);}
+        reference at(const length_type index) {check_at(index, size()); return reference(this, index);}
+        const_reference at(const length_type index) const {check_at(index, size()); return const_reference(this, index);}
+        reference back() {return reference(this, size() - 1);}
+
+        // 第 I 列，长度与 size() 相同
+        template<size_t I>
+        span<field_type<I>> column() {return std::get<I>(columns_).as_span();}
+        template<size_t I>
+        span<const field_type<I>> column() const {return std::get<I>(columns_).as_span();}
+        template<size_t I>
+        field_type<I>& get(const length_type index) {check_index(index, size()); return column<I>().data()[index];}
+        template<size_t I>
+        const field_type<I>& get(const length_type index) const {check_index(index, size()); return column<I>().data()[index];}
+
+        Iterator begin() {return Iterator(this, 0);}
+        Iterator end() {return Iterator(this, size());}
+        ConstIterator begin() const {return ConstIterator(this, 0);}
+        ConstIterator end() const {return ConstIterator(this, size());}
+        ConstIterator cbegin() const {return ConstIterator(this, 0);}
+        ConstIterator cend() const {return ConstIterator(this, size());}
+
+        bool operator==(const soa_vector& another) const {return columns_ == another.columns_;}
+        bool operator!=(const soa_vector& another) const {return !(*this == another);}
+
+        friend void swap(soa_vector& v1, soa_vector& v2) noexcept {
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                (std::get<I>(v1.columns_).swap(std::get<I>(v2.columns_)), ...);
+            }(std::index_sequence_for<Fields...>{});
+        }
+        void swap(soa_vector& v) noexcept {
+            tinyWheels::swap(*this, v);
+        }
+    };
+
+    // 每一列都是 vector，整体也可以按字节搬移
+    template<class... Fields>
+    struct is_trivially_relocatable<soa_vector<Fields...>> : std::true_type {};
+}
+
+// 行代理的结构化绑定
+template<bool Const, class... Fields>
+struct std::tuple_size<tinyWheels::soa_row<Const, Fields...>> : std::integral_constant<size_t, sizeof...(Fields)> {};
+
+template<size_t I, bool Const, class... Fields>
+struct std::tuple_element<I, tinyWheels::soa_row<Const, Fields...>> {
+    using type = std::conditional_t<Const, const std::tuple_element_t<I, std::tuple<Fields...>>&, std::tuple_element_t<I, std::tuple<Fields...>>&>;
+};
+
+#endif //SOA_VECTOR_DEFINE_H
@@ -0,0 +1,77 @@
+//
+// Created by 24983 on 25-3-18.
+//
+
+#ifndef SOA_VECTOR_IMPL_H
+#define SOA_VECTOR_IMPL_H
+
+#include "soa_vector.def.h"
+
+namespace tinyWheels {
+
+    template<class... Fields>
+    void soa_vector<Fields...>::pop_columns(const size_t columns) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            ((I < columns ? (void)std::get<I>(columns_).pop_back() : void()), ...);
+        }(std::index_sequence_for<Fields...>{});
+    }
+
+    template<class... Fields>
+    soa_vector<Fields...>::soa_vector(const length_type n) {
+        resize(n);
+    }
+
+    template<class... Fields>
+    soa_vector<Fields...>::soa_vector(const std::initializer_list<value_type> &il) {
+        for (const auto &row : il) {
+            push_back(row);
+        }
+    }
+
+    template<class... Fields>
+    typename soa_vector<Fields...>::length_type soa_vector<Fields...>::capacity() const {
+        return std::apply([](const auto &... c) {return std::min({c.capacity()...});}, columns_);
+    }
+
+    template<class... Fields>
+    void soa_vector<Fields...>::resize(const length_type n) {
+        std::apply([n](auto &... c) {(c.resize(n), ...);}, columns_);
+    }
+
+    template<class... Fields>
+    void soa_vector<Fields...>::push_back(const value_type &row) {
+        std::apply([this](const auto &... fields) {emplace_back(fields...);}, row);
+    }
+
+    template<class... Fields>
+    template<class... Args>
+    requires(sizeof...(Args) == sizeof...(Fields))
+    void soa_vector<Fields...>::emplace_back(Args &&... args) {
+        size_t pushed = 0;
+        try {
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                ((std::get<I>(columns_).emplace_back(std::forward<Args>(args)), ++pushed), ...);
+            }(std::index_sequence_for<Fields...>{});
+        }catch (...) {
+            pop_columns(pushed);  // 已经追加的列撤销，各列仍然等长
+            throw;
+        }
+    }
+
+    template<class... Fields>
+    bool soa_vector<Fields...>::pop_back() {
+        if (empty()) {
+            return false;
+        }
+        pop_columns(FIELDS);
+        return true;
+    }
+
+    template<class... Fields>
+    void soa_vector<Fields...>::erase(const length_type index) {
+        check_at(index, size());
+        std::apply([index](auto &... c) {(c.erase(c.begin() + index), ...);}, columns_);
+    }
+}
+
+#endif //SOA_VECTOR_IMPL_H
@@ -0,0 +1,91 @@
+//
+// Created by 24983 on 25-3-21.
+//
+
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <concepts>
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <type_traits>
+#include "bounds_check.h"
+#include "exception.h"
+#include "traits.h"
+
+namespace tinyWheels {
+    // 连续元素的视图：只保存指针与长度，不拥有元素，复制、切片都是 O(1)
+    // 迭代器就是指针，交给 algorithm.h 的 find、sum 等算法时直接走向量化内核
+    // 元素的生命周期由原来的容器负责，容器扩容之后视图失效
+    template<class T>
+    class span {
+        T *data_{nullptr};
+        size_t size_{0};
+    public:
+        using element_type = T;
+        using value_type = std::remove_cv_t<T>;
+        using length_type = size_t;
+        using Iterator = T*;
+        constexpr static size_t npos = static_cast<size_t>(-1);
+
+        constexpr span() = default;
+        constexpr span(T *data, const size_t size) : data_(data), size_(size) {}
+        constexpr span(T *first, T *last) : data_(first), size_(last - first) {}
+        template<size_t N>
+        constexpr span(T (&array)[N]) : data_(array), size_(N) {}
+        // 任何 begin() 返回指针、有 size() 的连续容器：vector、small_vector、mapped_vector、std::vector 用 data()
+        template<class Container>
+        requires(not std::is_same_v<std::remove_cvref_t<Container>, span>
+                 and requires(Container &c) {{std::to_address(c.begin())} -> std::convertible_to<T *>; c.size();})
+        constexpr span(Container &c) : data_(std::to_address(c.begin())), size_(c.size()) {}
+        // span<T> 可以转换为 span<const T>
+        template<class U>
+        requires(std::is_convertible_v<U (*)[], T (*)[]>)
+        constexpr span(const span<U> &another) : data_(another.data()), size_(another.size()) {}
+
+        [[nodiscard]] constexpr T *data() const {return data_;}
+        [[nodiscard]] constexpr size_t size() const {return size_;}
+        [[nodiscard]] constexpr size_t size_bytes() const {return size_ * sizeof(T);}
+        [[nodiscard]] constexpr bool empty() const {return size_ == 0;}
+
+        // operator[] 按 TINYWHEELS_BOUNDS_CHECK 检查，at() 始终检查
+        T &operator[](const size_t index) const {check_index(index, size_); return data_[index];}
+        T &at(const size_t index) const {check_at(index, size_); return data_[index];}
+        T &front() const {return data_[0];}
+        T &back() const {return data_[size_ - 1];}
+
+        constexpr Iterator begin() const {return data_;}
+        constexpr Iterator end() const {return data_ + size_;}
+
+        // 从 offset 开始最多 count 个元素，offset 超过长度时抛出异常
+        span subspan(const size_t offset, const size_t count = npos) const {
+            if (offset > size_) {
+                throw exception("Out of range, offset: %lu, size: %lu", offset, size_);
+            }
+            return span(data_ + offset, count < size_ - offset ? count : size_ - offset);
+        }
+        span first(const size_t count) const {return subspan(0, count);}
+        span last(const size_t count) const {return subspan(count < size_ ? size_ - count : 0);}
+
+        // 按字节查看
+        span<const unsigned char> as_bytes() const {
+            return span<const unsigned char>(reinterpret_cast<const unsigned char *>(data_), size_bytes());
+        }
+
+        friend std::ostream &operator<<(std::ostream &os, const span &s) requires is_ostream_writable_v<T> {
+            for (size_t i = 0; i < s.size_; ++i) {
+                if (i != 0) os << ", ";
+                os << s.data_[i];
+            }
+            return os;
+        }
+    };
+
+    template<class T, size_t N>
+    span(T (&)[N]) -> span<T>;
+    template<class Container>
+    span(Container &) -> span<std::remove_reference_t<decltype(*std::declval<Container &>().begin())>>;
+}
+
+#endif //SPAN_H
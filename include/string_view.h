@@ -0,0 +1,81 @@
+//
+// Created by 24983 on 25-3-21.
+//
+
+#ifndef STRING_VIEW_H
+#define STRING_VIEW_H
+
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <iosfwd>
+#include "bounds_check.h"
+#include "exception.h"
+
+namespace tinyWheels {
+    // 只读的字符序列视图：只保存指针与长度，不拥有字符，也不要求以 '\0' 结尾
+    // substr、remove_prefix 都是 O(1)，解析协议时可以直接在收到的缓冲区上切片，不需要申请内存
+    // 字符的生命周期由原来的 string 或缓冲区负责
+    class string_view {
+        const char *data_{nullptr};
+        size_t size_{0};
+    public:
+        using length_type = size_t;
+        using Iterator = const char*;
+        constexpr static size_t npos = static_cast<size_t>(-1);
+
+        constexpr string_view() = default;
+        constexpr string_view(const char *data, const size_t size) : data_(data), size_(size) {}
+        string_view(const char *c_str) : data_(c_str), size_(c_str == nullptr ? 0 : strlen(c_str)) {}
+
+        [[nodiscard]] constexpr const char *data() const {return data_;}
+        [[nodiscard]] constexpr size_t size() const {return size_;}
+        [[nodiscard]] constexpr size_t length() const {return size_;}
+        [[nodiscard]] constexpr bool empty() const {return size_ == 0;}
+
+        // operator[] 按 TINYWHEELS_BOUNDS_CHECK 检查，at() 始终检查
+        char operator[](const size_t index) const {check_index(index, size_); return data_[index];}
+        [[nodiscard]] char at(const size_t index) const {check_at(index, size_); return data_[index];}
+        [[nodiscard]] char front() const {return data_[0];}
+        [[nodiscard]] char back() const {return data_[size_ - 1];}
+
+        constexpr Iterator begin() const {return data_;}
+        constexpr Iterator end() const {return data_ + size_;}
+
+        // 从 pos 开始最多 n 个字符，pos 超过长度时抛出异常
+        [[nodiscard]] string_view substr(size_t pos, size_t n = npos) const;
+        // 去掉前面、后面 n 个字符，n 超过长度时抛出异常
+        void remove_prefix(size_t n);
+        void remove_suffix(size_t n);
+
+        [[nodiscard]] bool starts_with(const string_view prefix) const {
+            return size_ >= prefix.size_ and (prefix.size_ == 0 or memcmp(data_, prefix.data_, prefix.size_) == 0);
+        }
+        [[nodiscard]] bool starts_with(const char ch) const {return size_ != 0 and data_[0] == ch;}
+        [[nodiscard]] bool ends_with(const string_view suffix) const {
+            return size_ >= suffix.size_ and (suffix.size_ == 0 or memcmp(data_ + size_ - suffix.size_, suffix.data_, suffix.size_) == 0);
+        }
+        [[nodiscard]] bool ends_with(const char ch) const {return size_ != 0 and data_[size_ - 1] == ch;}
+
+        // 从 pos 开始查找，找不到时返回 npos；单个字符交给 simd.h 的向量化内核，子串先找首字符再比较
+        [[nodiscard]] size_t find(char ch, size_t pos = 0) const;
+        [[nodiscard]] size_t find(string_view target, size_t pos = 0) const;
+        // 从 pos 往前查找最后一次出现的位置
+        [[nodiscard]] size_t rfind(char ch, size_t pos = npos) const;
+        [[nodiscard]] bool contains(const char ch) const {return find(ch) != npos;}
+        [[nodiscard]] bool contains(const string_view target) const {return find(target) != npos;}
+
+        // 按无符号字节的字典序比较，返回负数、0、正数
+        [[nodiscard]] int compare(string_view another) const;
+
+        friend bool operator==(const string_view a, const string_view b) {
+            return a.size_ == b.size_ and (a.size_ == 0 or memcmp(a.data_, b.data_, a.size_) == 0);
+        }
+        friend std::strong_ordering operator<=>(const string_view a, const string_view b) {
+            return a.compare(b) <=> 0;
+        }
+        friend std::ostream &operator<<(std::ostream &os, string_view sv);
+    };
+}
+
+#endif //STRING_VIEW_H
@@ -18,6 +18,26 @@ namespace tinyWheels{
     template <typename T>
     constexpr bool is_ostream_writable_v = is_ostream_writable<T>::value;  // 判断是否可以使用 std::ostream << 输出
 
+    // 平凡可重定位：对象可以按字节搬到新的地址，旧地址上的对象不需要再析构，容器扩容时可以整体 mremap / memcpy
+    // 默认等于平凡可复制；没有指向自身的指针的类型（例如只持有一个堆指针的 string、vector）可以特化为 true_type
+    template <typename T>
+    struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+    template <typename T>
+    constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+    // 分配器是否提供 allocate_bulk(ptrs, number) 与 deallocate_bulk(ptrs, number)
+    template <typename Alloc, typename T>
+    concept bulk_allocator = requires(Alloc alloc, T **ptrs, size_t number) {
+        {alloc.allocate_bulk(ptrs, number)};
+        {alloc.deallocate_bulk(ptrs, number)};
+    };
+
+    // 分配器是否提供 reallocate(ptr, number, new_number)
+    template <typename Alloc, typename T>
+    concept reallocatable_allocator = requires(Alloc alloc, T *ptr, size_t number) {
+        {alloc.reallocate(ptr, number, number)};
+    };
+
 }
 
 #endif //TRAITS_H
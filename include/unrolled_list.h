@@ -0,0 +1,11 @@
+//
+// Created by 24983 on 25-3-24.
+//
+
+#ifndef UNROLLED_LIST_H
+#define UNROLLED_LIST_H
+
+#include "unrolled_list/unrolled_list.def.h"
+#include "unrolled_list/unrolled_list.impl.h"
+
+#endif //UNROLLED_LIST_H
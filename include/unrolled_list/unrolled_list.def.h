@@ -0,0 +1,436 @@
+//
+// Created by 24983 on 25-3-24.
+//
+
+#ifndef UNROLLED_LIST_DEF_H
+#define UNROLLED_LIST_DEF_H
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+
+#include "allocator.h"
+#include "bounds_check.h"
+#include "iterator.h"
+#include "memory_resource.h"
+#include "span.h"
+#include "traits.h"
+#include "utility.h"
+
+namespace tinyWheels {
+
+    namespace mzUnrolledList {
+        template <class Node, class T> class UnrolledListIterator;
+        template <class Node, class T> class ReverseUnrolledListIterator;
+
+        // 默认每个节点约 256 字节（4 条缓存行），大元素至少放 4 个
+        template <class T>
+        constexpr size_t default_node_elements() {
+            constexpr size_t bytes = 256 - 3 * sizeof(void*);
+            return sizeof(T) * 4 > bytes ? 4 : bytes / sizeof(T);
+        }
+
+        // 节点中的元素放在未初始化的数组里，[0, count_) 已经构造，节点本身不构造也不析构元素
+        template <class T, size_t K>
+        class UnrolledListNode {
+            UnrolledListNode* prev_ = nullptr;
+            UnrolledListNode* next_ = nullptr;
+            size_t count_ = 0;
+            alignas(T) unsigned char buffer_[K * sizeof(T)];
+        public:
+            UnrolledListNode(UnrolledListNode* prev, UnrolledListNode* next) : prev_(prev), next_(next) {}
+            T* data() {return reinterpret_cast<T*>(buffer_);}
+            const T* data() const {return reinterpret_cast<const T*>(buffer_);}
+            [[nodiscard]] size_t count() const {return count_;}
+            void count(const size_t count) {count_ = count;}
+            UnrolledListNode* prev() const {return prev_;}
+            UnrolledListNode* next() const {return next_;}
+            void prev(UnrolledListNode* p) {prev_ = p;}
+            void next(UnrolledListNode* n) {next_ = n;}
+        };
+
+        // 迭代器是 (节点, 下标)；end() 是最后一个节点的 (tail, count)，空链表是 (nullptr, 0)
+        // 走到一个节点的末尾时立即跳到下一个节点的开头，所以同一个位置只有一种表示
+        template <class Node, class T>
+        class UnrolledListIterator {
+            template <class, class> friend class UnrolledListIterator;
+        public:
+            using iterator_category = bidirectional_iterator_tag;
+            using value_type = std::remove_cv_t<T>;
+            using difference_type = ptrdiff_t;
+            using pointer = T*;
+            using reference = T&;
+        private:
+            Node* node_ = nullptr;
+            size_t index_ = 0;
+        public:
+            UnrolledListIterator() = default;
+            UnrolledListIterator(Node* node, const size_t index) : node_(node), index_(index) {}
+            // Iterator 可以转换为 ConstIterator
+            template <class N, class U>
+            requires(std::is_convertible_v<N*, Node*> and not std::is_same_v<N, Node>)
+            UnrolledListIterator(const UnrolledListIterator<N, U>& it) : node_(it.node_), index_(it.index_) {}
+
+            [[nodiscard]] Node* node() const {return node_;}
+            [[nodiscard]] size_t index() const {return index_;}
+
+            reference operator*() const {return node_->data()[index_];}
+            pointer operator->() const {return &operator*();}
+
+            UnrolledListIterator& operator++() {
+                if (++index_ == node_->count() and node_->next() != nullptr) {
+                    node_ = node_->next();
+                    index_ = 0;
+                }
+                return *this;
+            }
+            UnrolledListIterator operator++(int) {
+                auto tmp = *this;
+                ++(*this);
+                return tmp;
+            }
+            UnrolledListIterator& operator--() {
+                if (index_ == 0) {
+                    node_ = node_->prev();
+                    index_ = node_->count();
+                }
+                --index_;
+                return *this;
+            }
+            UnrolledListIterator operator--(int) {
+                auto tmp = *this;
+                --(*this);
+                return tmp;
+            }
+
+            // 整个节点一次跳过，复杂度是 O(n / K)
+            UnrolledListIterator& operator+=(difference_type n) {
+                if (n == 0) {
+                    return *this;  // 空链表的 begin() 没有节点
+                }
+                if (n < 0) {
+                    return *this -= -n;
+                }
+                auto step = static_cast<size_t>(n);
+                while (index_ + step >= node_->count() and node_->next() != nullptr) {
+                    step -= node_->count() - index_;
+                    node_ = node_->next();
+                    index_ = 0;
+                }
+                index_ += step;
+                return *this;
+            }
+            UnrolledListIterator& operator-=(difference_type n) {
+                if (n < 0) {
+                    return *this += -n;
+                }
+                auto step = static_cast<size_t>(n);
+                while (step > index_) {
+                    step -= index_ + 1;
+                    node_ = node_->prev();
+                    index_ = node_->count() - 1;
+                }
+                index_ -= step;
+                return *this;
+            }
+            friend UnrolledListIterator operator+(const UnrolledListIterator& it, const difference_type n) {
+                auto tmp = it;
+                tmp += n;
+                return tmp;
+            }
+            friend UnrolledListIterator operator+(const difference_type n, const UnrolledListIterator& it) {
+                return it + n;
+            }
+            UnrolledListIterator operator-(const difference_type n) const {
+                auto tmp = *this;
+                tmp -= n;
+                return tmp;
+            }
+            // *this - another：先从 another 向后找 *this，找不到再反过来，按节点累加元素个数，复杂度是 O(距离 / K)
+            difference_type operator-(const UnrolledListIterator& another) const {
+                difference_type n = 0;
+                if (forward_distance(another, *this, n)) return n;
+                if (forward_distance(*this, another, n)) return -n;
+                return 0;  // 不在同一个链表中
+            }
+            // to 在 from 之后（或相同）时写入距离并返回 true
+            static bool forward_distance(const UnrolledListIterator& from, const UnrolledListIterator& to, difference_type& n) {
+                n = 0;
+                for (auto cur = from.node_; cur != nullptr; cur = cur->next()) {
+                    if (cur == to.node_) {
+                        n += static_cast<difference_type>(to.index_) - static_cast<difference_type>(cur == from.node_ ? from.index_ : 0);
+                        return n >= 0;
+                    }
+                    n += static_cast<difference_type>(cur->count() - (cur == from.node_ ? from.index_ : 0));
+                }
+                return false;
+            }
+
+            bool operator==(const UnrolledListIterator& another) const {
+                return node_ == another.node_ and index_ == another.index_;
+            }
+            bool operator!=(const UnrolledListIterator& another) const {
+                return !(*this == another);
+            }
+            bool operator<(const UnrolledListIterator& another) const {
+                return another - *this > 0;
+            }
+            bool operator>(const UnrolledListIterator& another) const {
+                return another < *this;
+            }
+            bool operator<=(const UnrolledListIterator& another) const {
+                return !(*this > another);
+            }
+            bool operator>=(const UnrolledListIterator& another) const {
+                return !(*this < another);
+            }
+            friend void swap(UnrolledListIterator& a, UnrolledListIterator& b) noexcept {
+                a.swap(b);
+            }
+            void swap(UnrolledListIterator& a) noexcept {
+                tinyWheels::swap(node_, a.node_);
+                tinyWheels::swap(index_, a.index_);
+            }
+        };
+
+        // 与 UnrolledListIterator 相同，只是向前走；rend() 是第一个节点的 (head, -1)
+        template <class Node, class T>
+        class ReverseUnrolledListIterator {
+        public:
+            using iterator_category = bidirectional_iterator_tag;
+            using value_type = std::remove_cv_t<T>;
+            using difference_type = ptrdiff_t;
+            using pointer = T*;
+            using reference = T&;
+        private:
+            Node* node_ = nullptr;
+            difference_type index_ = -1;
+        public:
+            ReverseUnrolledListIterator() = default;
+            ReverseUnrolledListIterator(Node* node, const difference_type index) : node_(node), index_(index) {}
+
+            reference operator*() const {return node_->data()[index_];}
+            pointer operator->() const {return &operator*();}
+
+            ReverseUnrolledListIterator& operator++() {
+                if (--index_ < 0 and node_->prev() != nullptr) {
+                    node_ = node_->prev();
+                    index_ = static_cast<difference_type>(node_->count()) - 1;
+                }
+                return *this;
+            }
+            ReverseUnrolledListIterator operator++(int) {
+                auto tmp = *this;
+                ++(*this);
+                return tmp;
+            }
+            ReverseUnrolledListIterator& operator--() {
+                if (++index_ == static_cast<difference_type>(node_->count())) {
+                    node_ = node_->next();
+                    index_ = 0;
+                }
+                return *this;
+            }
+            ReverseUnrolledListIterator operator--(int) {
+                auto tmp = *this;
+                --(*this);
+                return tmp;
+            }
+
+            bool operator==(const ReverseUnrolledListIterator& another) const {
+                return node_ == another.node_ and index_ == another.index_;
+            }
+            bool operator!=(const ReverseUnrolledListIterator& another) const {
+                return !(*this == another);
+            }
+            friend void swap(ReverseUnrolledListIterator& a, ReverseUnrolledListIterator& b) noexcept {
+                a.swap(b);
+            }
+            void swap(ReverseUnrolledListIterator& a) noexcept {
+                tinyWheels::swap(node_, a.node_);
+                tinyWheels::swap(index_, a.index_);
+            }
+        };
+    }
+
+    // 展开的链表：每个节点保存最多 K 个元素的数组，节点之间双向链接
+    // list<int> 每个元素要带两个指针，并且每个元素一次缓存未命中；这里每 K 个元素才有一组指针，遍历节点内部就是遍历数组
+    // 插入、删除只在一个节点内移动元素（O(K)），节点满了就对半拆开，删除之后与相邻节点放得下就合并
+    // 插入与删除只让所在节点（以及被拆开、合并的相邻节点）中的迭代器失效，其他节点中的迭代器与引用保持有效
+    // 元素在节点内、节点之间移动时使用移动构造，所以要求 T 的移动构造不抛出异常
+    template <class T, size_t K = mzUnrolledList::default_node_elements<T>(), class Alloc = Allocator<T>>
+    class unrolled_list {
+        static_assert(K >= 2, "unrolled_list needs at least two elements per node");
+        static_assert(std::is_nothrow_move_constructible_v<T>, "unrolled_list requires nothrow move construction");
+
+        using node = mzUnrolledList::UnrolledListNode<T, K>;
+        using node_point = node*;
+        using nodeAllocator = typename Alloc::template rebind<node>::other;
+        using length_type = size_t;
+    public:
+        using data_type = T;
+        using allocator_type = Alloc;
+        using Iterator = mzUnrolledList::UnrolledListIterator<node, T>;
+        using ConstIterator = mzUnrolledList::UnrolledListIterator<const node, const T>;
+        using ReverseIterator = mzUnrolledList::ReverseUnrolledListIterator<node, T>;
+        using ConstReverseIterator = mzUnrolledList::ReverseUnrolledListIterator<const node, const T>;
+        constexpr static length_type NODE_ELEMENTS = K;
+
+    private:
+        node_point head_{nullptr};
+        node_point tail_{nullptr};
+        length_type size_{0};
+        length_type nodes_{0};
+        [[no_unique_address]] nodeAllocator alloc_;
+
+        // 申请一个空节点，链接在 prev 与 next 之间，prev 或 next 为 nullptr 时更新 head_、tail_
+        node_point create_node(node_point prev, node_point next);
+        // 节点中的元素已经析构或移走，摘下并释放
+        void destroy_node(node_point n);
+        // 把 [at, count) 移到紧跟在 n 后面的新节点中，返回新节点
+        node_point split(node_point n, length_type at);
+        // 把 from 中的元素全部移到 to 的末尾，释放 from
+        void absorb(node_point to, node_point from);
+        // 在 n 的 index 位置腾出一个未构造的位置
+        static void open_slot(node_point n, length_type index);
+        // 删除之后节点过空时与相邻节点合并，返回 (n, index) 对应的新位置
+        Iterator rebalance(node_point n, length_type index);
+        void check_same_allocator(const unrolled_list& another) const;
+
+        unrolled_list& copy_from(const unrolled_list& another);
+
+    public:
+        unrolled_list() = default;
+        explicit unrolled_list(const Alloc& alloc) : alloc_(alloc) {}
+        unrolled_list(const unrolled_list& another);
+        unrolled_list(unrolled_list&& another) noexcept;
+        explicit unrolled_list(length_type n, const Alloc& alloc = Alloc());
+        unrolled_list(length_type n, const T& value, const Alloc& alloc = Alloc());
+        template<class InputIterator>
+        requires(not std::is_integral_v<InputIterator>)
+        unrolled_list(InputIterator first, InputIterator last, const Alloc& alloc = Alloc());
+        unrolled_list(const std::initializer_list<T>& il, const Alloc& alloc = Alloc());
+        ~unrolled_list();
+
+        [[nodiscard]] Alloc get_allocator() const {return Alloc(alloc_);}
+
+        unrolled_list& operator=(const unrolled_list& another);
+        unrolled_list& operator=(unrolled_list&& another) noexcept;
+        unrolled_list& operator=(const std::initializer_list<T>& il);
+
+        bool operator==(const unrolled_list& another) const;
+        bool operator!=(const unrolled_list& another) const {return !(*this == another);}
+
+        // 迭代器相关；push_back 会让 end() 失效，因为 end() 就是最后一个节点的末尾
+        Iterator begin() const {return Iterator(head_, 0);}
+        Iterator end() const {return Iterator(tail_, tail_ == nullptr ? 0 : tail_->count());}
+        ConstIterator cbegin() const {return ConstIterator(head_, 0);}
+        ConstIterator cend() const {return ConstIterator(tail_, tail_ == nullptr ? 0 : tail_->count());}
+        ReverseIterator rbegin() const {
+            return ReverseIterator(tail_, tail_ == nullptr ? -1 : static_cast<ptrdiff_t>(tail_->count()) - 1);
+        }
+        ReverseIterator rend() const {return ReverseIterator(head_, -1);}
+        ConstReverseIterator crbegin() const {
+            return ConstReverseIterator(tail_, tail_ == nullptr ? -1 : static_cast<ptrdiff_t>(tail_->count()) - 1);
+        }
+        ConstReverseIterator crend() const {return ConstReverseIterator(head_, -1);}
+
+        // 按节点依次交给 f 一段连续的元素，f 内部就是对数组的循环，可以向量化，扫描的速度接近 vector
+        template<class Function>
+        void for_each_segment(Function&& f) {
+            for (auto cur = head_; cur != nullptr; cur = cur->next()) {
+                f(span<T>(cur->data(), cur->count()));
+            }
+        }
+        template<class Function>
+        void for_each_segment(Function&& f) const {
+            for (auto cur = head_; cur != nullptr; cur = cur->next()) {
+                f(span<const T>(cur->data(), cur->count()));
+            }
+        }
+
+        // 获取大小
+        [[nodiscard]] length_type size() const {return size_;}
+        [[nodiscard]] bool empty() const {return size_ == 0;}
+        [[nodiscard]] length_type node_count() const {return nodes_;}
+
+        // 获取元素：按节点跳过，从离 index 较近的一端开始，复杂度是 O(n / K)
+        // operator[] 按 TINYWHEELS_BOUNDS_CHECK 检查下标，at() 始终检查
+        T& operator[](length_type index) {check_index(index, size_); return *locate(index);}
+        const T& operator[](length_type index) const {check_index(index, size_); return *locate(index);}
+        T& at(length_type index) {check_at(index, size_); return *locate(index);}
+        const T& at(length_type index) const {check_at(index, size_); return *locate(index);}
+        T& front() {return head_->data()[0];}
+        const T& front() const {return head_->data()[0];}
+        T& back() {return tail_->data()[tail_->count() - 1];}
+        const T& back() const {return tail_->data()[tail_->count() - 1];}
+        [[nodiscard]] Iterator locate(length_type index) const;
+
+        // 插入与删除元素；尾部的节点满了就新建节点，不拆开，所以顺序 push_back 时每个节点都是满的
+        void push_back(const T& value) {emplace_back(value);}
+        void push_back(T&& value) {emplace_back(std::move(value));}
+        template<class... Args>
+        T& emplace_back(Args&&... args);
+        void push_front(const T& value) {emplace_front(value);}
+        void push_front(T&& value) {emplace_front(std::move(value));}
+        template<class... Args>
+        T& emplace_front(Args&&... args);
+        bool pop_back();
+        bool pop_front();
+
+        // 在 position 之前插入，返回指向新元素的迭代器；O(K)
+        template<class... Args>
+        Iterator emplace(Iterator position, Args&&... args);
+        Iterator insert(Iterator position, const T& value) {return emplace(position, value);}
+        Iterator insert(Iterator position, T&& value) {return emplace(position, std::move(value));}
+        Iterator insert(Iterator position, length_type n, const T& value);
+        template<class InputIterator>
+        requires(not std::is_integral_v<InputIterator>)
+        Iterator insert(Iterator position, InputIterator first, InputIterator last);
+
+        // 删除元素，返回被删除元素之后的位置；O(K)
+        Iterator erase(Iterator position);
+        Iterator erase(Iterator first, Iterator last);
+        void clear();
+
+        // 把 other 的所有节点链接到 position 之前，other 变为空；position 在节点中间时先把节点拆开，O(K)，否则 O(1)
+        // 节点整个移过来，other 中的迭代器与引用仍然有效，指向这里的元素；两个分配器不相等时抛出异常
+        void splice(Iterator position, unrolled_list& other);
+        void splice(Iterator position, unrolled_list&& other) {splice(position, other);}
+
+        // swap
+        // 成员 swap 会挡住友元 swap 的查找，所以成员函数中直接交换，友元转调成员
+        void swap(unrolled_list& another) noexcept {
+            tinyWheels::swap(head_, another.head_);
+            tinyWheels::swap(tail_, another.tail_);
+            tinyWheels::swap(size_, another.size_);
+            tinyWheels::swap(nodes_, another.nodes_);
+            tinyWheels::swap(alloc_, another.alloc_);
+        }
+        friend void swap(unrolled_list& a, unrolled_list& b) noexcept {
+            a.swap(b);
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const unrolled_list& l) {
+            if constexpr (is_ostream_writable_v<T>) {
+                for (auto it = l.cbegin(); it != l.cend(); ++it) {
+                    if (it != l.cbegin()) os << ", ";
+                    os << *it;
+                }
+                os << " (" << l.size_ << ")";
+            }else {
+                os << "unrolled_list<" << typeid(T).name() << ", " << K << ">" << " size: " << l.size_;
+            }
+            return os;
+        }
+    };
+
+    // 使用 memory_resource 的 unrolled_list，所有节点都从同一个内存资源中申请
+    namespace pmr {
+        template<class T, size_t K = mzUnrolledList::default_node_elements<T>()>
+        using unrolled_list = tinyWheels::unrolled_list<T, K, PolymorphicAllocator<T>>;
+    }
+}
+
+#endif //UNROLLED_LIST_DEF_H
@@ -0,0 +1,373 @@
+//
+// Created by 24983 on 25-3-24.
+//
+
+#ifndef UNROLLED_LIST_IMPL_H
+#define UNROLLED_LIST_IMPL_H
+#include "unrolled_list.def.h"
+
+namespace tinyWheels {
+
+    template<class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::node_point unrolled_list<T, K, Alloc>::create_node(const node_point prev, const node_point next) {
+        const auto n = alloc_.allocate(1).first;
+        std::construct_at(n, prev, next);
+        if (prev != nullptr) prev->next(n); else head_ = n;
+        if (next != nullptr) next->prev(n); else tail_ = n;
+        ++nodes_;
+        return n;
+    }
+
+    template<class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::destroy_node(const node_point n) {
+        if (n->prev() != nullptr) n->prev()->next(n->next()); else head_ = n->next();
+        if (n->next() != nullptr) n->next()->prev(n->prev()); else tail_ = n->prev();
+        --nodes_;
+        std::destroy_at(n);
+        alloc_.deallocate(n, 1);
+    }
+
+    // 元素的移动构造不抛出异常，所以只有申请节点可能失败，失败时什么都没有改变
+    template<class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::node_point unrolled_list<T, K, Alloc>::split(const node_point n, const length_type at) {
+        const auto next = create_node(n, n->next());
+        const auto data = n->data();
+        for (length_type i = at; i < n->count(); ++i) {
+            std::construct_at(next->data() + (i - at), std::move(data[i]));
+            std::destroy_at(data + i);
+        }
+        next->count(n->count() - at);
+        n->count(at);
+        return next;
+    }
+
+    template<class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::absorb(const node_point to, const node_point from) {
+        const auto base = to->count();
+        for (length_type i = 0; i < from->count(); ++i) {
+            std::construct_at(to->data() + base + i, std::move(from->data()[i]));
+            std::destroy_at(from->data() + i);
+        }
+        to->count(base + from->count());
+        destroy_node(from);
+    }
+
+    template<class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::open_slot(const node_point n, const length_type index) {
+        const auto data = n->data();
+        for (auto i = n->count(); i > index; --i) {
+            std::construct_at(data + i, std::move(data[i - 1]));
+            std::destroy_at(data + i - 1);
+        }
+    }
+
+    // 少于半满时，与后一个或前一个节点合起来放得下就合并，避免大量删除之后留下许多几乎空的节点
+    template<class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::Iterator unrolled_list<T, K, Alloc>::rebalance(node_point n, length_type index) {
+        if (n->count() == 0) {
+            const auto next = n->next();
+            destroy_node(n);
+            return next != nullptr ? Iterator(next, 0) : end();
+        }
+        if (n->count() < K / 2) {
+            if (n->next() != nullptr and n->count() + n->next()->count() <= K) {
+                absorb(n, n->next());
+            }else if (n->prev() != nullptr and n->prev()->count() + n->count() <= K) {
+                const auto prev = n->prev();
+                index += prev->count();
+                absorb(prev, n);
+                n = prev;
+            }
+        }
+        if (index == n->count() and n->next() != nullptr) {
+            return Iterator(n->next(), 0);
+        }
+        return Iterator(n, index);
+    }
+
+    template<class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::check_same_allocator(const unrolled_list &another) const {
+        if (not (alloc_ == another.alloc_)) {
+            throw exception("unrolled_list 的分配器不相等，不能移动节点");
+        }
+    }
+
+    // 只拷贝元素，分配器保持不变；逐个 push_back，所以拷贝出来的节点都是满的
+    template<class T, size_t K, class Alloc>
+    unrolled_list<T, K, Alloc> &unrolled_list<T, K, Alloc>::copy_from(const unrolled_list &another) {
+        if (this != &another) {
+            clear();
+            another.for_each_segment([this](const span<const T> segment) {
+                for (const auto &value : segment) {
+                    emplace_back(value);
+                }
+            });
+        }
+        return *this;
+    }
+
+    template<class T, size_t K, class Alloc>
+    unrolled_list<T, K, Alloc>::unrolled_list(const unrolled_list &another) : alloc_(another.alloc_) {
+        copy_from(another);
+    }
+
+    template<class T, size_t K, class Alloc>
+    unrolled_list<T, K, Alloc>::unrolled_list(unrolled_list &&another) noexcept : alloc_(another.alloc_) {
+        swap(another);
+    }
+
+    template<class T, size_t K, class Alloc>
+    unrolled_list<T, K, Alloc>::unrolled_list(const length_type n, const Alloc &alloc) : alloc_(alloc) {
+        for (length_type i = 0; i < n; ++i) {
+            emplace_back();
+        }
+    }
+
+    template<class T, size_t K, class Alloc>
+    unrolled_list<T, K, Alloc>::unrolled_list(const length_type n, const T &value, const Alloc &alloc) : alloc_(alloc) {
+        for (length_type i = 0; i < n; ++i) {
+            emplace_back(value);
+        }
+    }
+
+    template<class T, size_t K, class Alloc>
+    template<class InputIterator>
+    requires(not std::is_integral_v<InputIterator>)
+    unrolled_list<T, K, Alloc>::unrolled_list(InputIterator first, InputIterator last, const Alloc &alloc) : alloc_(alloc) {
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+
+    template<class T, size_t K, class Alloc>
+    unrolled_list<T, K, Alloc>::unrolled_list(const std::initializer_list<T> &il, const Alloc &alloc)
+        : unrolled_list(il.begin(), il.end(), alloc) {
+    }
+
+    template<class T, size_t K, class Alloc>
+    unrolled_list<T, K, Alloc>::~unrolled_list() {
+        clear();
+    }
+
+    template<class T, size_t K, class Alloc>
+    unrolled_list<T, K, Alloc> &unrolled_list<T, K, Alloc>::operator=(const unrolled_list &another) {
+        return copy_from(another);
+    }
+
+    template<class T, size_t K, class Alloc>
+    unrolled_list<T, K, Alloc> &unrolled_list<T, K, Alloc>::operator=(unrolled_list &&another) noexcept {
+        if (this != &another) {
+            swap(another);
+        }
+        return *this;
+    }
+
+    template<class T, size_t K, class Alloc>
+    unrolled_list<T, K, Alloc> &unrolled_list<T, K, Alloc>::operator=(const std::initializer_list<T> &il) {
+        clear();
+        for (const auto &value : il) {
+            emplace_back(value);
+        }
+        return *this;
+    }
+
+    template<class T, size_t K, class Alloc>
+    bool unrolled_list<T, K, Alloc>::operator==(const unrolled_list &another) const {
+        if (size_ != another.size_) return false;
+        for (auto a = cbegin(), b = another.cbegin(); a != cend(); ++a, ++b) {
+            if (not (*a == *b)) return false;
+        }
+        return true;
+    }
+
+    template<class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::Iterator unrolled_list<T, K, Alloc>::locate(length_type index) const {
+        if (index < size_ / 2) {
+            auto cur = head_;
+            for (; index >= cur->count(); cur = cur->next()) {
+                index -= cur->count();
+            }
+            return Iterator(cur, index);
+        }
+        auto back = size_ - index - 1;  // 从后往前数的位置
+        auto cur = tail_;
+        for (; back >= cur->count(); cur = cur->prev()) {
+            back -= cur->count();
+        }
+        return Iterator(cur, cur->count() - back - 1);
+    }
+
+    template<class T, size_t K, class Alloc>
+    template<class... Args>
+    T &unrolled_list<T, K, Alloc>::emplace_back(Args &&... args) {
+        if (tail_ == nullptr or tail_->count() == K) {
+            T value(std::forward<Args>(args)...);  // 参数可能引用容器中的元素，先构造再申请节点
+            create_node(tail_, nullptr);
+            std::construct_at(tail_->data(), std::move(value));
+        }else {
+            std::construct_at(tail_->data() + tail_->count(), std::forward<Args>(args)...);
+        }
+        tail_->count(tail_->count() + 1);
+        ++size_;
+        return tail_->data()[tail_->count() - 1];
+    }
+
+    template<class T, size_t K, class Alloc>
+    template<class... Args>
+    T &unrolled_list<T, K, Alloc>::emplace_front(Args &&... args) {
+        if (head_ == nullptr or head_->count() == K) {
+            T value(std::forward<Args>(args)...);
+            create_node(nullptr, head_);
+            std::construct_at(head_->data(), std::move(value));
+        }else {
+            T value(std::forward<Args>(args)...);  // 构造抛出异常时节点中的元素还没有移动
+            open_slot(head_, 0);
+            std::construct_at(head_->data(), std::move(value));
+        }
+        head_->count(head_->count() + 1);
+        ++size_;
+        return head_->data()[0];
+    }
+
+    template<class T, size_t K, class Alloc>
+    bool unrolled_list<T, K, Alloc>::pop_back() {
+        if (size_ == 0) return false;
+        erase(Iterator(tail_, tail_->count() - 1));
+        return true;
+    }
+
+    template<class T, size_t K, class Alloc>
+    bool unrolled_list<T, K, Alloc>::pop_front() {
+        if (size_ == 0) return false;
+        erase(begin());
+        return true;
+    }
+
+    // 节点满了的时候：position 在节点开头而前一个节点有空位就放到前一个节点的末尾；
+    // 在整个链表的开头或末尾就新建节点；否则对半拆开，放进 position 所在的那一半
+    template<class T, size_t K, class Alloc>
+    template<class... Args>
+    typename unrolled_list<T, K, Alloc>::Iterator unrolled_list<T, K, Alloc>::emplace(Iterator position, Args &&... args) {
+        T value(std::forward<Args>(args)...);
+        auto n = position.node();
+        auto index = position.index();
+        if (n == nullptr) {
+            n = create_node(nullptr, nullptr);
+            index = 0;
+        }else if (index == 0 and n->prev() != nullptr and n->prev()->count() < K) {
+            n = n->prev();
+            index = n->count();
+        }else if (n->count() == K) {
+            if (index == K) {
+                n = create_node(n, n->next());
+                index = 0;
+            }else if (index == 0 and n->prev() == nullptr) {
+                n = create_node(nullptr, n);
+            }else {
+                const auto next = split(n, K / 2);
+                if (index > K / 2) {
+                    n = next;
+                    index -= K / 2;
+                }
+            }
+        }
+        open_slot(n, index);
+        std::construct_at(n->data() + index, std::move(value));
+        n->count(n->count() + 1);
+        ++size_;
+        return Iterator(n, index);
+    }
+
+    // 每次插入在上一次插入的元素之前，最后一次返回的就是第一个元素，之前的迭代器可能已经因为拆分失效，不再使用
+    template<class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::Iterator unrolled_list<T, K, Alloc>::insert(Iterator position, length_type n, const T &value) {
+        if (n == 0) {
+            return position;
+        }
+        const T copy = value;  // value 可能就在这个链表中，插入时会被移动
+        for (; n > 0; --n) {
+            position = emplace(position, copy);
+        }
+        return position;
+    }
+
+    // 依次插入在下一个位置之前，最后从最新的位置往回数出第一个元素
+    template<class T, size_t K, class Alloc>
+    template<class InputIterator>
+    requires(not std::is_integral_v<InputIterator>)
+    typename unrolled_list<T, K, Alloc>::Iterator unrolled_list<T, K, Alloc>::insert(Iterator position, InputIterator first, InputIterator last) {
+        ptrdiff_t inserted = 0;
+        for (; first != last; ++first, ++inserted) {
+            position = emplace(position, *first);
+            ++position;
+        }
+        return position - inserted;
+    }
+
+    template<class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::Iterator unrolled_list<T, K, Alloc>::erase(Iterator position) {
+        const auto n = position.node();
+        const auto index = position.index();
+        const auto data = n->data();
+        std::destroy_at(data + index);
+        for (auto i = index + 1; i < n->count(); ++i) {
+            std::construct_at(data + i - 1, std::move(data[i]));
+            std::destroy_at(data + i);
+        }
+        n->count(n->count() - 1);
+        --size_;
+        return rebalance(n, index);
+    }
+
+    // 删除会拆分、合并节点，last 可能失效，所以先数出个数
+    template<class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::Iterator unrolled_list<T, K, Alloc>::erase(Iterator first, Iterator last) {
+        for (auto n = last - first; n > 0; --n) {
+            first = erase(first);
+        }
+        return first;
+    }
+
+    template<class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::clear() {
+        for (auto cur = head_; cur != nullptr;) {
+            const auto next = cur->next();
+            std::destroy(cur->data(), cur->data() + cur->count());
+            std::destroy_at(cur);
+            alloc_.deallocate(cur, 1);
+            cur = next;
+        }
+        head_ = tail_ = nullptr;
+        size_ = nodes_ = 0;
+    }
+
+    template<class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::splice(Iterator position, unrolled_list &other) {
+        if (&other == this or other.empty()) {
+            return;
+        }
+        check_same_allocator(other);
+        if (empty()) {
+            swap(other);
+            return;
+        }
+        auto before = position.node(), after = before;
+        if (position.index() == before->count()) {
+            after = before->next();  // end()
+        }else if (position.index() == 0) {
+            before = before->prev();
+        }else {
+            after = split(before, position.index());
+        }
+        other.head_->prev(before);
+        other.tail_->next(after);
+        if (before != nullptr) before->next(other.head_); else head_ = other.head_;
+        if (after != nullptr) after->prev(other.tail_); else tail_ = other.tail_;
+        size_ += other.size_;
+        nodes_ += other.nodes_;
+        other.head_ = other.tail_ = nullptr;
+        other.size_ = other.nodes_ = 0;
+    }
+}
+
+#endif //UNROLLED_LIST_IMPL_H
@@ -7,9 +7,12 @@
 // #include <initializer_list>
 #include <iosfwd>
 #include "allocator.h"
+#include "bounds_check.h"
+#include "memory_resource.h"
 #include "traits.h"
 #include "iterator.h"
 #include "reverse_iterator.h"
+#include "span.h"
 /**
  * vector需要实现的功能：
  *
@@ -25,16 +28,17 @@ namespace tinyWheels{
         T* data_{nullptr};
         length_type size_{0};
         length_type capacity_{0};
+        [[no_unique_address]] Alloc alloc_;  // 无状态的 Allocator<T> 不占空间，PolymorphicAllocator 保存内存资源指针
 
         template<class InputIterator>
         InputIterator recapacity(length_type new_size, InputIterator it); // 数据迁移
         void allocateAndFill(length_type n, const T& value);
         void allocateAndFill(length_type n, T&& value);
         void allocateAndFill(length_type n);
+        void release();  // 析构所有元素并释放内存
 
-        // 移动数据，如果是使用正向迭代器，那么就是将数据向前移动，如果使用反向迭代器，那么就是将数据向后移动
-        template<class InputIterator>
-        void move_data(InputIterator first, InputIterator last, InputIterator dst); // 移动数据
+        // 在 position 之前空出 n 个未构造的位置，返回扩容之后的 position，size_ 不变，由调用者构造之后再增加
+        T* open_gap(T* position, length_type n);
     public:
         using Iterator = T*;
         using ConstIterator = const T*;
@@ -45,18 +49,22 @@ namespace tinyWheels{
         void resize(length_type s);
 
         // 构造函数与析构函数
+        // 拷贝构造会复制分配器，新的 vector 与原来的使用同一个内存来源
         vector();
+        explicit vector(const Alloc& alloc);
         vector(const vector&);
         vector(vector&&) noexcept ;
-        explicit vector(length_type n);
-        vector(length_type n, const T& value);
-        vector(length_type n, T&& value);
-        vector(const std::initializer_list<T>& il);  // 初始化列表构造实现
-        vector(std::initializer_list<T>&& il);       // 初始化列表构造实现
+        explicit vector(length_type n, const Alloc& alloc = Alloc());
+        vector(length_type n, const T& value, const Alloc& alloc = Alloc());
+        vector(length_type n, T&& value, const Alloc& alloc = Alloc());
+        vector(const std::initializer_list<T>& il, const Alloc& alloc = Alloc());  // 初始化列表构造实现
+        vector(std::initializer_list<T>&& il, const Alloc& alloc = Alloc());       // 初始化列表构造实现
         template<class InputIterator>
-        vector(InputIterator first, InputIterator last);  // 迭代器构造实现
+        vector(InputIterator first, InputIterator last, const Alloc& alloc = Alloc());  // 迭代器构造实现
         ~vector() ;
 
+        [[nodiscard]] Alloc get_allocator() const {return alloc_;}
+
         vector& operator=(const vector&);
         vector& operator=(vector&&) noexcept ;
         vector& operator=(const std::initializer_list<T>& il);
@@ -97,13 +105,11 @@ namespace tinyWheels{
         template<class InputIterator>
         void erase(InputIterator first, InputIterator last);
 
-        // 获取元素
-        T& operator[](length_type index) {
-            if (index >= capacity_) {
-                throw exception("Out of range, index: %lu, size: %lu, capacity: %lu", index, size_, capacity_);
-            }
-            return data_[index];
-        }
+        // 获取元素：operator[] 按 TINYWHEELS_BOUNDS_CHECK 检查下标（见 bounds_check.h），at() 始终检查
+        T& operator[](const length_type index) {check_index(index, size_); return data_[index];}
+        const T& operator[](const length_type index) const {check_index(index, size_); return data_[index];}
+        T& at(const length_type index) {check_at(index, size_); return data_[index];}
+        const T& at(const length_type index) const {check_at(index, size_); return data_[index];}
         T& back() {
             return data_[size_ - 1];
         }
@@ -116,8 +122,11 @@ namespace tinyWheels{
         constReverseIterator crbegin() const {return constReverseIterator(end());}
         reverseIterator rend() const {return reverseIterator(begin());}
         constReverseIterator crend() const {return constReverseIterator(begin());}
+        // 不复制元素的视图，扩容之后失效
+        span<T> as_span() {return span<T>(data_, size_);}
+        span<const T> as_span() const {return span<const T>(data_, size_);}
 
-        friend std::ostream& operator<<(std::ostream& os, const vector<T>& vec) {
+        friend std::ostream& operator<<(std::ostream& os, const vector& vec) {
             if constexpr (is_ostream_writable_v<T>) {
                 for (auto it = vec.begin(); it != vec.end(); ++it) {
                     if (it != vec.begin()) os << ", ";
@@ -133,10 +142,25 @@ namespace tinyWheels{
             tinyWheels::swap(v1.data_, v2.data_);
             tinyWheels::swap(v1.size_, v2.size_);
             tinyWheels::swap(v1.capacity_, v2.capacity_);
+            tinyWheels::swap(v1.alloc_, v2.alloc_);
         }
         void swap(vector& v) noexcept {
             tinyWheels::swap(*this, v);
         }
     };
+
+    // vector 只持有指向堆内存的指针，可以按字节搬移
+    template<class T, class Alloc>
+    struct is_trivially_relocatable<vector<T, Alloc>> : std::true_type {};
+
+    // 数据按 Alignment 对齐的 vector，例如 aligned_vector<float, 32> 可以直接用 AVX 对齐加载，默认按缓存行对齐
+    template<class T, size_t Alignment = MemoryPool::CACHE_LINE_BYTES>
+    using aligned_vector = vector<T, Allocator<T, Alignment>>;
+
+    // 使用 memory_resource 的 vector，例如 pmr::vector<int> v(&arena)，所有元素都从 arena 中申请
+    namespace pmr {
+        template<class T>
+        using vector = tinyWheels::vector<T, PolymorphicAllocator<T>>;
+    }
 }
 #endif //VECTOR_DEFINE_H
@@ -14,7 +14,7 @@ namespace tinyWheels {
 
     template<class T, class Alloc>
     void vector<T, Alloc>::allocateAndFill(length_type n, const T &value) {
-        auto [ptr, cap] = dataAllocator::allocate(n);
+        auto [ptr, cap] = alloc_.allocate(n);
         data_ = ptr;
         capacity_ = cap;
         size_ = n;
@@ -23,7 +23,7 @@ namespace tinyWheels {
 
     template<class T, class Alloc>
     void vector<T, Alloc>::allocateAndFill(length_type n, T &&value) {
-        auto [ptr, cap] = dataAllocator::allocate(n);
+        auto [ptr, cap] = alloc_.allocate(n);
         data_ = ptr;
         capacity_ = cap;
         size_ = n;
@@ -32,7 +32,7 @@ namespace tinyWheels {
 
     template<class T, class Alloc>
     void vector<T, Alloc>::allocateAndFill(length_type n) {
-        auto [ptr, cap] = dataAllocator::allocate(n);
+        auto [ptr, cap] = alloc_.allocate(n);
         data_ = ptr;
         capacity_ = cap;
         size_ = n;
@@ -40,86 +40,100 @@ namespace tinyWheels {
     }
 
     template<class T, class Alloc>
-    template<class InputIterator>
-    void vector<T, Alloc>::move_data(InputIterator first, InputIterator last, InputIterator dst) {
-        // 向前移动，先移动 first, last最好
-        for (auto it = first, it2 = dst; it != last; ++it, ++it2) {
-            *it2 = std::move(*it);
+    void vector<T, Alloc>::release() {
+        if (data_ != nullptr) {
+            dataAllocator::Destruct(data_, size_);
+            alloc_.deallocate(data_, capacity_);  // 按容量释放，才能还给正确的大小类别
+            data_ = nullptr;
+            size_ = 0;
+            capacity_ = 0;
         }
     }
 
+    template<class T, class Alloc>
+    T *vector<T, Alloc>::open_gap(T *position, const length_type n) {
+        position = recapacity(size_ + n, position);
+        relocate(position, end(), position + n);  // 把 [position, end()) 向后移动 n 个位置
+        return position;
+    }
+
     template<class T, class Alloc>
     void vector<T, Alloc>::resize(length_type s) {
-        this->recapacity(s, begin());
+        if (s < size_) {
+            dataAllocator::Destruct(data_ + s, size_ - s);
+        }else {
+            this->recapacity(s, begin());
+            dataAllocator::construct(data_ + size_, s - size_);
+        }
         size_ = s;
     }
 
-    // 默认构造函数，也必须初始化空间，但是不初始化元素
+    // 默认构造函数不申请内存，第一次插入时才申请
+    template<class T, class Alloc>
+    vector<T, Alloc>::vector() = default;
+
     template<class T, class Alloc>
-    vector<T, Alloc>::vector() {
-        allocateAndFill(0);
+    vector<T, Alloc>::vector(const Alloc &alloc) : alloc_(alloc) {
     }
 
     // 拷贝构造函数
     template<class T, class Alloc>
-    vector<T, Alloc>::vector(const vector &vec) {
-        this->copy_from(std::forward<vector>(vec));
+    vector<T, Alloc>::vector(const vector &vec) : alloc_(vec.alloc_) {
+        this->copy_from(vec);
     }
 
     // 移动构造函数
     template<class T, class Alloc>
-    vector<T, Alloc>::vector(vector &&vec) noexcept {
+    vector<T, Alloc>::vector(vector &&vec) noexcept : alloc_(vec.alloc_) {
         this->move_from(std::forward<vector>(vec));
     }
 
     template<class T, class Alloc>
-    vector<T, Alloc>::vector(length_type n) {
+    vector<T, Alloc>::vector(length_type n, const Alloc &alloc) : alloc_(alloc) {
         allocateAndFill(n);
     }
 
     template<class T, class Alloc>
-    vector<T, Alloc>::vector(length_type n, const T &value) {
+    vector<T, Alloc>::vector(length_type n, const T &value, const Alloc &alloc) : alloc_(alloc) {
         allocateAndFill(n, std::forward<T>(value));
     }
 
     template<class T, class Alloc>
-    vector<T, Alloc>::vector(length_type n, T &&value) {
+    vector<T, Alloc>::vector(length_type n, T &&value, const Alloc &alloc) : alloc_(alloc) {
         allocateAndFill(n, std::forward<T>(value));
     }
 
     template<class T, class Alloc>
-    vector<T, Alloc>::vector(const std::initializer_list<T> &il):vector(il.begin(), il.end()) {
+    vector<T, Alloc>::vector(const std::initializer_list<T> &il, const Alloc &alloc):vector(il.begin(), il.end(), alloc) {
     }
 
     template<class T, class Alloc>
-    vector<T, Alloc>::vector(std::initializer_list<T> &&il):vector(il.begin(), il.end()) {
+    vector<T, Alloc>::vector(std::initializer_list<T> &&il, const Alloc &alloc):vector(il.begin(), il.end(), alloc) {
     }
 
 
 
     template<class T, class Alloc>
     template<class InputIterator>
-    vector<T, Alloc>::vector(InputIterator first, InputIterator last) {
+    vector<T, Alloc>::vector(InputIterator first, InputIterator last, const Alloc &alloc) : alloc_(alloc) {
         if constexpr (std::is_integral_v<InputIterator>) {
             // 调用 vector(length_type n, T &&value) 构造函数
             this->allocateAndFill(first, std::forward<InputIterator>(last));
         }else {
-            auto length = last - first;
-            this->allocateAndFill(length);
-            for (length_type i = 0; i < length; ++i) {
-                data_[i] = *first++;
-            }
+            // 直接在未构造的内存上复制构造，不先默认构造再赋值
+            const length_type length = last - first;
+            auto [ptr, cap] = alloc_.allocate(length);
+            data_ = ptr;
+            capacity_ = cap;
+            uninitialized_copy(first, last, data_);
+            size_ = length;
         }
     }
 
 
     template<class T, class Alloc>
     vector<T, Alloc>::~vector() {
-        if (data_ != nullptr) {
-            dataAllocator::Destruct(data_, size_);
-            dataAllocator::deallocate(data_, size_);
-            data_ = nullptr;
-        }
+        release();
     }
 
     // 拷贝赋值运算符
@@ -128,8 +142,7 @@ namespace tinyWheels {
         if (this == &vec) {
             return *this;
         }
-        ~vector();
-        this->copy_from(std::forward<vector>(vec));
+        this->copy_from(vec);
         return *this;
     }
 
@@ -139,22 +152,20 @@ namespace tinyWheels {
         if (this == &vec) {
             return *this;
         }
-        ~vector();
+        release();
         this->move_from(std::forward<vector>(vec));
         return *this;
     }
 
     template<class T, class Alloc>
     vector<T, Alloc> &vector<T, Alloc>::operator=(const std::initializer_list<T> &il) {
-        ~vector();
-        *this = vector(il);
+        *this = vector(il, alloc_);
         return *this;
     }
 
     template<class T, class Alloc>
     vector<T, Alloc> &vector<T, Alloc>::operator=(std::initializer_list<T> &&il) {
-        ~vector();
-        *this = vector(il);
+        *this = vector(il, alloc_);
         return *this;
     }
 
@@ -164,6 +175,7 @@ namespace tinyWheels {
             data_ = vec.data_;
             capacity_ = vec.capacity_;
             size_ = vec.size_;
+            alloc_ = vec.alloc_;  // 内存由原来的分配器申请，必须一起带走
             vec.data_ = nullptr;
             vec.capacity_ = 0;
             vec.size_ = 0;
@@ -174,14 +186,12 @@ namespace tinyWheels {
     template<class T, class Alloc>
     vector<T, Alloc> &vector<T, Alloc>::copy_from(const vector &vec) {
         if (this != &vec) {
-            ~vector();
-            auto [ptr, cap] = dataAllocator::allocate(vec.size());
+            release();
+            auto [ptr, cap] = alloc_.allocate(vec.size());
             data_ = ptr;
             capacity_ = cap;
+            uninitialized_copy(vec.cbegin(), vec.cend(), data_);
             size_ = vec.size();
-            for (length_type i = 0; i < size_; ++i) {
-                data_[i] = vec.data_[i];
-            }
         }
         return *this;
     }
@@ -214,7 +224,7 @@ namespace tinyWheels {
 
     template<class T, class Alloc>
     void vector<T, Alloc>::push_back(T &&value) {
-        insert(end(), value);
+        insert(end(), std::move(value));
     }
 
     template<class T, class Alloc>
@@ -238,15 +248,22 @@ namespace tinyWheels {
     InputIterator vector<T, Alloc>::recapacity(length_type new_size, InputIterator it) {
         new_size = new_size == -1 ? size_ + 1 : new_size;
         if (new_size > capacity_) {  // 只有大于容量时才需要迁移数据
+            new_size = new_size < 2 * capacity_ ? 2 * capacity_ : new_size;  // 至少翻倍，连续 push_back 均摊 O(1)
             auto difference = it - begin();
+            // 平凡可重定位的类型交给分配器整体搬移，超大内存块用 mremap 只改页表，不需要逐个移动
+            if constexpr (is_trivially_relocatable_v<T> and reallocatable_allocator<Alloc, T>) {
+                if (auto [ptr, cap] = alloc_.reallocate(data_, capacity_, new_size); ptr != nullptr) {
+                    data_ = ptr;
+                    capacity_ = cap;
+                    return begin() + difference;
+                }
+            }
 
-            auto [ptr, cap] = dataAllocator::allocate(new_size);
-            auto it1 = ptr;
-            auto it2 = data_;
-            for (length_type i = 0; i < size_; ++i) {
-                *it1++ = std::move(*it2++);
+            auto [ptr, cap] = alloc_.allocate(new_size);
+            relocate(data_, data_ + size_, ptr);
+            if (data_ != nullptr) {  // 默认构造的 vector 还没有申请内存
+                alloc_.deallocate(data_, capacity_);  // 只需要释放内存，不要执行析构函数，因为对象已经搬到新内存了
             }
-            dataAllocator::deallocate(data_, size_);  // 只需要释放内存，不要执行构造函数，因为对象仍然存在，对象只是搬家了而已
             data_ = ptr;
             capacity_ = cap;
             it = begin() + difference;
@@ -263,47 +280,47 @@ namespace tinyWheels {
     template<class T, class Alloc>
     template<class InputIterator>
     void vector<T, Alloc>::insert(InputIterator it, T &&value) {
-        insert(it, 1, value);
+        if (&value >= data_ and &value < end()) {  // value 是自己的元素，扩容或者搬移之后就失效了，先移出来
+            T copy(std::move(value));
+            insert(it, std::move(copy));
+            return;
+        }
+        it = open_gap(it, 1);
+        new(it) T(std::move(value));
+        ++size_;
     }
 
     template<class T, class Alloc>
     template<class InputIterator>
     void vector<T, Alloc>::insert(InputIterator it, length_type n, const T &value) {
-        it = recapacity(size_ + n, it);
-        reverseIterator last(it);
-        last += 1;
-        reverseIterator dst (it + n + size_);
-        move_data(rbegin(), last, dst);  // 把 [it, end()) 之前的数据向后移动 n 个位置
-        fill(it, it + n, value);
-        size_ = size_ + n;
+        if (&value >= data_ and &value < end()) {  // value 是自己的元素，扩容或者搬移之后就失效了，先复制出来
+            const T copy(value);
+            insert(it, n, copy);
+            return;
+        }
+        it = open_gap(it, n);
+        dataAllocator::construct(it, n, value);
+        size_ += n;
     }
 
     template<class T, class Alloc>
     template<class InputIterator>
     void vector<T, Alloc>::insert(InputIterator it, length_type n, T &&value) {
-        it = recapacity(size_ + n, it);
-        reverseIterator last(it);
-        last += 1;
-        reverseIterator dst(it + n + size_);
-        move_data(rbegin(), last, dst);  // 把 [it, end()) 之前的数据向后移动 n 个位置
-        fill(it, it + n, std::forward<T>(value));
-        size_ = size_ + n;
+        if (n == 1) {
+            insert(it, std::move(value));
+        }else {
+            insert(it, n, static_cast<const T &>(value));  // 要放 n 份，只能复制
+        }
     }
 
     template<class T, class Alloc>
     template<class InputIterator, class InputIterator2>
     requires(not std::is_integral_v<InputIterator2>)
     void vector<T, Alloc>::insert(InputIterator it, InputIterator2 first, InputIterator2 last) {
-        auto n = last - first;
-        it = recapacity(size_ + n, it);
-        reverseIterator rlast(it);
-        rlast += 1;
-        reverseIterator dst(it + n + size_);
-        move_data(rbegin(), rlast, dst);  // 把 [it, end()) 之前的数据向后移动 n 个位置
-        for (auto it1 = first, it2 = it; it1 != last; ++it1, ++it2) {
-            *it2 = *it1;
-        }
-        size_ = size_ + n;
+        const length_type n = last - first;
+        it = open_gap(it, n);
+        uninitialized_copy(first, last, it);
+        size_ += n;
     }
 
     template<class T, class Alloc>
@@ -318,7 +335,7 @@ namespace tinyWheels {
         // auto start_erase = get_index_by_iterator(first);
         // auto start_left = get_index_by_iterator(last);
         dataAllocator::Destruct(first, last - first);
-        move_data(last, end(), first);
+        relocate(last, end(), first);  // 后面的元素向前搬到空出来的位置
         size_ -= last - first;
     }
 
@@ -0,0 +1,56 @@
+#include "arena.h"
+
+namespace tinyWheels {
+    Arena::Arena(const memory_size_type initial_bytes, memory_resource *upstream)
+        : upstream_(upstream != nullptr ? upstream : get_default_resource()),
+          next_bytes_(initial_bytes > BLOCK_HEADER_BYTES ? initial_bytes : INITIAL_BYTES) {}
+
+    // 当前内存块放不下：reset() 之后后面还有内存块并且放得下就直接复用，否则向上游申请一块插在当前内存块之后
+    void *Arena::allocate_slow(const memory_size_type bytes, const memory_size_type alignment) {
+        // 内存块开头按 DEFAULT_ALIGNMENT 对齐，更高的对齐最多需要 alignment 字节的填充
+        const auto need = BLOCK_HEADER_BYTES + bytes + (alignment > DEFAULT_ALIGNMENT ? alignment : 0);
+        auto block = current_ != nullptr ? current_->next : nullptr;
+        if (block == nullptr or block->bytes < need) {
+            const auto total_bytes = next_bytes_ > need ? next_bytes_ : need;
+            block = new(upstream_->allocate(total_bytes, DEFAULT_ALIGNMENT)) Block{block, total_bytes};
+            if (current_ != nullptr) {
+                current_->next = block;
+            }else {
+                first_ = block;
+            }
+            reserved_bytes_ += total_bytes;
+            if (next_bytes_ < MAX_BLOCK_BYTES) {
+                next_bytes_ *= 2;
+            }
+        }
+        current_ = block;
+        cursor_ = reinterpret_cast<char *>(block) + BLOCK_HEADER_BYTES;
+        limit_ = reinterpret_cast<char *>(block) + block->bytes;
+        return bump(bytes, alignment);
+    }
+
+    void Arena::reset() {
+        while (finalizers_ != nullptr) {
+            const auto finalizer = finalizers_;
+            finalizers_ = finalizer->next;
+            finalizer->destroy(finalizer->object);
+        }
+        current_ = first_;
+        if (first_ != nullptr) {
+            cursor_ = reinterpret_cast<char *>(first_) + BLOCK_HEADER_BYTES;
+            limit_ = reinterpret_cast<char *>(first_) + first_->bytes;
+        }
+    }
+
+    void Arena::release() {
+        reset();
+        while (first_ != nullptr) {
+            const auto next = first_->next;
+            upstream_->deallocate(first_, first_->bytes, DEFAULT_ALIGNMENT);
+            first_ = next;
+        }
+        current_ = nullptr;
+        cursor_ = limit_ = nullptr;
+        reserved_bytes_ = 0;
+    }
+}
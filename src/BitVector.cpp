@@ -0,0 +1,236 @@
+#include "bit_vector.h"
+
+#include <algorithm>
+#include <ostream>
+
+namespace tinyWheels {
+    namespace detail {
+        size_t find_next_bit(const uint64_t *words, const size_t bits, const size_t pos) {
+            if (pos >= bits) {
+                return bits;
+            }
+            auto index = pos / WORD_BITS;
+            // pos 所在的字先去掉 pos 之前的位，之后的字交给向量化内核跳过全 0 的字
+            if (const auto word = words[index] & ~uint64_t(0) << pos % WORD_BITS; word != 0) {
+                return index * WORD_BITS + __builtin_ctzll(word);
+            }
+            const auto n = word_count(bits);
+            ++index;
+            index += simd::find_nonzero(words + index, n - index);
+            return index == n ? bits : index * WORD_BITS + __builtin_ctzll(words[index]);
+        }
+
+        size_t rank_bits(const uint64_t *words, const size_t pos) {
+            const auto full = pos / WORD_BITS;
+            auto rst = simd::popcount(words, full);
+            if (pos % WORD_BITS != 0) {
+                rst += __builtin_popcountll(words[full] & tail_mask(pos));
+            }
+            return rst;
+        }
+
+        size_t select_bit(const uint64_t *words, const size_t bits, size_t k) {
+            const auto n = word_count(bits);
+            for (size_t i = 0; i < n; ++i) {
+                const size_t ones = __builtin_popcountll(words[i]);
+                if (k < ones) {
+                    return i * WORD_BITS + select_in_word(words[i], k);
+                }
+                k -= ones;
+            }
+            return bits;
+        }
+
+        size_t select_in_word(uint64_t word, size_t k) {
+            // 先按字节跳过，再在字节内逐个去掉最低位的 1
+            for (size_t shift = 0; shift < WORD_BITS; shift += 8) {
+                const size_t ones = __builtin_popcountll(word >> shift & 0xff);
+                if (k < ones) {
+                    word = word >> shift & 0xff;
+                    for (; k > 0; --k) {
+                        word &= word - 1;
+                    }
+                    return shift + __builtin_ctzll(word);
+                }
+                k -= ones;
+            }
+            return WORD_BITS;
+        }
+
+        void print_bits(std::ostream &os, const uint64_t *words, const size_t bits) {
+            for (size_t i = 0; i < bits; ++i) {
+                os << (words[i / WORD_BITS] >> i % WORD_BITS & 1 ? '1' : '0');
+            }
+        }
+    }
+
+    bit_vector::bit_vector(const size_t n, const bool value)
+        : words_(detail::word_count(n), value ? ~uint64_t(0) : 0), size_(n) {
+        trim();
+    }
+
+    void bit_vector::check(const size_t pos) const {
+        if (pos >= size_) {
+            throw exception("Out of range, pos: %lu, size: %lu", pos, size_);
+        }
+    }
+
+    void bit_vector::check_same_size(const bit_vector &another) const {
+        if (size_ != another.size_) {
+            throw exception("bit_vector size mismatch: %lu and %lu", size_, another.size_);
+        }
+    }
+
+    void bit_vector::trim() {
+        if (not words_.empty()) {
+            words_.back() &= detail::tail_mask(size_);
+        }
+    }
+
+    bit_vector &bit_vector::apply(const simd::bit_op op, const bit_vector &another) {
+        check_same_size(another);
+        simd::bitwise(op, words_.begin(), another.words_.begin(), words_.size());
+        return *this;
+    }
+
+    void bit_vector::resize(const size_t n, const bool value) {
+        const auto old_words = words_.size();
+        words_.resize(detail::word_count(n));  // 新的字是 0
+        if (value and n > size_) {
+            // 原来最后一个字中超过 size_ 的位是 0，整字置 1 之后再由 trim 去掉超过 n 的位
+            if (size_ % detail::WORD_BITS != 0) {
+                words_.begin()[size_ / detail::WORD_BITS] |= ~uint64_t(0) << size_ % detail::WORD_BITS;
+            }
+            std::fill(words_.begin() + old_words, words_.end(), ~uint64_t(0));
+        }
+        size_ = n;
+        trim();
+    }
+
+    void bit_vector::push_back(const bool value) {
+        if (size_ % detail::WORD_BITS == 0) {
+            words_.push_back(0);
+        }
+        if (value) {
+            words_.back() |= uint64_t(1) << size_ % detail::WORD_BITS;
+        }
+        ++size_;
+    }
+
+    bool bit_vector::pop_back() {
+        if (size_ == 0) {
+            return false;
+        }
+        --size_;
+        if (size_ % detail::WORD_BITS == 0) {
+            words_.pop_back();
+        }else {
+            trim();
+        }
+        return true;
+    }
+
+    bit_vector &bit_vector::set(const size_t pos, const bool value) {
+        check(pos);
+        bit_reference(words_.begin() + pos / detail::WORD_BITS, pos % detail::WORD_BITS) = value;
+        return *this;
+    }
+
+    bit_vector &bit_vector::flip(const size_t pos) {
+        check(pos);
+        words_.begin()[pos / detail::WORD_BITS] ^= uint64_t(1) << pos % detail::WORD_BITS;
+        return *this;
+    }
+
+    bit_vector &bit_vector::set() {
+        std::fill(words_.begin(), words_.end(), ~uint64_t(0));
+        trim();
+        return *this;
+    }
+
+    bit_vector &bit_vector::reset() {
+        std::fill(words_.begin(), words_.end(), 0);
+        return *this;
+    }
+
+    bit_vector &bit_vector::flip() {
+        for (auto &word : words_) {
+            word = ~word;
+        }
+        trim();
+        return *this;
+    }
+
+    size_t bit_vector::count() const {
+        return simd::popcount(words_.begin(), words_.size());
+    }
+
+    bool bit_vector::any() const {
+        return simd::find_nonzero(words_.begin(), words_.size()) != words_.size();
+    }
+
+    size_t bit_vector::find_first() const {
+        const auto rst = detail::find_next_bit(words_.begin(), size_, 0);
+        return rst == size_ ? npos : rst;
+    }
+
+    size_t bit_vector::find_next(const size_t pos) const {
+        const auto rst = pos + 1 >= size_ ? size_ : detail::find_next_bit(words_.begin(), size_, pos + 1);
+        return rst == size_ ? npos : rst;
+    }
+
+    size_t bit_vector::rank(const size_t pos) const {
+        return detail::rank_bits(words_.begin(), std::min(pos, size_));
+    }
+
+    size_t bit_vector::select(const size_t k) const {
+        const auto rst = detail::select_bit(words_.begin(), size_, k);
+        return rst == size_ ? npos : rst;
+    }
+
+    std::ostream &operator<<(std::ostream &os, const bit_vector &bits) {
+        detail::print_bits(os, bits.words_.begin(), bits.size_);
+        return os;
+    }
+
+    rank_index::rank_index(const bit_vector &bits)
+        : bits_(&bits), blocks_((bits.word_count() + BLOCK_WORDS - 1) / BLOCK_WORDS + 1) {
+        const auto words = bits.data();
+        const auto n = bits.word_count();
+        for (size_t block = 0; block + 1 < blocks_.size(); ++block) {
+            const auto first = block * BLOCK_WORDS;
+            blocks_.begin()[block + 1] = blocks_.begin()[block] + simd::popcount(words + first, std::min(BLOCK_WORDS, n - first));
+        }
+    }
+
+    size_t rank_index::rank(size_t pos) const {
+        pos = std::min(pos, bits_->size());
+        const auto words = bits_->data();
+        const auto word = pos / detail::WORD_BITS;
+        auto rst = blocks_.begin()[word / BLOCK_WORDS];
+        for (auto i = word / BLOCK_WORDS * BLOCK_WORDS; i < word; ++i) {
+            rst += __builtin_popcountll(words[i]);
+        }
+        if (pos % detail::WORD_BITS != 0) {
+            rst += __builtin_popcountll(words[word] & detail::tail_mask(pos));
+        }
+        return rst;
+    }
+
+    size_t rank_index::select(size_t k) const {
+        if (k >= count()) {
+            return npos;
+        }
+        // 最后一个之前 1 的个数不超过 k 的块
+        const auto block = std::upper_bound(blocks_.begin(), blocks_.end(), k) - blocks_.begin() - 1;
+        k -= blocks_.begin()[block];
+        const auto words = bits_->data();
+        for (auto i = block * BLOCK_WORDS; ; ++i) {
+            const size_t ones = __builtin_popcountll(words[i]);
+            if (k < ones) {
+                return i * detail::WORD_BITS + detail::select_in_word(words[i], k);
+            }
+            k -= ones;
+        }
+    }
+}
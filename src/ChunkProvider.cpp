@@ -0,0 +1,112 @@
+#include "ChunkProvider.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace tinyWheels {
+    void *MallocChunkProvider::allocate(const memory_size_type bytes, const memory_size_type alignment) {
+        if (alignment <= alignof(std::max_align_t)) {
+            return malloc(bytes);
+        }
+        void *address = nullptr;
+        if (posix_memalign(&address, alignment, bytes) != 0) {
+            return nullptr;
+        }
+        return address;
+    }
+
+    // glibc 可能把释放的内存留在堆中，先用 MADV_DONTNEED 丢掉其中完整的页，常驻内存立刻下降
+    void MallocChunkProvider::release(void *address, const memory_size_type bytes) {
+        const auto page = MmapChunkProvider::page_bytes();
+        const auto begin = (reinterpret_cast<uintptr_t>(address) + page - 1) & ~(page - 1);
+        const auto end = (reinterpret_cast<uintptr_t>(address) + bytes) & ~(page - 1);
+        if (end > begin) {
+            madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+        }
+        free(address);
+    }
+
+    void *MallocChunkProvider::reallocate(void *address, memory_size_type, const memory_size_type new_bytes, const memory_size_type alignment) {
+        if (alignment > alignof(std::max_align_t)) {
+            return nullptr;
+        }
+        return realloc(address, new_bytes);
+    }
+
+    MallocChunkProvider &MallocChunkProvider::instance() {
+        static MallocChunkProvider provider;
+        return provider;
+    }
+
+    ChunkProvider::memory_size_type MmapChunkProvider::page_bytes() {
+        static const auto bytes = static_cast<memory_size_type>(sysconf(_SC_PAGESIZE));
+        return bytes;
+    }
+
+    ChunkProvider::memory_size_type MmapChunkProvider::round_up(const memory_size_type bytes) const {
+        const auto unit = huge_pages_ ? HUGE_PAGE_BYTES : page_bytes();
+        return (bytes + unit - 1) / unit * unit;
+    }
+
+    // mmap 只保证按页对齐，需要更大的对齐时多映射 alignment 字节，再把首尾多余的部分还给操作系统
+    void *MmapChunkProvider::allocate(memory_size_type bytes, memory_size_type alignment) {
+        bytes = round_up(bytes);
+        if (huge_pages_ and alignment < HUGE_PAGE_BYTES) {
+            alignment = HUGE_PAGE_BYTES;  // 大页必须按 2MB 对齐，内核才能用一个大页映射
+        }
+        const auto extra = alignment > page_bytes() ? alignment : 0;
+        auto mapped = mmap(nullptr, bytes + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) {
+            return nullptr;
+        }
+        auto address = static_cast<char *>(mapped);
+        if (extra != 0) {
+            const auto begin = reinterpret_cast<uintptr_t>(address);
+            const auto aligned = (begin + alignment - 1) & ~(alignment - 1);
+            const auto head = aligned - begin;
+            if (head != 0) {
+                munmap(address, head);
+            }
+            if (extra - head != 0) {
+                munmap(reinterpret_cast<char *>(aligned) + bytes, extra - head);
+            }
+            address = reinterpret_cast<char *>(aligned);
+        }
+        if (huge_pages_) {
+            madvise(address, bytes, MADV_HUGEPAGE);  // 只是建议，内核不支持时忽略即可
+        }
+        return address;
+    }
+
+    void MmapChunkProvider::release(void *address, const memory_size_type bytes) {
+        munmap(address, round_up(bytes));
+    }
+
+    // mremap 移动之后只保证按页对齐，打开大页时也一样；对齐超过页大小时返回 nullptr，由调用者申请新内存再复制
+    void *MmapChunkProvider::reallocate(void *address, const memory_size_type old_bytes, memory_size_type new_bytes, const memory_size_type alignment) {
+        if (alignment > page_bytes()) {
+            return nullptr;
+        }
+        new_bytes = round_up(new_bytes);
+        const auto mapped = mremap(address, round_up(old_bytes), new_bytes, MREMAP_MAYMOVE);
+        if (mapped == MAP_FAILED) {
+            return nullptr;
+        }
+        if (huge_pages_) {
+            madvise(mapped, new_bytes, MADV_HUGEPAGE);
+        }
+        return mapped;
+    }
+
+    bool MmapChunkProvider::expand(void *address, const memory_size_type old_bytes, const memory_size_type new_bytes) {
+        if (mremap(address, round_up(old_bytes), round_up(new_bytes), 0) == MAP_FAILED) {
+            return false;
+        }
+        if (huge_pages_) {
+            madvise(address, round_up(new_bytes), MADV_HUGEPAGE);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,192 @@
+#include "HeapProfiler.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <execinfo.h>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tinyWheels {
+    std::atomic<bool> HeapProfiler::running_{false};
+    std::atomic<HeapProfiler::memory_size_type> HeapProfiler::sample_bytes_{DEFAULT_SAMPLE_BYTES};
+
+    namespace {
+        // 调用栈、类型、大小类别相同的样本合并成一条
+        struct SampleKey {
+            void *frames[HeapProfiler::MAX_DEPTH];
+            int depth;
+            const std::type_info *type;
+            size_t size_class;
+
+            bool operator==(const SampleKey &other) const {
+                return depth == other.depth and size_class == other.size_class and *type == *other.type
+                       and std::memcmp(frames, other.frames, depth * sizeof(void *)) == 0;
+            }
+        };
+        struct SampleKeyHash {
+            size_t operator()(const SampleKey &key) const {
+                auto hash = key.type->hash_code() ^ (key.size_class * 0x9e3779b97f4a7c15ULL);
+                for (int i = 0; i < key.depth; ++i) {
+                    hash = (hash ^ reinterpret_cast<uintptr_t>(key.frames[i])) * 0x100000001b3ULL;
+                }
+                return hash;
+            }
+        };
+        struct SampleValue {
+            size_t count{0};            // 采样到的次数
+            size_t bytes{0};            // 采样到的字节数
+            double estimated_count{0};  // 还原后的估计申请次数
+            double estimated_bytes{0};  // 还原后的估计字节数
+        };
+
+        // 样本表用 malloc 的内存，不经过 Allocator，记录样本时不会再触发采样；不析构，退出时其他线程仍然可以记录
+        std::mutex samples_mutex;
+        auto &samples_table = *new std::unordered_map<SampleKey, SampleValue, SampleKeyHash>;
+        size_t samples_total = 0;
+
+        // 每个线程一个 xorshift 随机数生成器，种子来自线程局部变量的地址
+        thread_local uint64_t random_state = 0;
+        thread_local bool in_record = false;
+
+        double next_random() {
+            if (random_state == 0) {
+                random_state = reinterpret_cast<uintptr_t>(&random_state) * 0x9e3779b97f4a7c15ULL | 1;
+            }
+            random_state ^= random_state << 13;
+            random_state ^= random_state >> 7;
+            random_state ^= random_state << 17;
+            return static_cast<double>(random_state >> 11) / static_cast<double>(1ULL << 53);  // [0, 1)
+        }
+
+        // 下一次采样前还要申请的字节数，服从均值为 mean 的指数分布
+        int64_t next_interval(const size_t mean) {
+            return static_cast<int64_t>(-std::log(1.0 - next_random()) * static_cast<double>(mean)) + 1;
+        }
+
+        std::string demangle(const char *name) {
+            int status = 0;
+            char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+            if (status != 0 or demangled == nullptr) {
+                return name;
+            }
+            std::string rst(demangled);
+            free(demangled);
+            return rst;
+        }
+
+        // backtrace_symbols 的格式是 "模块(符号+偏移) [地址]"，有符号时取出符号并还原，没有时保留 "模块+偏移"
+        std::string frame_name(const char *symbol) {
+            const char *open = std::strchr(symbol, '(');
+            const char *plus = open != nullptr ? std::strchr(open, '+') : nullptr;
+            const char *close = open != nullptr ? std::strchr(open, ')') : nullptr;
+            if (open != nullptr and plus != nullptr and plus > open + 1) {
+                return demangle(std::string(open + 1, plus).c_str());
+            }
+            const char *slash = std::strrchr(symbol, '/');
+            const char *module = slash != nullptr ? slash + 1 : symbol;
+            if (open != nullptr and close != nullptr) {
+                return std::string(module, open) + std::string(open + 1, close);
+            }
+            return symbol;
+        }
+
+        // 折叠栈格式中 ';' 是分隔符，空格后面是数值，都要替换掉
+        std::string folded_safe(std::string name) {
+            for (auto &c : name) {
+                if (c == ';' or c == ' ') c = '_';
+            }
+            return name;
+        }
+    }
+
+    void HeapProfiler::start(const memory_size_type sample_bytes) {
+        sample_bytes_.store(sample_bytes != 0 ? sample_bytes : DEFAULT_SAMPLE_BYTES, std::memory_order_relaxed);
+        running_.store(true, std::memory_order_relaxed);
+    }
+
+    void HeapProfiler::stop() {
+        running_.store(false, std::memory_order_relaxed);
+    }
+
+    void HeapProfiler::reset() {
+        std::lock_guard lock(samples_mutex);
+        samples_table.clear();
+        samples_total = 0;
+    }
+
+    size_t HeapProfiler::samples() {
+        std::lock_guard lock(samples_mutex);
+        return samples_total;
+    }
+
+    void HeapProfiler::record(const memory_size_type bytes, const std::type_info &type, const memory_size_type size_class) {
+        const auto mean = sample_bytes();
+        const bool first = random_state == 0;
+        bytes_until_sample_ = next_interval(mean);
+        if (first or in_record) {  // 线程第一次进来只是抽取采样间隔，否则每个线程的第一次申请都会被采到
+            return;
+        }
+        in_record = true;
+        SampleKey key{};
+        key.depth = backtrace(key.frames, MAX_DEPTH);
+        key.type = &type;
+        key.size_class = size_class;
+        // 每个样本代表的申请次数：大小为 bytes 的申请被采到的概率是 1 - exp(-bytes / mean)
+        const auto scale = 1.0 / (1.0 - std::exp(-static_cast<double>(bytes) / static_cast<double>(mean)));
+        {
+            std::lock_guard lock(samples_mutex);
+            auto &value = samples_table[key];
+            ++value.count;
+            value.bytes += bytes;
+            value.estimated_count += scale;
+            value.estimated_bytes += scale * static_cast<double>(bytes);
+            ++samples_total;
+        }
+        in_record = false;
+    }
+
+    void HeapProfiler::dump_folded(std::ostream &os) {
+        std::lock_guard lock(samples_mutex);
+        for (const auto &[key, value] : samples_table) {
+            // 第 0 帧是 record 本身，从调用者开始，折叠栈要求从最外层的调用者开始写
+            char **symbols = backtrace_symbols(key.frames, key.depth);
+            for (int i = key.depth - 1; i >= 1; --i) {
+                os << folded_safe(symbols != nullptr ? frame_name(symbols[i]) : "?") << ';';
+            }
+            free(symbols);
+            os << folded_safe(demangle(key.type->name()));
+            if (key.size_class != 0) {
+                os << "_[" << key.size_class << "B]";
+            }else {
+                os << "_[large]";
+            }
+            os << ' ' << static_cast<uint64_t>(value.estimated_bytes + 0.5) << '\n';
+        }
+    }
+
+    void HeapProfiler::dump_pprof(std::ostream &os) {
+        std::lock_guard lock(samples_mutex);
+        size_t count = 0, bytes = 0;
+        for (const auto &[key, value] : samples_table) {
+            count += value.count;
+            bytes += value.bytes;
+        }
+        // heap_v2 中的数值是采样到的原始值，pprof 按采样间隔自己还原；没有常驻量，in-use 一栏写 0
+        os << "heap profile: 0: 0 [" << count << ": " << bytes << "] @ heap_v2/" << sample_bytes() << '\n';
+        for (const auto &[key, value] : samples_table) {
+            os << "0: 0 [" << value.count << ": " << value.bytes << "] @";
+            for (int i = 1; i < key.depth; ++i) {
+                os << ' ' << key.frames[i];
+            }
+            os << '\n';
+        }
+        os << "\nMAPPED_LIBRARIES:\n";
+        std::ifstream maps("/proc/self/maps");
+        os << maps.rdbuf();
+    }
+}
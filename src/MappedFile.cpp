@@ -0,0 +1,109 @@
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "exception.h"
+
+namespace tinyWheels {
+    MappedFile::MappedFile(const char *path, const Mode mode) : writable_(mode == Mode::READ_WRITE) {
+        fd_ = writable_ ? ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644) : ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            throw exception("打开文件失败：%s，%s", path, strerror(errno));
+        }
+        struct stat status{};
+        if (fstat(fd_, &status) != 0) {
+            const auto error = errno;
+            close();
+            throw exception("获取文件大小失败：%s，%s", path, strerror(error));
+        }
+        bytes_ = static_cast<memory_size_type>(status.st_size);
+        if (bytes_ > 0) {
+            data_ = mmap(nullptr, bytes_, writable_ ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd_, 0);
+            if (data_ == MAP_FAILED) {
+                const auto error = errno;
+                data_ = nullptr;
+                close();
+                throw exception("映射文件失败：%s，%s", path, strerror(error));
+            }
+        }
+    }
+
+    MappedFile::MappedFile(MappedFile &&another) noexcept
+        : fd_(another.fd_), data_(another.data_), bytes_(another.bytes_), writable_(another.writable_) {
+        another.fd_ = -1;
+        another.data_ = nullptr;
+        another.bytes_ = 0;
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&another) noexcept {
+        if (this != &another) {
+            close();
+            fd_ = another.fd_;
+            data_ = another.data_;
+            bytes_ = another.bytes_;
+            writable_ = another.writable_;
+            another.fd_ = -1;
+            another.data_ = nullptr;
+            another.bytes_ = 0;
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+    void MappedFile::resize(const memory_size_type bytes) {
+        if (not writable_) {
+            throw exception("只读映射不能改变文件大小");
+        }
+        if (bytes == bytes_) {
+            return;
+        }
+        // 缩小时先解除多余部分的映射再截断文件，否则访问那部分会收到 SIGBUS
+        if (bytes < bytes_ and data_ != nullptr) {
+            void *remapped = bytes == 0 ? nullptr : mremap(data_, bytes_, bytes, MREMAP_MAYMOVE);
+            if (bytes == 0) {
+                munmap(data_, bytes_);
+            }else if (remapped == MAP_FAILED) {
+                throw exception("重新映射失败，%lu -> %lu 字节，%s", bytes_, bytes, strerror(errno));
+            }
+            data_ = remapped;
+            bytes_ = bytes;
+        }
+        if (ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            throw exception("调整文件大小失败，%lu 字节，%s", bytes, strerror(errno));
+        }
+        if (bytes > bytes_) {
+            void *remapped = data_ == nullptr ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0)
+                                              : mremap(data_, bytes_, bytes, MREMAP_MAYMOVE);
+            if (remapped == MAP_FAILED) {
+                throw exception("重新映射失败，%lu -> %lu 字节，%s", bytes_, bytes, strerror(errno));
+            }
+            data_ = remapped;
+            bytes_ = bytes;
+        }
+    }
+
+    void MappedFile::flush(const bool async) const {
+        if (data_ != nullptr and writable_ and msync(data_, bytes_, async ? MS_ASYNC : MS_SYNC) != 0) {
+            throw exception("写回文件失败，%s", strerror(errno));
+        }
+    }
+
+    void MappedFile::close() {
+        if (data_ != nullptr) {
+            munmap(data_, bytes_);
+            data_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        bytes_ = 0;
+    }
+}
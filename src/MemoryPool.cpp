@@ -0,0 +1,645 @@
+#include "MemoryPool.h"
+
+#include <cstdint>
+#include <cstdlib>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include <new>
+#include "exception.h"
+
+namespace tinyWheels {
+    MemoryPool::memory_content MemoryPool::free_list_head[FREE_LIST_LENGTH] = {};
+    std::atomic<ChunkProvider *> MemoryPool::chunk_provider{nullptr};
+    MemoryPool::ChunkHeader *MemoryPool::chunks = nullptr;
+    MemoryPool::ChunkHeader *MemoryPool::current_chunk = nullptr;
+    MemoryPool::memory_size_type MemoryPool::left_memory_bytes = 0;
+    MemoryPool::memory_ptr_type MemoryPool::current_memory = nullptr;
+
+    thread_local MemoryPool::ThreadCache MemoryPool::thread_cache;
+    std::mutex MemoryPool::depot_mutex;
+    MemoryPool::Magazine *MemoryPool::depot_full[FREE_LIST_LENGTH] = {nullptr};
+    MemoryPool::Magazine *MemoryPool::depot_empty[FREE_LIST_LENGTH] = {nullptr};
+
+    std::mutex MemoryPool::stats_mutex;
+    MemoryPool::ThreadCache *MemoryPool::thread_caches = nullptr;
+    MemoryPool::Statistics MemoryPool::retired_statistics;
+    size_t MemoryPool::chunk_refills = 0;
+    MemoryPool::memory_size_type MemoryPool::reserved_bytes = 0;
+    size_t MemoryPool::released_chunks = 0;
+    MemoryPool::memory_size_type MemoryPool::released_bytes = 0;
+    std::atomic<MemoryPool::memory_size_type> MemoryPool::release_watermark{0};
+    MemoryPool::Scavenger MemoryPool::scavenger;
+
+    void *MemoryPool::allocate(const memory_size_type memory_bytes) {
+        Counters::add(thread_cache.counters.allocated_bytes, round_up(memory_bytes));
+        return cache_pop(getIndex(memory_bytes));
+    }
+
+    void MemoryPool::deallocate(void *block, const memory_size_type memory_bytes) {
+        if (block == nullptr) {
+            return;
+        }
+        Counters::add(thread_cache.counters.deallocated_bytes, round_up(memory_bytes));
+        cache_push(getIndex(memory_bytes), static_cast<memory_content *>(block));
+    }
+
+    void MemoryPool::allocate_bulk(const memory_size_type memory_bytes, void **blocks, const size_t number) {
+        const auto index = getIndex(memory_bytes);
+        Counters::add(thread_cache.counters.allocated_bytes, round_up(memory_bytes) * number);
+        auto &loaded = thread_cache.loaded[index];
+        auto &previous = thread_cache.previous[index];
+        size_t count = 0;
+        const auto take = [&] {
+            while (loaded != nullptr and not loaded->empty() and count < number) {
+                blocks[count++] = loaded->blocks[--loaded->rounds];
+            }
+        };
+        // 只从 loaded 中取，取空之后 previous 是满的才整个换上来，previous 始终是满的或空的
+        take();
+        if (count < number and previous != nullptr and previous->full()) {
+            std::swap(loaded, previous);
+            take();
+        }
+        Counters::add(thread_cache.counters.hits[index], count);
+        if (count == number) {
+            return;
+        }
+        Counters::add(thread_cache.counters.misses[index], number - count);
+        std::lock_guard lock(depot_mutex);
+        while (number - count >= MAGAZINE_ROUNDS) {  // 剩下的至少一整个弹匣，直接倒空仓库中的满弹匣
+            const auto magazine = depot_pop(depot_full + index);
+            if (magazine == nullptr) {
+                break;
+            }
+            while (not magazine->empty()) {
+                blocks[count++] = magazine->blocks[--magazine->rounds];
+            }
+            depot_push(depot_empty + index, magazine);
+        }
+        central_allocate_bulk(index, blocks + count, number - count);
+    }
+
+    void MemoryPool::deallocate_bulk(void **blocks, const memory_size_type memory_bytes, size_t number) {
+        const auto index = getIndex(memory_bytes);
+        const auto memory_unit_bytes = round_up(memory_bytes);
+        Counters::add(thread_cache.counters.deallocated_bytes, memory_unit_bytes * number);
+        auto &loaded = thread_cache.loaded[index];
+        auto &previous = thread_cache.previous[index];
+        const auto put = [&] {
+            while (loaded != nullptr and not loaded->full() and number > 0) {
+                loaded->blocks[loaded->rounds++] = static_cast<memory_content *>(blocks[--number]);
+            }
+        };
+        // 只放进 loaded，装满之后 previous 是空的才整个换上来，previous 始终是满的或空的
+        put();
+        if (number > 0 and previous != nullptr and previous->empty()) {
+            std::swap(loaded, previous);
+            put();
+        }
+        if (number == 0) {
+            return;
+        }
+        std::lock_guard lock(depot_mutex);
+        while (number > 0) {
+            insert_free_list(static_cast<memory_ptr_type>(blocks[--number]), memory_unit_bytes, 1, false);
+        }
+    }
+
+    void *MemoryPool::allocate_large(const memory_size_type memory_bytes, const memory_size_type alignment) {
+        void *rst;
+        if (memory_bytes >= LARGE_CHUNK_THRESHOLD) {
+            // 头部占一个缓存行；对齐超过缓存行时头部占 alignment 字节，数据从大内存块的第 alignment 字节开始
+            // 向来源申请时只要求数据需要的对齐，malloc 来源因此可以直接 realloc
+            const auto offset = large_offset(alignment);
+            rst = reinterpret_cast<memory_ptr_type>(provide(memory_bytes + offset, large_alignment(alignment))) + offset;
+        }else {
+            rst = nullptr;
+            if (alignment <= LARGE_ALIGN) {
+                rst = malloc(memory_bytes);
+            }else if (posix_memalign(&rst, alignment, memory_bytes) != 0) {
+                rst = nullptr;
+            }
+            if (rst == nullptr) {
+                throw exception("大内存块申请失败，内存大小：%lu", memory_bytes);
+            }
+        }
+        Counters::add(thread_cache.counters.large_allocations);
+        Counters::add(thread_cache.counters.large_bytes, memory_bytes);
+        return rst;
+    }
+
+    void MemoryPool::deallocate_large(void *block, const memory_size_type memory_bytes, const memory_size_type alignment) {
+        if (memory_bytes >= LARGE_CHUNK_THRESHOLD) {
+            release(reinterpret_cast<ChunkHeader *>(static_cast<memory_ptr_type>(block) - large_offset(alignment)));
+            return;
+        }
+        free(block);
+    }
+
+    bool MemoryPool::try_expand_large(void *block, const memory_size_type memory_bytes, const memory_size_type new_bytes, const memory_size_type alignment) {
+        if (memory_bytes < LARGE_CHUNK_THRESHOLD or new_bytes < LARGE_CHUNK_THRESHOLD) {
+            return false;
+        }
+        const auto offset = large_offset(alignment);
+        const auto chunk = reinterpret_cast<ChunkHeader *>(static_cast<memory_ptr_type>(block) - offset);
+        if (new_bytes + offset > chunk->bytes) {  // 来源取整多出来的部分放不下，请来源原地扩展
+            const auto total_bytes = chunk->provider->round_up(new_bytes + offset);
+            if (not chunk->provider->expand(chunk, chunk->bytes, total_bytes)) {
+                return false;
+            }
+            chunk->bytes = total_bytes;
+        }
+        Counters::add(thread_cache.counters.large_reallocations);
+        return true;
+    }
+
+    void *MemoryPool::reallocate_large(void *block, const memory_size_type memory_bytes, const memory_size_type new_bytes, const memory_size_type alignment) {
+        void *rst = nullptr;
+        if (try_expand_large(block, memory_bytes, new_bytes, alignment)) {
+            return block;
+        }
+        if (memory_bytes >= LARGE_CHUNK_THRESHOLD and new_bytes >= LARGE_CHUNK_THRESHOLD) {
+            const auto offset = large_offset(alignment);
+            const auto chunk = reinterpret_cast<ChunkHeader *>(static_cast<memory_ptr_type>(block) - offset);
+            const auto total_bytes = chunk->provider->round_up(new_bytes + offset);
+            // 头部跟着内容一起搬过去，只需要更新大小
+            if (const auto address = chunk->provider->reallocate(chunk, chunk->bytes, total_bytes, large_alignment(alignment))) {
+                static_cast<ChunkHeader *>(address)->bytes = total_bytes;
+                rst = static_cast<memory_ptr_type>(address) + offset;
+            }
+        }else if (memory_bytes > THRESHOLD and new_bytes > THRESHOLD and memory_bytes < LARGE_CHUNK_THRESHOLD
+                  and new_bytes < LARGE_CHUNK_THRESHOLD and alignment <= LARGE_ALIGN) {  // 两边都是 malloc 的内存
+            rst = realloc(block, new_bytes);
+        }
+        if (rst != nullptr) {
+            Counters::add(thread_cache.counters.large_reallocations);
+            if (new_bytes > memory_bytes) {
+                Counters::add(thread_cache.counters.large_bytes, new_bytes - memory_bytes);
+            }
+        }
+        return rst;
+    }
+
+    void *MemoryPool::allocate_aligned(const memory_size_type memory_bytes, const memory_size_type alignment) {
+        if (alignment <= ALIGN) {
+            return memory_bytes > THRESHOLD ? allocate_large(memory_bytes) : allocate(memory_bytes);
+        }
+        if (memory_bytes + alignment > THRESHOLD) {
+            return allocate_large(memory_bytes, alignment);
+        }
+        // 内存块按 ALIGN 对齐，多申请 alignment 字节，对齐后的地址前面至少留出一个指针存放原地址
+        const auto block = static_cast<memory_ptr_type>(allocate(memory_bytes + alignment));
+        const auto rst = reinterpret_cast<memory_ptr_type>((reinterpret_cast<uintptr_t>(block) + PTR_BYTES + alignment - 1) & ~(alignment - 1));
+        reinterpret_cast<memory_ptr_type *>(rst)[-1] = block;
+        return rst;
+    }
+
+    void MemoryPool::deallocate_aligned(void *block, const memory_size_type memory_bytes, const memory_size_type alignment) {
+        if (block == nullptr) {
+            return;
+        }
+        if (alignment <= ALIGN) {
+            memory_bytes > THRESHOLD ? deallocate_large(block, memory_bytes) : deallocate(block, memory_bytes);
+        }else if (memory_bytes + alignment > THRESHOLD) {
+            deallocate_large(block, memory_bytes, alignment);
+        }else {
+            deallocate(static_cast<memory_ptr_type *>(block)[-1], memory_bytes + alignment);
+        }
+    }
+
+    void MemoryPool::set_chunk_provider(ChunkProvider *provider) {
+        chunk_provider.store(provider, std::memory_order_release);
+    }
+
+    ChunkProvider *MemoryPool::get_chunk_provider() {
+        const auto provider = chunk_provider.load(std::memory_order_acquire);
+        return provider != nullptr ? provider : &MallocChunkProvider::instance();
+    }
+
+    MemoryPool::ChunkHeader *MemoryPool::provide(const memory_size_type bytes, const memory_size_type alignment) {
+        auto provider = get_chunk_provider();
+        auto total_bytes = provider->round_up(bytes);
+        auto address = provider->allocate(total_bytes, alignment);
+        if (address == nullptr and provider != &MallocChunkProvider::instance()) {  // 回退到 malloc
+            provider = &MallocChunkProvider::instance();
+            total_bytes = bytes;
+            address = provider->allocate(total_bytes, alignment);
+        }
+        if (address == nullptr) {
+            throw exception("大内存块申请失败，内存大小：%lu", bytes);
+        }
+        return new(address) ChunkHeader{nullptr, provider, total_bytes, 0, 0, false};
+    }
+
+    void MemoryPool::release(ChunkHeader *chunk) {
+        chunk->provider->release(chunk, chunk->bytes);
+    }
+
+    void MemoryPool::Counters::collect(Statistics &stats) const {
+        for (array_index i = 0; i < FREE_LIST_LENGTH; ++i) {
+            stats.size_classes[i].hits += hits[i].load(std::memory_order_relaxed);
+            stats.size_classes[i].misses += misses[i].load(std::memory_order_relaxed);
+        }
+        stats.allocated_bytes += allocated_bytes.load(std::memory_order_relaxed);
+        stats.deallocated_bytes += deallocated_bytes.load(std::memory_order_relaxed);
+        stats.large_allocations += large_allocations.load(std::memory_order_relaxed);
+        stats.large_bytes += large_bytes.load(std::memory_order_relaxed);
+        stats.large_reallocations += large_reallocations.load(std::memory_order_relaxed);
+    }
+
+    MemoryPool::Statistics MemoryPool::statistics() {
+        Statistics stats;
+        {
+            std::lock_guard lock(stats_mutex);
+            stats = retired_statistics;
+            for (auto cache = thread_caches; cache != nullptr; cache = cache->next) {
+                cache->counters.collect(stats);
+            }
+        }
+        {
+            std::lock_guard lock(depot_mutex);
+            stats.chunk_refills = chunk_refills;
+            stats.reserved_bytes = reserved_bytes;
+            stats.released_chunks = released_chunks;
+            stats.released_bytes = released_bytes;
+        }
+        for (array_index i = 0; i < FREE_LIST_LENGTH; ++i) {
+            stats.size_classes[i].block_bytes = (i + 1) * ALIGN;
+        }
+        return stats;
+    }
+
+    std::ostream &operator<<(std::ostream &os, const MemoryPool::Statistics &stats) {
+        os << "chunk refills: " << stats.chunk_refills << ", reserved: " << stats.reserved_bytes << " bytes" << std::endl;
+        os << "released chunks: " << stats.released_chunks << ", released: " << stats.released_bytes
+           << " bytes, retained: " << stats.retained_bytes() << " bytes" << std::endl;
+        os << "allocated: " << stats.allocated_bytes << " bytes, deallocated: " << stats.deallocated_bytes
+           << " bytes, in use: " << stats.in_use_bytes() << " bytes" << std::endl;
+        os << "large allocations: " << stats.large_allocations << ", large bytes: " << stats.large_bytes
+           << ", large reallocations: " << stats.large_reallocations << std::endl;
+        for (const auto &size_class : stats.size_classes) {
+            if (size_class.hits == 0 and size_class.misses == 0) continue;
+            os << "  " << size_class.block_bytes << " bytes: hits " << size_class.hits << ", misses " << size_class.misses << std::endl;
+        }
+        return os;
+    }
+
+    void MemoryPool::depot_push(Magazine **depot, Magazine *magazine) {
+        magazine->next = depot[0];
+        depot[0] = magazine;
+    }
+
+    MemoryPool::Magazine *MemoryPool::depot_pop(Magazine **depot) {
+        auto magazine = depot[0];
+        if (magazine != nullptr) {
+            depot[0] = magazine->next;
+            magazine->next = nullptr;
+        }
+        return magazine;
+    }
+
+    MemoryPool::ThreadCache::ThreadCache() {
+        std::lock_guard lock(stats_mutex);
+        next = thread_caches;
+        if (next != nullptr) next->prev = this;
+        thread_caches = this;
+    }
+
+    // 线程退出：满弹匣与空弹匣交给仓库，半满的弹匣把内存块直接还给自由链表
+    MemoryPool::ThreadCache::~ThreadCache() {
+        {
+            std::lock_guard lock(stats_mutex);
+            counters.collect(retired_statistics);
+            if (prev != nullptr) prev->next = next;
+            else thread_caches = next;
+            if (next != nullptr) next->prev = prev;
+        }
+        std::lock_guard lock(depot_mutex);
+        for (array_index i = 0; i < FREE_LIST_LENGTH; ++i) {
+            for (auto magazine : {loaded[i], previous[i]}) {
+                if (magazine == nullptr) continue;
+                if (magazine->full()) {
+                    depot_push(depot_full + i, magazine);
+                    continue;
+                }
+                drain(magazine, i);
+                depot_push(depot_empty + i, magazine);
+            }
+            loaded[i] = previous[i] = nullptr;
+        }
+    }
+
+    // 快速路径：loaded 非空直接弹出，previous 满则交换，都不行再去仓库换一个满弹匣
+    MemoryPool::memory_content *MemoryPool::cache_pop(const array_index index) {
+        auto &loaded = thread_cache.loaded[index];
+        auto &previous = thread_cache.previous[index];
+        if (loaded != nullptr and not loaded->empty()) {
+            Counters::add(thread_cache.counters.hits[index]);
+            return loaded->blocks[--loaded->rounds];
+        }
+        if (previous != nullptr and previous->full()) {
+            Counters::add(thread_cache.counters.hits[index]);
+            std::swap(loaded, previous);
+            return loaded->blocks[--loaded->rounds];
+        }
+        Counters::add(thread_cache.counters.misses[index]);
+        // 慢速路径：previous 是空弹匣，还给仓库，loaded 降级为 previous，然后从仓库取一个满弹匣
+        std::lock_guard lock(depot_mutex);
+        if (previous != nullptr) {
+            depot_push(depot_empty + index, previous);
+        }
+        previous = loaded;
+        loaded = depot_pop(depot_full + index);
+        if (loaded == nullptr) {  // 仓库没有满弹匣，从自由链表中装填一个
+            loaded = depot_pop(depot_empty + index);
+            if (loaded == nullptr) {
+                loaded = new Magazine;
+            }
+            while (not loaded->full()) {
+                loaded->blocks[loaded->rounds++] = central_allocate(index);
+            }
+        }
+        return loaded->blocks[--loaded->rounds];
+    }
+
+    // 快速路径：loaded 未满直接压入，previous 空则交换，都不行再把满弹匣交给仓库
+    void MemoryPool::cache_push(const array_index index, memory_content *block) {
+        auto &loaded = thread_cache.loaded[index];
+        auto &previous = thread_cache.previous[index];
+        if (loaded != nullptr and not loaded->full()) {
+            loaded->blocks[loaded->rounds++] = block;
+            return;
+        }
+        if (previous != nullptr and previous->empty()) {
+            std::swap(loaded, previous);
+            loaded->blocks[loaded->rounds++] = block;
+            return;
+        }
+        // 慢速路径：previous 是满弹匣，交给仓库，loaded 降级为 previous，然后从仓库取一个空弹匣
+        {
+            std::lock_guard lock(depot_mutex);
+            if (previous != nullptr) {
+                depot_push(depot_full + index, previous);
+            }
+            previous = loaded;
+            loaded = depot_pop(depot_empty + index);
+        }
+        if (loaded == nullptr) {
+            loaded = new Magazine;
+        }
+        loaded->blocks[loaded->rounds++] = block;
+    }
+
+    // 从自由链表中取出一个内存块，自由链表为空时从大内存块中切分
+    MemoryPool::memory_content *MemoryPool::central_allocate(const array_index index) {
+        const auto memory_bytes_align = (index + 1) * ALIGN;
+        if (free_list_head[index].next != nullptr) {  // 如果有空闲块，那么直接返回一个空闲块即可
+            auto rst = free_list_head[index].next;
+            free_list_head[index].next = rst->next;
+            chunk_of(rst)->free_bytes -= memory_bytes_align;
+            return rst;
+        }
+
+        // 如果自由链表中没有空闲块，那么就申请大内存块中的空闲块
+        if (const auto threshold_bytes = memory_bytes_align / 2 * BLOCK_NUMBER; left_memory_bytes >= threshold_bytes) {
+            // 剩余内存还很多，一次性申请 BLOCK_NUMBER / 2 个内存块
+            insert_free_list(current_memory, memory_bytes_align, BLOCK_NUMBER / 2, true);
+            return central_allocate(index);
+        }
+        if (left_memory_bytes >= memory_bytes_align) {
+            // 剩余内存还可以申请一个内存块
+            insert_free_list(current_memory, memory_bytes_align, 1, true);
+            return central_allocate(index);
+        }
+        chunk_memory();
+        return central_allocate(index);
+    }
+
+    // 先取自由链表，不够时直接从当前大内存块中连续切分，切出去的内存块不经过自由链表
+    void MemoryPool::central_allocate_bulk(const array_index index, void **blocks, const size_t number) {
+        const auto memory_bytes_align = (index + 1) * ALIGN;
+        size_t count = 0;
+        while (count < number and free_list_head[index].next != nullptr) {
+            const auto block = free_list_head[index].next;
+            free_list_head[index].next = block->next;
+            chunk_of(block)->free_bytes -= memory_bytes_align;
+            blocks[count++] = block;
+        }
+        while (count < number) {
+            if (left_memory_bytes < memory_bytes_align) {
+                chunk_memory();
+            }
+            auto carve = left_memory_bytes / memory_bytes_align;
+            carve = carve < number - count ? carve : number - count;
+            for (size_t i = 0; i < carve; ++i) {
+                blocks[count++] = current_memory + i * memory_bytes_align;
+            }
+            current_chunk->carved_bytes += carve * memory_bytes_align;
+            current_memory += carve * memory_bytes_align;
+            left_memory_bytes -= carve * memory_bytes_align;
+        }
+    }
+
+    void MemoryPool::drain(Magazine *magazine, const array_index index) {
+        const auto memory_unit_bytes = (index + 1) * ALIGN;
+        while (not magazine->empty()) {
+            insert_free_list(reinterpret_cast<memory_ptr_type>(magazine->blocks[--magazine->rounds]), memory_unit_bytes, 1, false);
+        }
+    }
+
+    // 申请一个 CHUNK_BYTES 字节、按 CHUNK_BYTES 对齐的大内存块，并且加入到之前的链表中
+    void MemoryPool::chunk_memory() {
+        const auto chunk = provide(CHUNK_BYTES, CHUNK_BYTES);
+        if (reinterpret_cast<uintptr_t>(chunk) & (CHUNK_BYTES - 1)) {
+            release(chunk);
+            throw exception("大内存块没有按 %lu 字节对齐", CHUNK_BYTES);
+        }
+        chunk->next = chunks;
+        chunks = chunk;
+        ++chunk_refills;
+        reserved_bytes += chunk->bytes;
+
+        // 当前段内存资源还有剩余内存可以使用，从大到小依次分配内存块
+        // 计算剩余内存分配策略，从 left_memory_bytes / 2 开始，每次分配一半的内存
+        const auto cur_memory_unit = round_up(left_memory_bytes / 2);  // 分配当前内存块大小，一定是 ALIGN 的倍数
+
+        // 剩余内存是旧大内存块的尾部，必须从 current_memory 开始切分，否则会与新大内存块中的内存块重叠
+        for (auto i = getIndex(cur_memory_unit) + 1; i > 0 and left_memory_bytes > 0;) {
+            const auto memory_unit_bytes = i * ALIGN;
+            if (left_memory_bytes < memory_unit_bytes) {
+                --i;
+                continue;
+            }
+            insert_free_list(current_memory, memory_unit_bytes, 1, true);
+        }
+        current_chunk = chunk;
+        current_memory = reinterpret_cast<memory_ptr_type>(chunk) + CHUNK_HEADER_BYTES;  // 更新当前可申请的内存块起始地址
+        // 来源给得更多也只用前 CHUNK_BYTES 字节，否则后面的内存块无法通过地址找到头部
+        left_memory_bytes = CHUNK_BYTES - CHUNK_HEADER_BYTES;
+    }
+
+    void MemoryPool::insert_free_list(const memory_ptr_type start_address, const memory_size_type memory_unit_bytes, const block_number block, const bool update) {
+        if (start_address == nullptr or memory_unit_bytes == 0 or block == 0) {
+            return;
+        }
+        auto index = memory_unit_bytes / ALIGN - 1;
+        auto& fl = free_list_head[index];
+        auto last = fl.next;
+        auto prev = &fl;
+        for (block_number i = 0; i < block; ++i, prev = prev->next) {
+            auto cur = reinterpret_cast<memory_content *>(start_address + i * memory_unit_bytes);
+            *cur = memory_content{last};
+            prev->next = cur;
+        }
+        // 一次插入的内存块总是来自同一个大内存块
+        const auto chunk = chunk_of(start_address);
+        chunk->free_bytes += block * memory_unit_bytes;
+        if (update) {
+            chunk->carved_bytes += block * memory_unit_bytes;
+            current_memory += block * memory_unit_bytes;
+            left_memory_bytes -= block * memory_unit_bytes;
+        }
+    }
+
+    MemoryPool::memory_size_type MemoryPool::trim(const memory_size_type keep_bytes) {
+        std::lock_guard lock(depot_mutex);
+        // 本线程缓存与仓库中的弹匣全部倒回自由链表，它们持有的内存块不再占着所在的大内存块
+        for (array_index i = 0; i < FREE_LIST_LENGTH; ++i) {
+            for (auto &magazine : {&thread_cache.loaded[i], &thread_cache.previous[i]}) {
+                if (*magazine == nullptr) continue;
+                drain(*magazine, i);
+                delete *magazine;
+                *magazine = nullptr;
+            }
+            while (auto magazine = depot_pop(depot_full + i)) {
+                drain(magazine, i);
+                delete magazine;
+            }
+            // 空弹匣仓库中也可能有没倒空的弹匣，与线程缓存的析构一样先倒回自由链表，否则其中的内存块就丢了
+            while (auto magazine = depot_pop(depot_empty + i)) {
+                if (not magazine->empty()) drain(magazine, i);
+                delete magazine;
+            }
+        }
+
+        // 找出完全空闲的大内存块，保留 keep_bytes 字节，其余的从链表中摘下
+        ChunkHeader *releasing = nullptr;
+        memory_size_type kept_bytes = 0;
+        for (auto link = &chunks; *link != nullptr;) {
+            const auto chunk = *link;
+            const auto empty = chunk != current_chunk and chunk->free_bytes == chunk->carved_bytes;
+            if (empty and kept_bytes + chunk->bytes > keep_bytes) {
+                *link = chunk->next;
+                chunk->releasing = true;
+                chunk->next = releasing;
+                releasing = chunk;
+                continue;
+            }
+            if (empty) kept_bytes += chunk->bytes;
+            link = &chunk->next;
+        }
+        if (releasing == nullptr) {
+            return 0;
+        }
+
+        // 自由链表中属于这些大内存块的内存块全部摘掉
+        for (auto &head : free_list_head) {
+            for (auto prev = &head; prev->next != nullptr;) {
+                if (chunk_of(prev->next)->releasing) prev->next = prev->next->next;
+                else prev = prev->next;
+            }
+        }
+
+        // 还给来源：MmapChunkProvider 直接 munmap，MallocChunkProvider 先 madvise(MADV_DONTNEED) 再 free
+        memory_size_type bytes = 0;
+        while (releasing != nullptr) {
+            const auto next = releasing->next;
+            bytes += releasing->bytes;
+            ++released_chunks;
+            release(releasing);
+            releasing = next;
+        }
+        released_bytes += bytes;
+#ifdef __GLIBC__
+        malloc_trim(0);  // 仓库中弹匣本身是 new 出来的，删除后也让 glibc 把空闲的堆内存还回去
+#endif
+        return bytes;
+    }
+
+    MemoryPool::memory_size_type MemoryPool::trim() {
+        return trim(get_release_watermark());
+    }
+
+    void MemoryPool::set_release_watermark(const memory_size_type bytes) {
+        release_watermark.store(bytes, std::memory_order_relaxed);
+    }
+
+    MemoryPool::memory_size_type MemoryPool::get_release_watermark() {
+        return release_watermark.load(std::memory_order_relaxed);
+    }
+
+    void MemoryPool::start_scavenger(const std::chrono::milliseconds interval) {
+        std::lock_guard control(scavenger.control);
+        std::lock_guard lock(scavenger.mutex);
+        scavenger.interval = interval;
+        if (scavenger.running) {
+            scavenger.cv.notify_one();
+            return;
+        }
+        scavenger.running = true;
+        scavenger.thread = std::thread(&Scavenger::run, &scavenger);
+    }
+
+    void MemoryPool::stop_scavenger() {
+        scavenger.stop();
+    }
+
+    void MemoryPool::Scavenger::run() {
+        std::unique_lock lock(mutex);
+        while (running) {
+            if (cv.wait_for(lock, interval, [this] {return not running;})) {
+                break;
+            }
+            lock.unlock();
+            trim();
+            lock.lock();
+        }
+    }
+
+    void MemoryPool::Scavenger::stop() {
+        std::lock_guard guard(control);
+        {
+            std::lock_guard lock(mutex);
+            running = false;
+        }
+        cv.notify_one();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    void MemoryPool::destroy_all() {
+        std::lock_guard lock(depot_mutex);
+        for (array_index i = 0; i < FREE_LIST_LENGTH; ++i) {
+            delete thread_cache.loaded[i];
+            delete thread_cache.previous[i];
+            thread_cache.loaded[i] = thread_cache.previous[i] = nullptr;
+            while (auto magazine = depot_pop(depot_full + i)) delete magazine;
+            // 空弹匣仓库中也可能有没倒空的弹匣，与线程缓存的析构一样先倒回自由链表，否则其中的内存块就丢了
+            while (auto magazine = depot_pop(depot_empty + i)) {
+                if (not magazine->empty()) drain(magazine, i);
+                delete magazine;
+            }
+            free_list_head[i] = memory_content{nullptr};
+        }
+        while (chunks != nullptr) {  // 沿着头部中的指针释放所有大内存块
+            const auto next = chunks->next;
+            release(chunks);
+            chunks = next;
+        }
+        left_memory_bytes = 0;
+        current_memory = nullptr;
+        current_chunk = nullptr;
+    }
+}
@@ -0,0 +1,167 @@
+#include "memory_resource.h"
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <new>
+
+namespace tinyWheels {
+    // ------------------------------ pool_memory_resource ------------------------------
+    pool_memory_resource &pool_memory_resource::instance() {
+        static pool_memory_resource resource;
+        return resource;
+    }
+
+    // 对齐要求超过内存池 ALIGN 的内存由 MemoryPool::allocate_aligned 处理
+    void *pool_memory_resource::do_allocate(const memory_size_type bytes, const memory_size_type alignment) {
+        return MemoryPool::allocate_aligned(bytes, alignment);
+    }
+
+    void pool_memory_resource::do_deallocate(void *address, const memory_size_type bytes, const memory_size_type alignment) {
+        MemoryPool::deallocate_aligned(address, bytes, alignment);
+    }
+
+    static std::atomic<memory_resource *> default_resource{nullptr};
+
+    memory_resource *get_default_resource() noexcept {
+        const auto resource = default_resource.load(std::memory_order_acquire);
+        return resource != nullptr ? resource : &pool_memory_resource::instance();
+    }
+
+    memory_resource *set_default_resource(memory_resource *resource) noexcept {
+        const auto previous = default_resource.exchange(resource, std::memory_order_acq_rel);
+        return previous != nullptr ? previous : &pool_memory_resource::instance();
+    }
+
+    // ------------------------------ monotonic_buffer_resource ------------------------------
+    monotonic_buffer_resource::monotonic_buffer_resource(memory_resource *upstream)
+        : monotonic_buffer_resource(INITIAL_BYTES, upstream) {}
+
+    monotonic_buffer_resource::monotonic_buffer_resource(const memory_size_type initial_bytes, memory_resource *upstream)
+        : upstream_(upstream != nullptr ? upstream : get_default_resource()),
+          next_bytes_(initial_bytes != 0 ? initial_bytes : INITIAL_BYTES) {}
+
+    monotonic_buffer_resource::monotonic_buffer_resource(void *buffer, const memory_size_type bytes, memory_resource *upstream)
+        : upstream_(upstream != nullptr ? upstream : get_default_resource()),
+          initial_buffer_(buffer), initial_bytes_(bytes),
+          next_bytes_(bytes != 0 ? 2 * bytes : INITIAL_BYTES),
+          current_(static_cast<char *>(buffer)), left_bytes_(bytes) {}
+
+    // 上游缓冲区逐个归还；下一次申请的大小改为这一轮最大的缓冲区，下一轮请求可以直接拿到一块足够大的缓冲区，
+    // 又不会随着请求的轮数一直翻倍下去
+    void monotonic_buffer_resource::release() {
+        if (buffers_ != nullptr) {
+            next_bytes_ = buffers_->bytes;  // 链表头是最后申请的，也是最大的
+        }
+        while (buffers_ != nullptr) {
+            const auto next = buffers_->next;
+            upstream_->deallocate(buffers_, buffers_->bytes, DEFAULT_ALIGNMENT);
+            buffers_ = next;
+        }
+        current_ = static_cast<char *>(initial_buffer_);
+        left_bytes_ = initial_bytes_;
+    }
+
+    void *monotonic_buffer_resource::do_allocate(const memory_size_type bytes, const memory_size_type alignment) {
+        auto align = [alignment](char *address) {
+            return (reinterpret_cast<uintptr_t>(address) + alignment - 1) & ~(alignment - 1);
+        };
+        auto padding = current_ == nullptr ? 0 : align(current_) - reinterpret_cast<uintptr_t>(current_);
+        if (current_ == nullptr or padding + bytes > left_bytes_) {  // 当前缓冲区不够，向上游申请一块更大的
+            auto total_bytes = next_bytes_;
+            if (total_bytes < bytes + alignment + BUFFER_HEADER_BYTES) {
+                total_bytes = bytes + alignment + BUFFER_HEADER_BYTES;
+            }
+            const auto buffer = new(upstream_->allocate(total_bytes, DEFAULT_ALIGNMENT)) Buffer{buffers_, total_bytes};
+            buffers_ = buffer;
+            next_bytes_ = 2 * total_bytes;
+            current_ = reinterpret_cast<char *>(buffer) + BUFFER_HEADER_BYTES;
+            left_bytes_ = total_bytes - BUFFER_HEADER_BYTES;
+            padding = align(current_) - reinterpret_cast<uintptr_t>(current_);
+        }
+        const auto rst = current_ + padding;
+        current_ = rst + bytes;
+        left_bytes_ -= padding + bytes;
+        return rst;
+    }
+
+    // ------------------------------ synchronized_pool_resource ------------------------------
+    synchronized_pool_resource::synchronized_pool_resource(memory_resource *upstream)
+        : upstream_(upstream != nullptr ? upstream : get_default_resource()) {}
+
+    // 8 字节 -> 0，16 字节 -> 1，……，4096 字节 -> 9
+    size_t synchronized_pool_resource::pool_index(memory_size_type bytes) {
+        bytes = bytes < SMALLEST_BLOCK ? SMALLEST_BLOCK : bytes;
+        return std::bit_width(bytes - 1) - std::bit_width(SMALLEST_BLOCK - 1);
+    }
+
+    synchronized_pool_resource::Chunk *synchronized_pool_resource::upstream_allocate(const memory_size_type bytes, const memory_size_type alignment, Chunk *&list) {
+        const auto chunk = new(upstream_->allocate(bytes, alignment)) Chunk{nullptr, list, bytes, alignment};
+        if (list != nullptr) list->prev = chunk;
+        list = chunk;
+        return chunk;
+    }
+
+    void synchronized_pool_resource::upstream_deallocate(Chunk *chunk, Chunk *&list) {
+        if (chunk->prev != nullptr) chunk->prev->next = chunk->next;
+        else list = chunk->next;
+        if (chunk->next != nullptr) chunk->next->prev = chunk->prev;
+        upstream_->deallocate(chunk, chunk->bytes, chunk->alignment);
+    }
+
+    void *synchronized_pool_resource::do_allocate(const memory_size_type bytes, const memory_size_type alignment) {
+        std::lock_guard lock(mutex_);
+        if (bytes > LARGEST_BLOCK or alignment > DEFAULT_ALIGNMENT) {  // 超大内存块，头部之后按 alignment 对齐
+            const auto offset = alignment > CHUNK_HEADER_BYTES ? alignment : CHUNK_HEADER_BYTES;
+            const auto chunk = upstream_allocate(bytes + offset, alignment > DEFAULT_ALIGNMENT ? alignment : DEFAULT_ALIGNMENT, large_);
+            return reinterpret_cast<char *>(chunk) + offset;
+        }
+        // 内存块大小是 2 的幂并且不小于 alignment，从按 DEFAULT_ALIGNMENT 对齐的位置开始切分，自然满足对齐
+        const auto index = pool_index(bytes > alignment ? bytes : alignment);
+        auto &pool = pools_[index];
+        if (pool.free_list == nullptr) {
+            const auto block_bytes = SMALLEST_BLOCK << index;
+            const auto chunk = upstream_allocate(CHUNK_HEADER_BYTES + pool.blocks_per_chunk * block_bytes, DEFAULT_ALIGNMENT, chunks_);
+            const auto start = reinterpret_cast<char *>(chunk) + CHUNK_HEADER_BYTES;
+            for (size_t i = pool.blocks_per_chunk; i > 0; --i) {
+                const auto block = reinterpret_cast<Block *>(start + (i - 1) * block_bytes);
+                block->next = pool.free_list;
+                pool.free_list = block;
+            }
+            if (pool.blocks_per_chunk < MAX_BLOCKS_PER_CHUNK) {
+                pool.blocks_per_chunk *= 2;
+            }
+        }
+        const auto block = pool.free_list;
+        pool.free_list = block->next;
+        return block;
+    }
+
+    void synchronized_pool_resource::do_deallocate(void *address, const memory_size_type bytes, const memory_size_type alignment) {
+        std::lock_guard lock(mutex_);
+        if (bytes > LARGEST_BLOCK or alignment > DEFAULT_ALIGNMENT) {
+            const auto offset = alignment > CHUNK_HEADER_BYTES ? alignment : CHUNK_HEADER_BYTES;
+            upstream_deallocate(reinterpret_cast<Chunk *>(static_cast<char *>(address) - offset), large_);
+            return;
+        }
+        auto &pool = pools_[pool_index(bytes > alignment ? bytes : alignment)];
+        const auto block = static_cast<Block *>(address);
+        block->next = pool.free_list;
+        pool.free_list = block;
+    }
+
+    void synchronized_pool_resource::release_all(Chunk *&list) {
+        while (list != nullptr) {
+            upstream_deallocate(list, list);
+        }
+    }
+
+    void synchronized_pool_resource::release() {
+        std::lock_guard lock(mutex_);
+        release_all(chunks_);
+        release_all(large_);
+        for (auto &pool : pools_) {
+            pool = Pool{};
+        }
+    }
+}
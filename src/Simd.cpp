@@ -0,0 +1,499 @@
+#include "simd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TINYWHEELS_SIMD_X86 1
+#endif
+
+// 辅助函数按值返回 32 字节的向量，但都是 always_inline，不存在跨函数的调用约定，关闭这条 ABI 提示
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace tinyWheels::simd {
+    namespace {
+        // GCC 的向量扩展：同一份内核按 16 字节实例化就是 SSE2（或其他平台的 128 位向量），按 32 字节实例化并且
+        // 内联到 target("avx2") 的函数中就是 AVX2；内核都是 always_inline，不会以默认目标单独生成 32 字节的版本
+        template<class T, size_t Bytes>
+        struct Vector {
+            typedef T type __attribute__((vector_size(Bytes)));
+        };
+        template<class T, size_t Bytes>
+        using vector_t = typename Vector<T, Bytes>::type;
+
+        template<class V, class T>
+        [[gnu::always_inline]] inline V load(const T *data) {
+            V rst;
+            std::memcpy(&rst, data, sizeof(V));  // 不要求对齐
+            return rst;
+        }
+
+        template<class V, class T>
+        [[gnu::always_inline]] inline V broadcast(const T value) {
+            return V{} + value;
+        }
+
+        // 比较结果的每个通道是 0 或者 -1，按 64 位整数合并之后判断是否有通道为真
+        template<class M>
+        [[gnu::always_inline]] inline bool any(const M &mask) {
+            const auto bits = (vector_t<uint64_t, sizeof(M)>) mask;
+            uint64_t rst = 0;
+            for (size_t i = 0; i < sizeof(M) / sizeof(uint64_t); ++i) {
+                rst |= bits[i];
+            }
+            return rst != 0;
+        }
+
+        template<size_t Bytes, class T>
+        [[gnu::always_inline]] inline size_t find_kernel(const T *data, const size_t n, const T value) {
+            using V = vector_t<T, Bytes>;
+            constexpr size_t LANES = Bytes / sizeof(T);
+            const auto key = broadcast<V>(value);
+            size_t i = 0;
+            // 一次比较 4 个向量，合并之后只判断一次；命中之后从这一组的开头逐个找
+            for (; i + 4 * LANES <= n; i += 4 * LANES) {
+                const auto mask = (load<V>(data + i) == key) | (load<V>(data + i + LANES) == key)
+                                  | (load<V>(data + i + 2 * LANES) == key) | (load<V>(data + i + 3 * LANES) == key);
+                if (any(mask)) {
+                    break;
+                }
+            }
+            for (; i < n; ++i) {
+                if (data[i] == value) {
+                    return i;
+                }
+            }
+            return n;
+        }
+
+        template<size_t Bytes, class T>
+        [[gnu::always_inline]] inline size_t count_kernel(const T *data, const size_t n, const T value) {
+            using V = vector_t<T, Bytes>;
+            using M = decltype(V{} == V{});
+            constexpr size_t LANES = Bytes / sizeof(T);
+            // 每个通道用与元素同宽的有符号整数计数，快到上限时汇总一次
+            constexpr size_t FLUSH = sizeof(T) == 1 ? 127 : sizeof(T) == 2 ? 32767 : size_t(1) << 30;
+            const auto key = broadcast<V>(value);
+            size_t total = 0, i = 0;
+            while (i + LANES <= n) {
+                M counter{};
+                const auto blocks = std::min((n - i) / LANES, FLUSH);
+                for (size_t block = 0; block < blocks; ++block, i += LANES) {
+                    counter -= load<V>(data + i) == key;  // 相等的通道是 -1
+                }
+                for (size_t lane = 0; lane < LANES; ++lane) {
+                    total += static_cast<size_t>(counter[lane]);
+                }
+            }
+            for (; i < n; ++i) {
+                total += data[i] == value;
+            }
+            return total;
+        }
+
+        // 两路最小值、最大值；与 data[0] 比较的是 x < m，NaN 永远不会替换已有的值
+        template<size_t Bytes, bool Min, bool Max, class T>
+        [[gnu::always_inline]] inline std::pair<T, T> extrema_kernel(const T *data, const size_t n) {
+            using V = vector_t<T, Bytes>;
+            constexpr size_t LANES = Bytes / sizeof(T);
+            auto low0 = broadcast<V>(data[0]), low1 = low0, high0 = low0, high1 = low0;
+            size_t i = 0;
+            for (; i + 2 * LANES <= n; i += 2 * LANES) {
+                const auto x = load<V>(data + i), y = load<V>(data + i + LANES);
+                if constexpr (Min) {
+                    low0 = x < low0 ? x : low0;
+                    low1 = y < low1 ? y : low1;
+                }
+                if constexpr (Max) {
+                    high0 = high0 < x ? x : high0;
+                    high1 = high1 < y ? y : high1;
+                }
+            }
+            T low = data[0], high = data[0];
+            for (size_t lane = 0; lane < LANES; ++lane) {
+                low = low0[lane] < low ? low0[lane] : low;
+                low = low1[lane] < low ? low1[lane] : low;
+                high = high < high0[lane] ? high0[lane] : high;
+                high = high < high1[lane] ? high1[lane] : high;
+            }
+            for (; i < n; ++i) {
+                low = data[i] < low ? data[i] : low;
+                high = high < data[i] ? data[i] : high;
+            }
+            return {low, high};
+        }
+
+        // 整数在无符号 64 位中累加，溢出按 2^64 取模，最后再转换成 sum_type_t
+        template<class T>
+        using accumulator_t = std::conditional_t<std::is_floating_point_v<T>, T, uint64_t>;
+
+        template<size_t Bytes, class T>
+        [[gnu::always_inline]] inline sum_type_t<T> sum_kernel(const T *data, const size_t n) {
+            size_t i = 0;
+            accumulator_t<T> total = 0;
+            if constexpr (std::is_floating_point_v<T>) {
+                using V = vector_t<T, Bytes>;
+                constexpr size_t LANES = Bytes / sizeof(T);
+                V sum0{}, sum1{};
+                for (; i + 2 * LANES <= n; i += 2 * LANES) {
+                    sum0 += load<V>(data + i);
+                    sum1 += load<V>(data + i + LANES);
+                }
+                sum0 += sum1;
+                for (size_t lane = 0; lane < LANES; ++lane) {
+                    total += sum0[lane];
+                }
+            }else if constexpr (sizeof(T) <= 2) {
+                // 8、16 位整数扩展到 32 位通道累加，2^15 次之后才可能溢出，到时汇总到 64 位
+                using W = std::conditional_t<std::is_signed_v<T>, int32_t, uint32_t>;
+                constexpr size_t LANES = Bytes / sizeof(W);
+                using V = vector_t<T, LANES * sizeof(T)>;
+                using WV = vector_t<W, Bytes>;
+                constexpr size_t FLUSH = size_t(1) << 15;
+                while (i + LANES <= n) {
+                    WV sum{};
+                    const auto blocks = std::min((n - i) / LANES, FLUSH);
+                    for (size_t block = 0; block < blocks; ++block, i += LANES) {
+                        sum += __builtin_convertvector(load<V>(data + i), WV);
+                    }
+                    for (size_t lane = 0; lane < LANES; ++lane) {
+                        total += sum[lane];
+                    }
+                }
+            }else {
+                // 32、64 位整数转换（符号扩展）到无符号 64 位通道
+                constexpr size_t LANES = Bytes / sizeof(uint64_t);
+                using V = vector_t<T, LANES * sizeof(T)>;
+                using UV = vector_t<uint64_t, Bytes>;
+                UV sum{};
+                for (; i + LANES <= n; i += LANES) {
+                    sum += __builtin_convertvector(load<V>(data + i), UV);
+                }
+                for (size_t lane = 0; lane < LANES; ++lane) {
+                    total += sum[lane];
+                }
+            }
+            for (; i < n; ++i) {
+                total += static_cast<accumulator_t<T>>(data[i]);
+            }
+            return static_cast<sum_type_t<T>>(total);
+        }
+
+        template<size_t Bytes, class T>
+        [[gnu::always_inline]] inline sum_type_t<T> dot_kernel(const T *a, const T *b, const size_t n) {
+            size_t i = 0;
+            accumulator_t<T> total = 0;
+            if constexpr (std::is_floating_point_v<T>) {
+                using V = vector_t<T, Bytes>;
+                constexpr size_t LANES = Bytes / sizeof(T);
+                V sum0{}, sum1{};
+                for (; i + 2 * LANES <= n; i += 2 * LANES) {
+                    sum0 += load<V>(a + i) * load<V>(b + i);
+                    sum1 += load<V>(a + i + LANES) * load<V>(b + i + LANES);
+                }
+                sum0 += sum1;
+                for (size_t lane = 0; lane < LANES; ++lane) {
+                    total += sum0[lane];
+                }
+            }else {
+                // 整数扩展到无符号 64 位通道再相乘，与逐个在 64 位中相乘累加的结果相同
+                constexpr size_t LANES = Bytes / sizeof(uint64_t);
+                using V = vector_t<T, LANES * sizeof(T)>;
+                using UV = vector_t<uint64_t, Bytes>;
+                UV sum{};
+                for (; i + LANES <= n; i += LANES) {
+                    sum += __builtin_convertvector(load<V>(a + i), UV) * __builtin_convertvector(load<V>(b + i), UV);
+                }
+                for (size_t lane = 0; lane < LANES; ++lane) {
+                    total += sum[lane];
+                }
+            }
+            for (; i < n; ++i) {
+                total += static_cast<accumulator_t<T>>(a[i]) * static_cast<accumulator_t<T>>(b[i]);
+            }
+            return static_cast<sum_type_t<T>>(total);
+        }
+
+        template<bit_op Op, class V>
+        [[gnu::always_inline]] inline V apply(const V &a, const V &b) {
+            if constexpr (Op == bit_op::AND) {
+                return a & b;
+            }else if constexpr (Op == bit_op::OR) {
+                return a | b;
+            }else if constexpr (Op == bit_op::XOR) {
+                return a ^ b;
+            }else {
+                return a & ~b;
+            }
+        }
+
+        template<size_t Bytes, bit_op Op>
+        [[gnu::always_inline]] inline void bitwise_kernel(uint64_t *dst, const uint64_t *src, const size_t n) {
+            using V = vector_t<uint64_t, Bytes>;
+            constexpr size_t LANES = Bytes / sizeof(uint64_t);
+            size_t i = 0;
+            for (; i + LANES <= n; i += LANES) {
+                const auto rst = apply<Op>(load<V>(dst + i), load<V>(src + i));
+                std::memcpy(dst + i, &rst, sizeof(V));
+            }
+            for (; i < n; ++i) {
+                dst[i] = apply<Op>(dst[i], src[i]);
+            }
+        }
+
+        template<size_t Bytes>
+        [[gnu::always_inline]] inline void bitwise_dispatch(const bit_op op, uint64_t *dst, const uint64_t *src, const size_t n) {
+            switch (op) {
+                case bit_op::AND: bitwise_kernel<Bytes, bit_op::AND>(dst, src, n); break;
+                case bit_op::OR: bitwise_kernel<Bytes, bit_op::OR>(dst, src, n); break;
+                case bit_op::XOR: bitwise_kernel<Bytes, bit_op::XOR>(dst, src, n); break;
+                case bit_op::ANDNOT: bitwise_kernel<Bytes, bit_op::ANDNOT>(dst, src, n); break;
+            }
+        }
+
+        // 没有 popcnt 指令时的并行位计数：每个字节先算出自己的 1 的个数，按字节累加最多 31 次（不超过 248），
+        // 再把每个 64 位通道中的 8 个字节加起来
+        template<size_t Bytes>
+        [[gnu::always_inline]] inline size_t popcount_kernel(const uint64_t *words, const size_t n) {
+            using V = vector_t<uint64_t, Bytes>;
+            constexpr size_t LANES = Bytes / sizeof(uint64_t);
+            const auto m1 = broadcast<V>(0x5555555555555555ULL), m2 = broadcast<V>(0x3333333333333333ULL);
+            const auto m4 = broadcast<V>(0x0f0f0f0f0f0f0f0fULL), m8 = broadcast<V>(0x00ff00ff00ff00ffULL);
+            const auto m16 = broadcast<V>(0x0000ffff0000ffffULL), m32 = broadcast<V>(0x00000000ffffffffULL);
+            size_t total = 0, i = 0;
+            while (i + LANES <= n) {
+                V bytes{};
+                const auto blocks = std::min<size_t>((n - i) / LANES, 31);
+                for (size_t block = 0; block < blocks; ++block, i += LANES) {
+                    auto x = load<V>(words + i);
+                    x = x - ((x >> 1) & m1);
+                    x = (x & m2) + ((x >> 2) & m2);
+                    bytes += (x + (x >> 4)) & m4;
+                }
+                bytes = (bytes & m8) + ((bytes >> 8) & m8);
+                bytes = (bytes & m16) + ((bytes >> 16) & m16);
+                bytes = (bytes & m32) + (bytes >> 32);
+                for (size_t lane = 0; lane < LANES; ++lane) {
+                    total += bytes[lane];
+                }
+            }
+            for (; i < n; ++i) {
+                total += __builtin_popcountll(words[i]);
+            }
+            return total;
+        }
+
+        template<size_t Bytes>
+        [[gnu::always_inline]] inline size_t find_nonzero_kernel(const uint64_t *words, const size_t n) {
+            using V = vector_t<uint64_t, Bytes>;
+            constexpr size_t LANES = Bytes / sizeof(uint64_t);
+            size_t i = 0;
+            for (; i + 4 * LANES <= n; i += 4 * LANES) {
+                const auto merged = load<V>(words + i) | load<V>(words + i + LANES)
+                                    | load<V>(words + i + 2 * LANES) | load<V>(words + i + 3 * LANES);
+                if (any(merged)) {
+                    break;
+                }
+            }
+            for (; i < n; ++i) {
+                if (words[i] != 0) {
+                    return i;
+                }
+            }
+            return n;
+        }
+
+#ifdef TINYWHEELS_SIMD_X86
+        // 逐字 popcnt，四路累加，避免每次都等上一次加法
+        [[gnu::target("popcnt")]] size_t popcount_popcnt(const uint64_t *words, const size_t n) {
+            size_t c0 = 0, c1 = 0, c2 = 0, c3 = 0, i = 0;
+            for (; i + 4 <= n; i += 4) {
+                c0 += __builtin_popcountll(words[i]);
+                c1 += __builtin_popcountll(words[i + 1]);
+                c2 += __builtin_popcountll(words[i + 2]);
+                c3 += __builtin_popcountll(words[i + 3]);
+            }
+            for (; i < n; ++i) {
+                c0 += __builtin_popcountll(words[i]);
+            }
+            return c0 + c1 + c2 + c3;
+        }
+
+        bool popcnt_supported() {
+            static const bool supported = [] {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("popcnt");
+            }();
+            return supported;
+        }
+
+        // 32 字节的内核在这里内联，按 AVX2 生成代码
+        template<class T>
+        [[gnu::target("avx2,fma")]] size_t find_avx2(const T *data, const size_t n, const T value) {
+            return find_kernel<32>(data, n, value);
+        }
+        template<class T>
+        [[gnu::target("avx2,fma")]] size_t count_avx2(const T *data, const size_t n, const T value) {
+            return count_kernel<32>(data, n, value);
+        }
+        template<bool Min, bool Max, class T>
+        [[gnu::target("avx2,fma")]] std::pair<T, T> extrema_avx2(const T *data, const size_t n) {
+            return extrema_kernel<32, Min, Max>(data, n);
+        }
+        template<class T>
+        [[gnu::target("avx2,fma")]] sum_type_t<T> sum_avx2(const T *data, const size_t n) {
+            return sum_kernel<32>(data, n);
+        }
+        template<class T>
+        [[gnu::target("avx2,fma")]] sum_type_t<T> dot_avx2(const T *a, const T *b, const size_t n) {
+            return dot_kernel<32>(a, b, n);
+        }
+        [[gnu::target("avx2,fma")]] void bitwise_avx2(const bit_op op, uint64_t *dst, const uint64_t *src, const size_t n) {
+            bitwise_dispatch<32>(op, dst, src, n);
+        }
+        [[gnu::target("avx2,fma")]] size_t find_nonzero_avx2(const uint64_t *words, const size_t n) {
+            return find_nonzero_kernel<32>(words, n);
+        }
+#endif
+
+        std::atomic<bool> use_avx2{avx2_supported()};
+
+        template<bool Min, bool Max, class T>
+        std::pair<T, T> extrema(const T *data, const size_t n) {
+#ifdef TINYWHEELS_SIMD_X86
+            if (use_avx2.load(std::memory_order_relaxed)) {
+                return extrema_avx2<Min, Max>(data, n);
+            }
+#endif
+            return extrema_kernel<16, Min, Max>(data, n);
+        }
+    }
+
+    bool avx2_supported() {
+#ifdef TINYWHEELS_SIMD_X86
+        static const bool supported = [] {
+            __builtin_cpu_init();  // 可能在其他全局对象的构造函数中第一次调用
+            return __builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma");
+        }();
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+    bool avx2_enabled() {
+        return use_avx2.load(std::memory_order_relaxed);
+    }
+
+    void enable_avx2(const bool enable) {
+        use_avx2.store(enable and avx2_supported(), std::memory_order_relaxed);
+    }
+
+    template<simd_arithmetic T>
+    size_t find(const T *data, const size_t n, const T value) {
+#ifdef TINYWHEELS_SIMD_X86
+        if (use_avx2.load(std::memory_order_relaxed)) {
+            return find_avx2(data, n, value);
+        }
+#endif
+        return find_kernel<16>(data, n, value);
+    }
+
+    template<simd_arithmetic T>
+    size_t count(const T *data, const size_t n, const T value) {
+#ifdef TINYWHEELS_SIMD_X86
+        if (use_avx2.load(std::memory_order_relaxed)) {
+            return count_avx2(data, n, value);
+        }
+#endif
+        return count_kernel<16>(data, n, value);
+    }
+
+    template<simd_arithmetic T>
+    T min(const T *data, const size_t n) {
+        return extrema<true, false>(data, n).first;
+    }
+
+    template<simd_arithmetic T>
+    T max(const T *data, const size_t n) {
+        return extrema<false, true>(data, n).second;
+    }
+
+    template<simd_arithmetic T>
+    std::pair<T, T> minmax(const T *data, const size_t n) {
+        return extrema<true, true>(data, n);
+    }
+
+    template<simd_arithmetic T>
+    sum_type_t<T> sum(const T *data, const size_t n) {
+#ifdef TINYWHEELS_SIMD_X86
+        if (use_avx2.load(std::memory_order_relaxed)) {
+            return sum_avx2(data, n);
+        }
+#endif
+        return sum_kernel<16>(data, n);
+    }
+
+    template<simd_arithmetic T>
+    sum_type_t<T> dot(const T *a, const T *b, const size_t n) {
+#ifdef TINYWHEELS_SIMD_X86
+        if (use_avx2.load(std::memory_order_relaxed)) {
+            return dot_avx2(a, b, n);
+        }
+#endif
+        return dot_kernel<16>(a, b, n);
+    }
+
+    void bitwise(const bit_op op, uint64_t *dst, const uint64_t *src, const size_t n) {
+#ifdef TINYWHEELS_SIMD_X86
+        if (use_avx2.load(std::memory_order_relaxed)) {
+            return bitwise_avx2(op, dst, src, n);
+        }
+#endif
+        bitwise_dispatch<16>(op, dst, src, n);
+    }
+
+    size_t popcount(const uint64_t *words, const size_t n) {
+#ifdef TINYWHEELS_SIMD_X86
+        if (popcnt_supported()) {
+            return popcount_popcnt(words, n);
+        }
+#endif
+        return popcount_kernel<16>(words, n);
+    }
+
+    size_t find_nonzero(const uint64_t *words, const size_t n) {
+#ifdef TINYWHEELS_SIMD_X86
+        if (use_avx2.load(std::memory_order_relaxed)) {
+            return find_nonzero_avx2(words, n);
+        }
+#endif
+        return find_nonzero_kernel<16>(words, n);
+    }
+
+    // 头文件只有声明，在这里为所有 simd_arithmetic 类型实例化
+#define TINYWHEELS_SIMD_INSTANTIATE(T) \
+    template size_t find<T>(const T *, size_t, T); \
+    template size_t count<T>(const T *, size_t, T); \
+    template T min<T>(const T *, size_t); \
+    template T max<T>(const T *, size_t); \
+    template std::pair<T, T> minmax<T>(const T *, size_t); \
+    template sum_type_t<T> sum<T>(const T *, size_t); \
+    template sum_type_t<T> dot<T>(const T *, const T *, size_t);
+
+    TINYWHEELS_SIMD_INSTANTIATE(char)
+    TINYWHEELS_SIMD_INSTANTIATE(signed char)
+    TINYWHEELS_SIMD_INSTANTIATE(unsigned char)
+    TINYWHEELS_SIMD_INSTANTIATE(short)
+    TINYWHEELS_SIMD_INSTANTIATE(unsigned short)
+    TINYWHEELS_SIMD_INSTANTIATE(int)
+    TINYWHEELS_SIMD_INSTANTIATE(unsigned int)
+    TINYWHEELS_SIMD_INSTANTIATE(long)
+    TINYWHEELS_SIMD_INSTANTIATE(unsigned long)
+    TINYWHEELS_SIMD_INSTANTIATE(long long)
+    TINYWHEELS_SIMD_INSTANTIATE(unsigned long long)
+    TINYWHEELS_SIMD_INSTANTIATE(float)
+    TINYWHEELS_SIMD_INSTANTIATE(double)
+#undef TINYWHEELS_SIMD_INSTANTIATE
+}
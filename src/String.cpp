@@ -5,23 +5,49 @@
 #include "mystring.h"
 
 namespace tinyWheels{
+    std::pair<string::char_point, string::size_type> string::allocate(const size_type n) const {
+        if (resource_ == nullptr) {
+            return charAllocator::allocate(n);
+        }
+        return std::make_pair(static_cast<char_point>(resource_->allocate(n, alignof(char_type))), n);
+    }
+
+    void string::deallocate(const char_point ptr, const size_type n) const {
+        if (ptr == nullptr) {
+            return;
+        }
+        if (resource_ == nullptr) {
+            charAllocator::deallocate(ptr, n);
+        }else {
+            resource_->deallocate(ptr, n, alignof(char_type));
+        }
+    }
+
     void string::copy_from(const string &str) {
         const auto s = str.size();    // 字符串大小
         const auto c = s + 1;  // 最低容量
         if (capacity_ < c) {
-            auto [ptr, cap] = charAllocator::allocate(c);
+            deallocate(data_, capacity_);
+            auto [ptr, cap] = allocate(c);
             data_ = ptr;
             capacity_ = cap;
         }
-        char_point ps = str.data_, pd = data_;
-        for (; *ps != '\0'; ++ps, ++pd) {
-            *pd = *ps;
+        for (size_type i = 0; i < s; ++i) {
+            data_[i] = str.data_[i];
         }
-        *pd = '\0';
+        data_[s] = '\0';
         size_ = s + 1;
     }
 
+    // 只有内存来源相同时才能直接接管对方的内存，否则只能拷贝
     void string::move_from(string &&str) noexcept {
+        const auto same = resource_ == str.resource_ or
+                          (resource_ != nullptr and str.resource_ != nullptr and resource_->is_equal(*str.resource_));
+        if (not same) {
+            copy_from(str);
+            return;
+        }
+        deallocate(data_, capacity_);
         data_ = str.data_;
         size_ = str.size_;
         capacity_ = str.capacity_;
@@ -44,41 +70,45 @@ namespace tinyWheels{
 
     string::~string() {
         if (data_) {
-            charAllocator::deallocate(data_, capacity_);
+            deallocate(data_, capacity_);
             size_ = 0;
             capacity_ = 0;
         }
     }
 
-    string::string(const string &str) {
+    string::string(const string &str) : resource_(str.resource_) {
         copy_from(str);
     }
 
-    string::string(string &&str) noexcept {
+    string::string(string &&str) noexcept : resource_(str.resource_) {
         move_from(std::forward<string>(str));
     }
 
-    string::string(const char_type ch) {
-        reserve(1);  // 初始化容量为1
+    string::string(const char_type ch, memory_resource *resource) : resource_(resource) {
+        reserve(2);  // 一个字符加上'\0'
         data_[0] = ch;
         data_[1] = '\0';
+        size_ = 2;
     }
 
-    string::string(c_string c_str_point) {
+    string::string(c_string c_str_point, memory_resource *resource) : resource_(resource) {
         auto len = strlen(c_str_point);
         reserve(len + 1);
         for (size_type i = 0; i < len; ++i) {
             data_[i] = c_str_point[i];
         }
+        data_[len] = '\0';
+        size_ = len + 1;
     }
 
-    string::string(size_type st, char_type ch) {
+    string::string(size_type st, char_type ch, memory_resource *resource) : resource_(resource) {
         reserve(st + 1);
         fill(data_, data_ + st, ch);
         data_[st] = '\0';
+        size_ = st + 1;
     }
 
-    string::string(size_type st, c_string c_str_point) {
+    string::string(size_type st, c_string c_str_point, memory_resource *resource) : resource_(resource) {
         auto len = strlen(c_str_point);
         reserve(st * len + 1);
         for (size_type i = 0; i < st; ++i) {
@@ -87,6 +117,20 @@ namespace tinyWheels{
             }
         }
         data_[st * len] = '\0';
+        size_ = st * len + 1;
+    }
+
+    string::string(const string_view sv, memory_resource *resource) : resource_(resource) {
+        reserve(sv.size() + 1);
+        if (not sv.empty()) {
+            memcpy(data_, sv.data(), sv.size());
+        }
+        data_[sv.size()] = '\0';
+        size_ = sv.size() + 1;
+    }
+
+    string string::substr(const size_type pos, const size_type n) const {
+        return string(view().substr(pos, n), resource_);
     }
 
     void string::insert(Iterator it, const string &s) {
@@ -98,7 +142,7 @@ namespace tinyWheels{
         const auto first = rbegin();
         const auto last = static_cast<ReverseIterator>(it)+1;
         // 把对应位置向后移动
-        const auto dst = rbegin() - static_cast<tinyWheels::ReverseIterator<char_type>::difference_type>(len);
+        const auto dst = rbegin() - static_cast<ReverseIterator::difference_type>(len);
         move_back(first, last, dst);
         for (size_type i = 0; i < len; ++i) {
             *it++ = s.data_[i];
@@ -128,7 +172,7 @@ namespace tinyWheels{
         }
         const auto first = rbegin();
         const auto last = static_cast<ReverseIterator>(it)+1;
-        const auto dst = rbegin() - static_cast<tinyWheels::ReverseIterator<char_type>::difference_type>(len);
+        const auto dst = rbegin() - static_cast<ReverseIterator::difference_type>(len);
         move_back(first, last, dst);
         for (size_type i = 0; i < len; ++i) {
             *it++ = cs[i];
@@ -217,6 +261,26 @@ namespace tinyWheels{
         return *this;
     }
 
+    string &string::operator+=(const string_view sv) {
+        const auto size_me = size();
+        auto src = sv.data();
+        if (capacity_ < size_me + sv.size() + 1) {
+            // sv 可能是自己的一段，扩容之后按偏移重新定位
+            const auto inside = src >= data_ and src < data_ + size_me;
+            const auto offset = inside ? src - data_ : 0;
+            reserve(size_me + sv.size() + 1);
+            if (inside) {
+                src = data_ + offset;
+            }
+        }
+        if (not sv.empty()) {
+            memmove(data_ + size_me, src, sv.size());
+        }
+        data_[size_me + sv.size()] = '\0';
+        size_ = size_me + sv.size() + 1;
+        return *this;
+    }
+
     string operator+(const string& s1, const string& s2) {
         string s(s1);
         s += s2;
@@ -273,19 +337,12 @@ namespace tinyWheels{
         return s2;
     }
 
+    // 比较都交给 string_view：长度不同的字符串按字典序比较，不会越过较短的一方
     bool operator==(const string & s1, const string & s2) {
-        if (s1.size() != s2.size()) return false;
-        for (int i = 0; i < s1.size(); ++i) {
-            if (s1.data_[i] != s2.data_[i]) return false;
-        }
-        return true;
+        return s1.view() == s2.view();
     }
     bool operator==(const string & s1, string::c_string s2) {
-        int i = 0;
-        for (; s2[i] != '\0'; ++i) {
-            if (s1.data_[i] != s2[i]) return false;
-        }
-        return s1.data_[i] == '\0';
+        return s1.view() == string_view(s2);
     }
     bool operator==(string::c_string s1, const string& s2) {
         return s2 == s1;
@@ -314,56 +371,25 @@ namespace tinyWheels{
     }
 
     bool operator>(const string & s1, const string & s2) {
-        for (int i = 0; i < s1.size(); ++i) {
-            if (s1.data_[i] > s2.data_[i]) return true;
-            if (s1.data_[i] < s2.data_[i]) return false;
-        }
-        return false;
+        return s1.view().compare(s2.view()) > 0;
     }
     bool operator>(const string & s1, string::c_string s2) {
-        int i = 0;
-        for (; s2[i] != '\0'; ++i) {
-            if (s1.data_[i] > s2[i]) return true;
-            if (s1.data_[i] < s2[i]) return false;
-        }
-        return s1.data_[i] > '\0';
+        return s1.view().compare(s2) > 0;
     }
     bool operator>(string::c_string s1, const string& s2) {
-        int i = 0;
-        for (; s1[i] != '\0'; ++i) {
-            if (s1[i] > s2.data_[i]) return true;
-            if (s1[i] < s2.data_[i]) return false;
-        }
-        return false;
+        return string_view(s1).compare(s2.view()) > 0;
     }
 
-
     bool operator>=(const string & s1, const string & s2) {
-        int i = 0;
-        for (; s2[i] != '\0'; ++i) {
-            if (s1.data_[i] > s2[i]) return true;
-            if (s1.data_[i] < s2[i]) return false;
-        }
-        return s1.data_[i] >= '\0';
+        return s1.view().compare(s2.view()) >= 0;
     }
     bool operator>=(const string & s1, string::c_string s2) {
-        int i = 0;
-        for (; s2[i] != '\0'; ++i) {
-            if (s1.data_[i] > s2[i]) return true;
-            if (s1.data_[i] < s2[i]) return false;
-        }
-        return s1.data_[i] >= '\0';
+        return s1.view().compare(s2) >= 0;
     }
     bool operator>=(string::c_string s1, const string& s2) {
-        int i = 0;
-        for (; s1[i] != '\0'; ++i) {
-            if (s1[i] > s2.data_[i]) return true;
-            if (s1[i] < s2.data_[i]) return false;
-        }
-        return s2.data_[i] == '\0';
+        return string_view(s1).compare(s2.view()) >= 0;
     }
 
-
     bool operator<(const string & s1, const string & s2) {
         return s2 > s1;
     }
@@ -387,13 +413,13 @@ namespace tinyWheels{
 
     void string::reserve(const size_type c) {
         if (capacity_ < c) {
-            auto [ptr, cap] = charAllocator::allocate(c);
-            char_point ps = data_, pm = ptr;
-            for (; *ps != '\0'; ++ps, ++pm) {
-                *pm = *ps;
+            auto [ptr, cap] = allocate(c);
+            const auto s = size();
+            for (size_type i = 0; i < s; ++i) {
+                ptr[i] = data_[i];
             }
-            *pm = '\0';
-            charAllocator::deallocate(data_, capacity_);
+            ptr[s] = '\0';
+            deallocate(data_, capacity_);
             data_ = ptr;
             capacity_ = cap;
         }
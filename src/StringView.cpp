@@ -0,0 +1,77 @@
+#include "string_view.h"
+
+#include <ostream>
+#include "simd.h"
+
+namespace tinyWheels {
+    string_view string_view::substr(const size_t pos, const size_t n) const {
+        if (pos > size_) {
+            throw exception("Out of range, pos: %lu, size: %lu", pos, size_);
+        }
+        return {data_ + pos, n < size_ - pos ? n : size_ - pos};
+    }
+
+    void string_view::remove_prefix(const size_t n) {
+        if (n > size_) {
+            throw exception("Out of range, n: %lu, size: %lu", n, size_);
+        }
+        data_ += n;
+        size_ -= n;
+    }
+
+    void string_view::remove_suffix(const size_t n) {
+        if (n > size_) {
+            throw exception("Out of range, n: %lu, size: %lu", n, size_);
+        }
+        size_ -= n;
+    }
+
+    size_t string_view::find(const char ch, const size_t pos) const {
+        if (pos >= size_) {
+            return npos;
+        }
+        const auto rst = pos + simd::find(data_ + pos, size_ - pos, ch);
+        return rst == size_ ? npos : rst;
+    }
+
+    size_t string_view::find(const string_view target, size_t pos) const {
+        if (target.size_ == 0) {
+            return pos <= size_ ? pos : npos;
+        }
+        // 首字符可能出现的最后一个位置是 size_ - target.size_
+        while (pos + target.size_ <= size_) {
+            pos = find(target.data_[0], pos);
+            if (pos == npos or pos + target.size_ > size_) {
+                return npos;
+            }
+            if (memcmp(data_ + pos + 1, target.data_ + 1, target.size_ - 1) == 0) {
+                return pos;
+            }
+            ++pos;
+        }
+        return npos;
+    }
+
+    size_t string_view::rfind(const char ch, const size_t pos) const {
+        for (auto i = pos < size_ ? pos + 1 : size_; i > 0; --i) {
+            if (data_[i - 1] == ch) {
+                return i - 1;
+            }
+        }
+        return npos;
+    }
+
+    int string_view::compare(const string_view another) const {
+        const auto n = size_ < another.size_ ? size_ : another.size_;
+        if (n != 0) {
+            if (const auto rst = memcmp(data_, another.data_, n); rst != 0) {
+                return rst;
+            }
+        }
+        return size_ == another.size_ ? 0 : size_ < another.size_ ? -1 : 1;
+    }
+
+    std::ostream &operator<<(std::ostream &os, const string_view sv) {
+        return os.write(sv.data_, static_cast<std::streamsize>(sv.size_));
+    }
+}
@@ -0,0 +1,98 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include "algorithm.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+std::mt19937_64 engine(42);
+int failures = 0;
+
+// 浮点数分路累加，超过尾数精度之后与逐个累加的舍入不同，允许相对误差
+template<class T, class Reference>
+bool close(const T a, const Reference b) {
+  if constexpr (std::is_floating_point_v<T>) {
+    return std::abs(a - b) <= std::abs(b) * std::numeric_limits<T>::epsilon() * 100;
+  }else {
+    return a == b;
+  }
+}
+
+// 向量化的结果与逐个处理的结果逐项比较，长度覆盖不足一个向量、正好若干个向量以及带尾巴的情况
+template<class T>
+void check(const char *name) {
+  for (const size_t n : {1, 3, 16, 31, 64, 100, 1000, 70000}) {
+    vector<T> v(n);
+    for (size_t i = 0; i < n; ++i) {
+      v[i] = static_cast<T>(engine() % 50);
+    }
+    const T key = v[n / 2];
+    size_t first_key = 0, keys = 0, low = 0, high = 0;
+    // 浮点数的参照值用 double 累加，比逐个用 float 累加更准
+    using Reference = std::conditional_t<std::is_floating_point_v<T>, double, sum_type_t<T>>;
+    Reference total = 0, product = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (v[i] == key and keys++ == 0) first_key = i;
+      if (v[i] < v[low]) low = i;
+      if (v[high] < v[i]) high = i;
+      total += v[i];
+      product += static_cast<Reference>(v[i]) * static_cast<Reference>(v[i]);
+    }
+    const auto [min_it, max_it] = minmax_element(v.begin(), v.end());
+    const bool ok = find(v.begin(), v.end(), key) - v.begin() == static_cast<long>(first_key)
+                    and find(v.begin(), v.end(), 99) == v.end()
+                    and count(v.begin(), v.end(), key) == keys
+                    and min_element(v.begin(), v.end()) - v.begin() == static_cast<long>(low)
+                    and max_element(v.begin(), v.end()) - v.begin() == static_cast<long>(high)
+                    and min_it - v.begin() == static_cast<long>(low) and max_it - v.begin() == static_cast<long>(high)
+                    and close(sum(v.begin(), v.end()), total) and close(dot(v.begin(), v.end(), v.begin()), product);
+    if (not ok) {
+      std::cout << "mismatch: " << name << ", n = " << n << std::endl;
+      ++failures;
+    }
+  }
+}
+
+void check_all() {
+  check<char>("char");
+  check<signed char>("signed char");
+  check<unsigned char>("unsigned char");
+  check<short>("short");
+  check<unsigned short>("unsigned short");
+  check<int>("int");
+  check<unsigned>("unsigned");
+  check<long>("long");
+  check<unsigned long long>("unsigned long long");
+  check<float>("float");  // 元素都是小整数，分路累加也没有舍入误差
+  check<double>("double");
+}
+
+int main() {
+  std::cout << "avx2 supported: " << simd::avx2_supported() << std::endl;
+  check_all();
+  simd::enable_avx2(false);  // 再用 128 位的内核检查一遍
+  check_all();
+  simd::enable_avx2(true);
+  std::cout << "failures: " << failures << std::endl;
+
+  // 边界情况：int 的 vector 中找负数、超出范围的值，以及第一个元素是 NaN
+  vector<unsigned> u{1, 2, 3};
+  vector<double> d{NAN, 3.0, -1.0, 7.0};
+  const auto [low, high] = minmax_element(d.begin(), d.end());
+  std::cout << "find -1 in unsigned: " << (find(u.begin(), u.end(), -1) == u.end())
+            << ", count 2 (long) in unsigned: " << count(u.begin(), u.end(), 2L)
+            << ", minmax with leading NaN: " << *low << " " << *high << std::endl;
+  // 与 std::minmax_element 相同：NaN 与什么比较都是 false，最小值和最大值都停在第一个元素
+  assert(find(u.begin(), u.end(), -1) == u.end() and count(u.begin(), u.end(), 2L) == 1);
+  assert(low == d.begin() and high == d.begin());
+
+  // 不是指针的迭代器（这里是反向迭代器）仍然逐个处理
+  vector<int> r{5, 1, 4, 1};
+  std::cout << "reverse: find 4 at " << (find(r.rbegin(), r.rend(), 4) - r.rbegin()) << ", count 1 = " << count(r.rbegin(), r.rend(), 1)
+            << ", min = " << *min_element(r.rbegin(), r.rend()) << ", sum = " << sum(r.rbegin(), r.rend()) << std::endl;
+  assert(find(r.rbegin(), r.rend(), 4) - r.rbegin() == 1 and count(r.rbegin(), r.rend(), 1) == 2 and sum(r.rbegin(), r.rend()) == 11);
+  return failures != 0;
+}
@@ -1,4 +1,9 @@
+#include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <thread>
+#include <vector>
 #include "allocator.h"
 
 class TestAllocator {
@@ -41,7 +46,51 @@ void printT(const T* ptr, const size_t size) {
     std::cout << std::endl;
 }
 
+// 按 Alignment 对齐申请，检查返回的地址，小内存块、malloc 的大内存块以及 ChunkProvider 的超大内存块都要覆盖
+template <class T, size_t Alignment>
+void TestAligned(const std::initializer_list<size_t>& list) {
+    for (auto number : list) {
+        auto [ptr, cap] = tinyWheels::Allocator<T, Alignment>::allocate(number);
+        ptr[0] = T(1), ptr[cap - 1] = T(2);
+        std::cout << "align " << Alignment << ", number " << number << ": " << (reinterpret_cast<uintptr_t>(ptr) % Alignment == 0 ? "aligned" : "NOT aligned") << std::endl;
+        tinyWheels::Allocator<T, Alignment>::deallocate(ptr, cap);
+    }
+}
+
+// 批量申请、释放之后 previous 仍然是满的或空的，trim 把所有内存块倒回自由链表，只留下正在切分的大内存块
+void TestTrimAfterBulk() {
+    using tinyWheels::MemoryPool;
+    // loaded、previous 与仓库中的一个弹匣都装满，批量申请取空 loaded 之后还要再取一部分
+    std::vector<void *> blocks;
+    for (size_t i = 0; i < 3 * MemoryPool::MAGAZINE_ROUNDS; ++i) {
+        blocks.push_back(MemoryPool::allocate(48));
+    }
+    for (auto block : blocks) {
+        MemoryPool::deallocate(block, 48);
+    }
+    blocks.clear();
+    void *bulk[MemoryPool::MAGAZINE_ROUNDS + 4];
+    MemoryPool::allocate_bulk(48, bulk, std::size(bulk));
+    void *single = MemoryPool::allocate(48);
+    MemoryPool::deallocate(single, 48);
+    MemoryPool::deallocate_bulk(bulk, 48, std::size(bulk));
+    (void)MemoryPool::trim(0);
+
+    // 之后切分的大内存块全部空闲，trim 之后只剩下正在切分的一块
+    for (int i = 0; i < 100000; ++i) {
+        blocks.push_back(MemoryPool::allocate(48));
+    }
+    for (auto block : blocks) {
+        MemoryPool::deallocate(block, 48);
+    }
+    const auto released = MemoryPool::trim(0);
+    const auto stats = MemoryPool::statistics();
+    std::cout << "trim after bulk released: " << released << " bytes, retained: " << stats.retained_bytes() << " bytes" << std::endl;
+    assert(stats.retained_bytes() == MemoryPool::CHUNK_BYTES);
+}
+
 int main() {
+    TestTrimAfterBulk();
     // 通过测试 int float 自定义类型的内存分配来测试内存分配器
     TestT<int>({1, 2, 3, 4, 5, 10, 50}, 114514);
     TestT<int>({10, 12, 14, 16, 18, 20, 22}, 1514);
@@ -49,5 +98,58 @@ int main() {
     TestT<int>({1, 2, 3, 4, 5, 10, 50, 100}, 1919810);
     TestT<float>({1, 2, 3, 4, 5, 10, 50, 100}, 3.1415926);
     TestT<TestAllocator>({1, 2, 3, 4, 5, 10, 50, 100}, 10, "测试");
+
+    // 换成 mmap + 透明大页的大内存块来源，超大内存块也从这里获取
+    tinyWheels::MmapChunkProvider huge_provider(true);
+    tinyWheels::MemoryPool::set_chunk_provider(&huge_provider);
+    TestT<long>({1, 2, 3, 4, 5, 10, 50, 100}, 20250310L);
+    auto [ptr, cap] = tinyWheels::Allocator<long>::allocate(1 << 20);
+    ptr[0] = 1, ptr[cap - 1] = 2;
+    std::cout << "large block: " << ptr << ", capacity: " << cap << std::endl;
+    // 超大内存块扩容：先尝试原地扩展，不行再 mremap，内容按字节保留
+    const auto last = cap - 1;
+    auto expanded = tinyWheels::Allocator<long>::try_expand(ptr, cap, cap + 1024);
+    std::cout << "try_expand: " << (expanded != 0 ? "in place" : "failed") << std::endl;
+    cap = expanded != 0 ? expanded : cap;
+    auto [moved, moved_cap] = tinyWheels::Allocator<long>::reallocate(ptr, cap, 4 * cap);
+    std::cout << "reallocate: " << (moved != nullptr ? "ok" : "failed") << ", first " << moved[0] << ", old last " << moved[last] << std::endl;
+    ptr = moved, cap = moved_cap;
+    tinyWheels::Allocator<long>::deallocate(ptr, cap);
+    // mremap 移动之后只保证按页对齐，打开大页时也一样；对齐超过页大小时不能移动，返回 nullptr 由调用者申请新内存再复制
+    const auto page_aligned = huge_provider.allocate(1 << 22, 8192);
+    assert(huge_provider.reallocate(page_aligned, 1 << 22, 1 << 23, 8192) == nullptr);
+    huge_provider.release(page_aligned, 1 << 22);
+    tinyWheels::MemoryPool::destroy_all();
+    tinyWheels::MemoryPool::set_chunk_provider(nullptr);
+    std::cout << tinyWheels::MemoryPool::statistics();
+
+    // 超过内存池 ALIGN 的对齐：AVX 的 32 字节、AVX-512 的 64 字节以及按页对齐
+    TestAligned<float, 32>({1, 7, 50, 1000, 1 << 20});
+    TestAligned<double, 64>({1, 3, 100, 1 << 18});
+    TestAligned<char, 4096>({1, 5000, 1 << 21});
+    struct alignas(64) Counter {long value;};
+    auto [counters, number] = tinyWheels::Allocator<Counter>::allocate(3);  // alignas 的类型默认按 alignof(T) 对齐
+    std::cout << "alignas(64) counters: " << (reinterpret_cast<uintptr_t>(counters) % 64 == 0 ? "aligned" : "NOT aligned") << std::endl;
+    tinyWheels::Allocator<Counter>::deallocate(counters, number);
+
+    // 峰值过后把完全空闲的大内存块还给操作系统，先显式 trim，再交给后台清理线程
+    std::vector<TestAllocator *> burst;
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < 500000; ++i) {
+            burst.push_back(tinyWheels::Allocator<TestAllocator>::allocate(1).first);
+        }
+        for (auto p : burst) {
+            tinyWheels::Allocator<TestAllocator>::deallocate(p, 1);
+        }
+        burst.clear();
+        if (round == 0) {
+            std::cout << "trim released: " << tinyWheels::MemoryPool::trim() << " bytes" << std::endl;
+        }else {
+            tinyWheels::MemoryPool::start_scavenger(std::chrono::milliseconds(10));
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            tinyWheels::MemoryPool::stop_scavenger();
+        }
+    }
+    std::cout << tinyWheels::MemoryPool::statistics();
     return 0;
 }
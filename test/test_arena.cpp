@@ -0,0 +1,85 @@
+#include <cassert>
+#include <iostream>
+#include "arena.h"
+#include "list.h"
+#include "mystring.h"
+#include "small_vector.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+// 记录析构次数，确认 reset() 会调用 create<T>() 构造的对象的析构函数
+struct Session {
+    static int destroyed;
+    int id;
+    vector<int, ArenaAllocator<int>> scores;
+    Session(Arena *arena, const int id) : id(id), scores(arena) {}
+    ~Session() {++destroyed;}
+};
+int Session::destroyed = 0;
+
+struct alignas(64) CacheLine {
+    char data[64];
+};
+
+// 模拟一次请求：所有临时对象都建在 arena 上，请求结束时不逐个释放
+void handle_request(Arena &arena, const int id) {
+    vector<int, ArenaAllocator<int>> v(&arena);
+    for (int i = 0; i < 10; ++i) {
+        v.push_back(id * 100 + i);
+    }
+    list<int, ArenaAllocator<int>> l({1, 2, 3}, &arena);
+    l.push_back(id);
+    string s("request ", &arena);
+    s += static_cast<char>('0' + id);
+
+    auto session = arena.create<Session>(&arena, id);
+    session->scores.push_back(id);
+    auto line = arena.create<CacheLine>();
+    std::cout << s.c_str() << ": v = [" << v << "], l = [" << l << "], session " << session->id
+              << ", cache line aligned: " << (reinterpret_cast<uintptr_t>(line) % 64 == 0) << std::endl;
+}
+
+// ArenaAllocator 没有默认构造函数，移动时分配器要跟着内存一起带走
+void test_move(Arena &arena) {
+    vector<int, ArenaAllocator<int>> v(&arena);
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(i);
+    }
+    vector<int, ArenaAllocator<int>> moved(std::move(v));
+    assert(moved.size() == 100 and moved[99] == 99 and v.empty() and moved.get_allocator().arena() == &arena);
+    vector<int, ArenaAllocator<int>> assigned(&arena);
+    assigned = std::move(moved);
+    assert(assigned.size() == 100 and assigned[50] == 50 and moved.empty());
+
+    small_vector<int, 4, ArenaAllocator<int>> small(&arena);
+    for (int i = 0; i < 10; ++i) {
+        small.push_back(i);
+    }
+    small_vector<int, 4, ArenaAllocator<int>> small_moved(std::move(small));
+    assert(small_moved.size() == 10 and small_moved[9] == 9 and small.empty());
+    small_vector<int, 4, ArenaAllocator<int>> small_assigned(&arena);
+    small_assigned = std::move(small_moved);
+    assert(small_assigned.size() == 10 and small_assigned[0] == 0 and small_moved.empty());
+    std::cout << "move arena vectors ok" << std::endl;
+}
+
+int main() {
+    Arena arena(256);
+    for (int id = 0; id < 3; ++id) {
+        handle_request(arena, id);
+        const auto reserved = arena.reserved_bytes();
+        arena.reset();
+        std::cout << "reserved: " << reserved << " bytes, sessions destroyed: " << Session::destroyed << std::endl;
+    }
+
+    // 超过内存块大小的申请单独占一个内存块，reset() 之后照样复用
+    {
+        vector<long, ArenaAllocator<long>> big(1000, 7L, &arena);
+        std::cout << "big: " << big.size() << " elements, last " << big.back() << ", reserved: " << arena.reserved_bytes() << " bytes" << std::endl;
+    }
+    test_move(arena);
+    arena.release();
+    std::cout << "after release, reserved: " << arena.reserved_bytes() << " bytes" << std::endl;
+    return 0;
+}
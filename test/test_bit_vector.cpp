@@ -0,0 +1,164 @@
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "bit_vector.h"
+
+using namespace tinyWheels;
+
+// 与 std::vector<bool> 逐位比较 count、find、rank、select
+void check_queries(const bit_vector &bits, const std::vector<bool> &expected) {
+    assert(bits.size() == expected.size());
+    size_t ones = 0;
+    std::vector<size_t> positions;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        assert(bits[i] == expected[i]);
+        assert(bits.rank(i) == ones);
+        if (expected[i]) {
+            positions.push_back(i);
+            ++ones;
+        }
+    }
+    assert(bits.count() == ones);
+    assert(bits.rank(expected.size()) == ones);
+    assert(bits.any() == (ones != 0));
+    // 遍历所有的 1
+    size_t k = 0;
+    for (auto i = bits.find_first(); i != bit_vector::npos; i = bits.find_next(i), ++k) {
+        assert(i == positions[k]);
+    }
+    assert(k == positions.size());
+    const rank_index index(bits);
+    assert(index.count() == ones);
+    for (k = 0; k < positions.size(); k += 1 + k / 8) {
+        assert(bits.select(k) == positions[k]);
+        assert(index.select(k) == positions[k]);
+        assert(index.rank(positions[k]) == k);
+    }
+    assert(bits.select(ones) == bit_vector::npos);
+    assert(index.select(ones) == rank_index::npos);
+    assert(index.rank(expected.size()) == ones);
+}
+
+void test_bit_vector(std::mt19937_64 &random) {
+    for (const size_t size : {0UL, 1UL, 63UL, 64UL, 65UL, 1000UL, 4096UL, 100003UL}) {
+        // 稀疏与稠密两种密度
+        for (const int density : {2, 97}) {
+            bit_vector bits(size);
+            std::vector<bool> expected(size);
+            for (size_t i = 0; i < size; ++i) {
+                const bool value = static_cast<int>(random() % 100) < density;
+                bits[i] = value;
+                expected[i] = value;
+            }
+            check_queries(bits, expected);
+
+            // 与另一个随机位图做位运算
+            bit_vector other(size);
+            std::vector<bool> other_expected(size);
+            for (size_t i = 0; i < size; ++i) {
+                other_expected[i] = random() % 2;
+                other.set(i, other_expected[i]);
+            }
+            auto both = bits & other, either = bits | other, differ = bits ^ other, only = bits;
+            only.andnot(other);
+            std::vector<bool> e_and(size), e_or(size), e_xor(size), e_andnot(size);
+            for (size_t i = 0; i < size; ++i) {
+                e_and[i] = expected[i] and other_expected[i];
+                e_or[i] = expected[i] or other_expected[i];
+                e_xor[i] = expected[i] != other_expected[i];
+                e_andnot[i] = expected[i] and not other_expected[i];
+            }
+            check_queries(both, e_and);
+            check_queries(either, e_or);
+            check_queries(differ, e_xor);
+            check_queries(only, e_andnot);
+
+            // 取反之后超过长度的位仍然是 0
+            auto inverted = ~bits;
+            assert(inverted.count() == size - bits.count());
+            assert((inverted | bits).all());
+        }
+    }
+    std::cout << "bit_vector queries and bitwise ok" << std::endl;
+}
+
+int main() {
+    std::mt19937_64 random(17);
+    test_bit_vector(random);
+    if (simd::avx2_supported()) {
+        simd::enable_avx2(false);
+        test_bit_vector(random);
+        simd::enable_avx2(true);
+        std::cout << "bit_vector without avx2 ok" << std::endl;
+    }
+
+    // push_back、pop_back、resize
+    bit_vector flags;
+    std::vector<bool> expected;
+    for (int i = 0; i < 300; ++i) {
+        flags.push_back(i % 3 == 0);
+        expected.push_back(i % 3 == 0);
+    }
+    check_queries(flags, expected);
+    for (int i = 0; i < 100; ++i) {
+        assert(flags.pop_back());
+        expected.pop_back();
+    }
+    check_queries(flags, expected);
+    flags.resize(333, true);
+    expected.resize(333, true);
+    check_queries(flags, expected);
+    flags.resize(70);
+    expected.resize(70);
+    check_queries(flags, expected);
+    flags.flip(1).reset(0);
+    expected[1] = not expected[1];
+    expected[0] = false;
+    check_queries(flags, expected);
+    std::ostringstream os;
+    os << flags;
+    std::cout << "flags: " << os.str() << std::endl;
+    assert(os.str().size() == 70);
+    flags.clear();
+    assert(flags.empty() and flags.count() == 0 and flags.find_first() == bit_vector::npos);
+    std::cout << "size: " << flags.size() << ", capacity: " << flags.capacity() << std::endl;
+
+    // 长度不同的位运算抛出异常
+    try {
+        bit_vector a(10), b(11);
+        a &= b;
+        assert(false);
+    }catch (const tinyWheels::exception &e) {
+        std::cout << "exception: " << e.what() << std::endl;
+    }
+
+    // bitset：小的直接展开，大的走向量化内核
+    bitset<100> small(0b1011);
+    small.set(99).flip(64);
+    assert(small.count() == 5);
+    assert(small.find_first() == 0 and small.find_next(1) == 3 and small.find_next(3) == 64 and small.find_next(64) == 99);
+    assert(small.find_next(99) == bitset<100>::npos);
+    assert(small.rank(64) == 3 and small.select(3) == 64 and small.select(5) == bitset<100>::npos);
+    assert((~small).count() == 95);
+    assert(bitset<100>().set().all());
+    std::cout << "bitset<100>: " << small << std::endl;
+
+    bitset<5000> a, b;
+    for (size_t i = 0; i < 5000; i += 3) {
+        a.set(i);
+    }
+    for (size_t i = 0; i < 5000; i += 5) {
+        b.set(i);
+    }
+    assert((a & b).count() == 334);  // 15 的倍数
+    assert((a | b).count() == 1667 + 1000 - 334);
+    assert((a ^ b).count() == 1667 + 1000 - 2 * 334);
+    auto c = a;
+    c.andnot(b);
+    assert(c.count() == 1667 - 334);
+    assert(c.rank(15) == 4);  // 3、6、9、12
+    std::cout << "bitset<5000> ok, a & b: " << (a & b).count() << std::endl;
+    return 0;
+}
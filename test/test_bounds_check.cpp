@@ -0,0 +1,69 @@
+#include <cassert>
+#include <iostream>
+#include "bit_vector.h"
+#include "mystring.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "span.h"
+#include "string_view.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+// f 必须抛出 tinyWheels::exception
+template<class F>
+void expect_throw(const char *name, F &&f) {
+    try {
+        f();
+        assert(false);
+    }catch (const tinyWheels::exception &e) {
+        std::cout << name << ": " << e.what() << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "TINYWHEELS_BOUNDS_CHECK = " << TINYWHEELS_BOUNDS_CHECK << std::endl;
+
+    vector<int> v;
+    for (int i = 0; i < 9; ++i) {
+        v.push_back(i);
+    }
+    v.pop_back();  // 留出 size() 到 capacity() 之间的空位
+    const auto &cv = v;
+    assert(v.at(3) == 3 and cv.at(7) == 7 and cv[2] == 2);
+    v.at(0) = 10;
+    assert(v[0] == 10);
+    small_vector<int, 4> sv{1, 2, 3};
+    const string s = "abc";
+    const string_view view = "xyz";
+    const span<int> sp(v);
+    soa_vector<int, double> soa;
+    soa.emplace_back(1, 1.5);
+    bit_vector bits(10);
+    assert(sv.at(2) == 3 and s.at(1) == 'b' and view.at(2) == 'z' and sp.at(7) == 7 and soa.at(0).get<1>() == 1.5);
+
+    // at() 不受 TINYWHEELS_BOUNDS_CHECK 影响，始终检查 size()，不是 capacity()
+    assert(v.capacity() > v.size());
+    expect_throw("vector::at", [&] {(void)v.at(v.size());});
+    expect_throw("small_vector::at", [&] {(void)sv.at(3);});
+    expect_throw("string::at", [&] {(void)s.at(3);});
+    expect_throw("string_view::at", [&] {(void)view.at(3);});
+    expect_throw("span::at", [&] {(void)sp.at(8);});
+    expect_throw("soa_vector::at", [&] {(void)soa.at(1);});
+    expect_throw("bit_vector::test", [&] {(void)bits.test(10);});
+    expect_throw("bit_vector::set", [&] {bits.set(10);});
+
+    // operator[] 在抛出模式下也只允许访问 size() 之内的元素
+    if constexpr (default_bounds_check == bounds_check::CHECKED) {
+        expect_throw("vector[]", [&] {(void)v[v.size()];});
+        expect_throw("string_view[]", [&] {(void)view[3];});
+        expect_throw("bit_vector[]", [&] {(void)bits[10];});
+    }
+
+    // 策略也可以在调用处单独指定
+    check_index<bounds_check::UNCHECKED>(100, 1);
+    check_index<bounds_check::ASSERT>(0, 1);
+    expect_throw("check_index<CHECKED>", [] {check_index<bounds_check::CHECKED>(1, 1);});
+    std::cout << "bounds check ok" << std::endl;
+    return 0;
+}
@@ -1,7 +1,169 @@
 #include "deque.h"
+#include <cassert>
+#include <deque>
 #include <iostream>
+#include <random>
+#include <string>
+#include "arena.h"
 #include "queue.h"
-int main(){
-  std::cout << "测试双端队列" << std::endl;
+
+using namespace tinyWheels;
+
+// 正反两个方向遍历、下标访问、迭代器的距离都与 expected 一致
+template<class T, DEQUE::DEQUE_TYPE MODE, class Alloc>
+void check(const deque<T, MODE, Alloc>& d, const std::deque<T>& expected) {
+  assert(d.size() == expected.size() and d.cend() - d.cbegin() == static_cast<ptrdiff_t>(expected.size()));
+  size_t i = 0;
+  for (auto it = d.cbegin(); it != d.cend(); ++it) {
+    assert(*it == expected[i] and d[i] == expected[i]);
+    ++i;
+  }
+  for (auto it = d.crbegin(); it != d.crend(); ++it) {
+    assert(*it == expected[--i]);
+  }
+  assert(i == 0);
+  if (not expected.empty()) {
+    assert(d.front() == expected.front() and d.back() == expected.back());
+  }
+}
+
+// 随机在两端插入、删除，与 std::deque 的结果比较
+void test_random(const unsigned seed) {
+  std::mt19937 random(seed);
+  deque<std::string> d;
+  std::deque<std::string> expected;
+  for (int round = 0; round < 50000; ++round) {
+    const auto op = random() % 10;
+    const auto value = std::to_string(round) + std::string(round % 20, 'x');
+    if (op < 3) {
+      d.push_back(value);
+      expected.push_back(value);
+    }else if (op < 6) {
+      d.emplace_front(value);
+      expected.push_front(value);
+    }else if (op < 8) {
+      assert(d.pop_front() == not expected.empty());
+      if (not expected.empty()) expected.pop_front();
+    }else {
+      assert(d.pop_back() == not expected.empty());
+      if (not expected.empty()) expected.pop_back();
+    }
+    if (round % 5000 == 0) {
+      check(d, expected);
+    }
+  }
+  check(d, expected);
+  d.clear();
+  assert(d.empty() and d.begin() == d.end() and not d.pop_front());
+}
+
+void test_basic() {
+  deque<int> d{1, 2, 3, 4, 5};
+  std::cout << "d = [" << d << "]" << std::endl;
+  // 两端插入不搬动元素，之前的引用保持有效
+  int& first = d.front();
+  int& last = d.back();
+  for (int i = 0; i < 1000; ++i) {
+    d.push_front(-i);
+    d.push_back(100 + i);
+  }
+  assert(&first == &d[1000] and first == 1 and &last == &d[1004] and last == 5);
+  assert(d.size() == 2005 and d.front() == -999 and d.back() == 1099);
+
+  // 随机访问的迭代器
+  auto it = d.begin() + 1000;
+  assert(*it == 1 and it[4] == 5 and (it + 500) - it == 500 and (it - 1000) == d.begin());
+  it += 1003;
+  assert(*it == 1098 and it < d.end() and d.end() - it == 2);
+  it -= 2003;
+  assert(it == d.begin() and *it == -999);
+  deque<int>::ConstIterator constant = d.begin() + 1002;
+  assert(*constant == 3);
+  assert(*(d.rbegin() + 2) == 1097);
+
+  // 拷贝、移动、比较
+  deque<int> copy(d);
+  assert(copy == d);
+  deque<int> moved(std::move(copy));
+  assert(moved == d and copy.empty());
+  copy = {7, 8};
+  assert(copy != d and copy[1] == 8);
+  swap(copy, moved);
+  assert(moved.size() == 2 and copy == d);
+
+  try {
+    (void)d.at(d.size());
+    assert(false);
+  }catch (const tinyWheels::exception& e) {
+    std::cout << "exception: " << e.what() << std::endl;
+  }
+
+  // 队列的用法：一端进一端出，长度不变，块循环使用
+  deque<int> window;
+  for (int i = 0; i < 100; ++i) window.push_back(i);
+  for (int i = 100; i < 100000; ++i) {
+    window.push_back(i);
+    window.pop_front();
+    assert(window.front() == i - 99 and window.back() == i);
+  }
+  assert(window.size() == 100 and window[50] == 99950);
+}
+
+// 关闭的操作不能调用
+template<class D>
+concept can_push_front = requires(D d) {d.push_front(1);};
+template<class D>
+concept can_pop_back = requires(D d) {d.pop_back();};
+static_assert(can_push_front<deque<int>> and can_pop_back<deque<int>>);
+static_assert(not can_push_front<deque<int, DEQUE::BACK_INPUT | DEQUE::FRONT_OUTPUT>>);
+static_assert(not can_pop_back<deque<int, DEQUE::BACK_INPUT | DEQUE::FRONT_OUTPUT>>);
+
+// 构造抛出异常时 deque 不变
+struct Fragile {
+  int value;
+  explicit Fragile(const int value) : value(value) {
+    if (value < 0) throw tinyWheels::exception("negative %d", value);
+  }
+};
+
+void test_exception() {
+  deque<Fragile> d;
+  for (size_t i = 0; i < deque<Fragile>::BLOCK_ELEMENTS; ++i) {
+    d.emplace_back(static_cast<int>(i));
+  }
+  try {
+    d.emplace_back(-1);  // 需要新的一块
+    assert(false);
+  }catch (const tinyWheels::exception&) {}
+  try {
+    d.emplace_front(-2);
+    assert(false);
+  }catch (const tinyWheels::exception&) {}
+  assert(d.size() == deque<Fragile>::BLOCK_ELEMENTS and d.front().value == 0 and d.back().value == static_cast<int>(d.size()) - 1);
+}
+
+void test_queue() {
+  queue<std::string> q;
+  q.push("a");
+  q.push("b");
+  q.emplace(3, 'c');
+  assert(q.size() == 3 and q.front() == "a" and q.back() == "ccc");
+  assert(q.pop() and q.front() == "b");
+  assert(q.pop() and q.pop() and q.empty() and not q.pop());
+
+  // 块与中控数组都从 arena 中申请，4000 字节的元素放不进第一个内存块
+  Arena arena(4096);
+  pmr::deque<int> d(&arena);
+  for (int i = 0; i < 1000; ++i) d.push_back(i);
+  assert(d[999] == 999 and arena.reserved_bytes() > 4096);
+}
+
+int main() {
+  test_basic();
+  test_random(1);
+  test_random(2);
+  test_exception();
+  test_queue();
+  std::cout << "deque ok, block elements for int: " << deque<int>::BLOCK_ELEMENTS << std::endl;
   return 0;
 }
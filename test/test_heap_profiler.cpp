@@ -0,0 +1,54 @@
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include "HeapProfiler.h"
+#include "list.h"
+#include "mystring.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+// 两个不同的调用点，申请量相差 10 倍，采样结果中的估计字节数也应该相差 10 倍左右
+// 调用栈按函数名区分调用点，所以不能内联
+[[gnu::noinline]] void build_vectors(const int rounds) {
+    for (int i = 0; i < rounds; ++i) {
+        vector<long> v(64, 1L);
+    }
+}
+
+[[gnu::noinline]] void build_lists(const int rounds) {
+    for (int i = 0; i < rounds; ++i) {
+        list<int> l(16, 2);
+    }
+}
+
+int main() {
+    HeapProfiler::start(4096);
+    build_vectors(100000);  // 51.2MB
+    build_lists(10000);     // 10000 * (16 + 2) 个 24 字节的节点，约 4.3MB
+    HeapProfiler::stop();
+    build_vectors(100000);  // 停止之后不再采样
+    std::cout << "samples: " << HeapProfiler::samples() << std::endl;
+
+    std::ostringstream folded;
+    HeapProfiler::dump_folded(folded);
+    double vector_bytes = 0, list_bytes = 0;
+    std::istringstream lines(folded.str());
+    for (std::string line; std::getline(lines, line);) {
+        const auto bytes = std::stod(line.substr(line.rfind(' ') + 1));
+        if (line.find("build_vectors") != std::string::npos) vector_bytes += bytes;
+        if (line.find("build_lists") != std::string::npos) list_bytes += bytes;
+    }
+    std::cout << "estimated build_vectors: " << vector_bytes / 1e6 << " MB, build_lists: " << list_bytes / 1e6 << " MB" << std::endl;
+    // 两个调用点都要解析出来（链接时没有导出符号就是 0），比例大约是 51.2 : 4.3
+    assert(vector_bytes > 0 and list_bytes > 0);
+    const auto ratio = vector_bytes / list_bytes;
+    assert(ratio > 6 and ratio < 24);
+
+    std::ostringstream pprof;
+    HeapProfiler::dump_pprof(pprof);
+    std::cout << pprof.str().substr(0, pprof.str().find('\n')) << std::endl;
+    HeapProfiler::reset();
+    std::cout << "after reset: " << HeapProfiler::samples() << " samples" << std::endl;
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "intrusive_list.h"
+
+using namespace tinyWheels;
+
+struct LruTag {};
+struct TimeoutTag {};
+
+// 同时在 LRU 链与超时队列中的连接，两个钩子互不影响
+struct Connection : intrusive_list_hook<LruTag>, intrusive_list_hook<TimeoutTag> {
+  int fd;
+  long deadline;
+  Connection(const int fd, const long deadline) : fd(fd), deadline(deadline) {}
+};
+
+using LruList = intrusive_list<Connection, LruTag>;
+using TimeoutQueue = intrusive_list<Connection, TimeoutTag>;
+
+template<class List>
+std::vector<int> fds(const List& l) {
+  std::vector<int> rst;
+  for (const auto& c : l) {
+    rst.push_back(c.fd);
+  }
+  // 反向遍历检查 prev
+  size_t i = rst.size();
+  auto it = l.end();
+  while (it != l.begin()) {
+    --it;
+    assert(it->fd == rst[--i]);
+  }
+  assert(i == 0 and rst.size() == l.size());
+  return rst;
+}
+
+void test_lru() {
+  // 连接放在别处（这里是预留好容量的 std::vector，不会搬动元素），链表只链接它们
+  std::vector<Connection> pool;
+  pool.reserve(8);
+  for (int fd = 0; fd < 5; ++fd) {
+    pool.push_back(Connection(fd, 100 + fd));
+  }
+  LruList lru;
+  TimeoutQueue timeouts;
+  for (auto& c : pool) {
+    lru.push_front(c);
+    timeouts.push_back(c);
+  }
+  assert(fds(lru) == std::vector<int>({4, 3, 2, 1, 0}) and fds(timeouts) == std::vector<int>({0, 1, 2, 3, 4}));
+
+  // 访问过的连接移到 LRU 开头，超时队列不受影响
+  lru.splice(lru.begin(), lru, pool[1]);
+  lru.splice(lru.begin(), lru, pool[1]);  // 已经在开头
+  assert(fds(lru) == std::vector<int>({1, 4, 3, 2, 0}) and fds(timeouts) == std::vector<int>({0, 1, 2, 3, 4}));
+
+  // 续期：只知道连接本身，从超时队列中 O(1) 删除再放到队尾
+  pool[0].deadline = 200;
+  timeouts.erase(pool[0]);
+  timeouts.push_back(pool[0]);
+  assert(fds(timeouts) == std::vector<int>({1, 2, 3, 4, 0}));
+
+  // 淘汰最久没有访问的连接，两个链表都要删除
+  auto& victim = lru.back();
+  assert(victim.fd == 0);
+  lru.pop_back();
+  timeouts.erase(victim);
+  assert(not static_cast<intrusive_list_hook<LruTag>&>(victim).is_linked());
+  assert(fds(lru) == std::vector<int>({1, 4, 3, 2}) and fds(timeouts) == std::vector<int>({1, 2, 3, 4}));
+
+  // 处理已经超时的连接
+  const long now = 103;
+  while (not timeouts.empty() and timeouts.front().deadline <= now) {
+    auto& expired = timeouts.front();
+    timeouts.pop_front();
+    lru.erase(expired);
+  }
+  assert(fds(timeouts) == std::vector<int>({4}) and fds(lru) == std::vector<int>({4}));
+
+  // 重复插入抛出异常
+  try {
+    lru.push_back(pool[4]);
+    assert(false);
+  }catch (const tinyWheels::exception& e) {
+    std::cout << "exception: " << e.what() << std::endl;
+  }
+  assert(lru.size() == 1);
+  lru.clear();
+  timeouts.clear();
+  std::cout << "lru and timeout queue ok" << std::endl;
+}
+
+struct Item : intrusive_list_hook<> {
+  std::string name;
+  explicit Item(std::string name) : name(std::move(name)) {}
+};
+
+void test_list_operations() {
+  Item a("a"), b("b"), c("c"), d("d"), e("e");
+  intrusive_list<Item> l1, l2;
+  l1.push_back(a);
+  l1.push_back(b);
+  l1.push_back(c);
+  l2.push_back(d);
+  l2.push_back(e);
+
+  Item copy(a);  // 复制出来的对象不在链表中
+  assert(a.is_linked() and not copy.is_linked());
+  copy.name = "x";
+  auto it = l1.insert(intrusive_list<Item>::iterator_to(b), copy);
+  assert(it->name == "x" and l1.size() == 4 and (++it)->name == "b");
+  it = l1.erase(copy);
+  assert(it->name == "b" and l1.size() == 3 and not copy.is_linked());
+
+  // 移动之后首尾元素指向新的哨兵
+  intrusive_list<Item> moved(std::move(l1));
+  assert(l1.empty() and moved.size() == 3 and moved.front().name == "a" and moved.back().name == "c");
+  moved.splice(++moved.begin(), l2);
+  assert(l2.empty() and moved.size() == 5);
+  std::string order;
+  for (const auto& item : moved) order += item.name;
+  assert(order == "adebc");
+  assert(moved.remove_if([](const Item& item) {return item.name == "d" or item.name == "e";}) == 2);
+  order.clear();
+  for (const auto& item : moved) order += item.name;
+  assert(order == "abc");
+
+  swap(moved, l2);
+  assert(moved.empty() and l2.size() == 3 and l2.back().name == "c");
+  l2.pop_front();
+  assert(not a.is_linked() and l2.front().name == "b");
+  // 析构时断开所有链接，对象之后可以放进别的链表
+  {
+    intrusive_list<Item> scoped;
+    scoped.splice(scoped.end(), l2);
+  }
+  assert(not b.is_linked() and not c.is_linked() and l2.empty());
+  l1.push_back(b);
+  l1.clear();
+  std::cout << "intrusive_list ok" << std::endl;
+}
+
+int main() {
+  test_lru();
+  test_list_operations();
+  return 0;
+}
@@ -1,5 +1,10 @@
+#include <cassert>
 #include <iostream>
+#include <random>
+#include <string>
+#include <vector>
 #include "list.h"
+#include "memory_resource.h"
 
 using namespace tinyWheels;
 
@@ -8,6 +13,236 @@ void print_list(const list<T>& vec, const char * name) {
   std::cout << name << " = [" << vec << "]" << std::endl;
 }
 
+template<class T, class Alloc>
+std::vector<T> to_vector(const list<T, Alloc>& l) {
+  std::vector<T> rst;
+  for (auto it = l.begin(); it != l.end(); ++it) {
+    rst.push_back((*it).data());
+  }
+  // 反向遍历得到的顺序必须相反，用来检查 prev 是否正确
+  size_t i = rst.size();
+  for (auto it = l.rbegin(); it != l.rend(); ++it) {
+    assert((*it).data() == rst[--i]);
+  }
+  assert(i == 0 and rst.size() == l.size());
+  return rst;
+}
+
+// 记录申请次数，用来确认 sort、merge、splice 不申请内存
+class CountingResource final : public memory_resource {
+  size_t allocations_{0};
+public:
+  [[nodiscard]] size_t allocations() const {return allocations_;}
+protected:
+  void *do_allocate(const memory_size_type bytes, const memory_size_type alignment) override {
+    ++allocations_;
+    return get_default_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void *address, const memory_size_type bytes, const memory_size_type alignment) override {
+    get_default_resource()->deallocate(address, bytes, alignment);
+  }
+};
+
+struct Item {
+  int key;
+  int order;
+  bool operator==(const Item& another) const {return key == another.key and order == another.order;}
+};
+
+void test_relink() {
+  std::mt19937 random(21);
+  CountingResource counting;
+
+  // 排序：与 std::stable_sort 的结果相同，并且不申请内存
+  for (const size_t n : {0UL, 1UL, 2UL, 3UL, 7UL, 64UL, 1000UL, 100001UL}) {
+    pmr::list<Item> l(&counting);
+    std::vector<Item> expected;
+    for (size_t i = 0; i < n; ++i) {
+      const Item item{static_cast<int>(random() % 100), static_cast<int>(i)};
+      l.push_back(item);
+      expected.push_back(item);
+    }
+    const auto before = counting.allocations();
+    const auto by_key = [](const Item& a, const Item& b) {return a.key < b.key;};
+    l.sort(by_key);
+    assert(counting.allocations() == before);
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    assert(to_vector(l) == expected);
+  }
+
+  // comp 抛出异常时保持原来的顺序
+  list<int> original;
+  for (int i = 0; i < 1000; ++i) {
+    original.push_back(static_cast<int>(random() % 1000));
+  }
+  list<int> throwing(original);
+  int calls = 0;
+  try {
+    throwing.sort([&calls](const int a, const int b) {
+      if (++calls == 5000) throw std::runtime_error("comparison failed");
+      return a < b;
+    });
+    assert(false);
+  }catch (const std::runtime_error& e) {
+    std::cout << "sort exception: " << e.what() << std::endl;
+  }
+  assert(to_vector(throwing) == to_vector(original));
+
+  // merge：两个有序 list 合并，相等时原来的元素在前
+  list<int> a{1, 3, 5, 7, 9}, b{0, 3, 4, 10, 11};
+  a.merge(b);
+  assert(to_vector(a) == std::vector<int>({0, 1, 3, 3, 4, 5, 7, 9, 10, 11}) and b.empty() and a.size() == 10);
+  list<int> c{2, 1}, d{5, 4, 3};
+  c.merge(d, std::greater<int>());
+  assert(to_vector(c) == std::vector<int>({5, 4, 3, 2, 1}));
+
+  // splice：整个 list、单个节点、一段节点
+  list<int> x{1, 2, 3}, y{10, 20, 30, 40};
+  auto twenty = y.begin() + 1;
+  x.splice(x.begin() + 1, y, twenty);
+  assert(to_vector(x) == std::vector<int>({1, 20, 2, 3}) and to_vector(y) == std::vector<int>({10, 30, 40}));
+  assert((*twenty).data() == 20);  // 迭代器仍然有效，现在指向 x 中的节点
+  x.splice(x.end(), y, y.begin() + 1, y.end());
+  assert(to_vector(x) == std::vector<int>({1, 20, 2, 3, 30, 40}) and to_vector(y) == std::vector<int>({10}));
+  x.splice(x.begin(), y);
+  assert(to_vector(x) == std::vector<int>({10, 1, 20, 2, 3, 30, 40}) and y.empty() and x.size() == 7);
+  x.splice(x.begin(), x, x.begin() + 4, x.end());  // 同一个 list 内把后面一段移到前面
+  assert(to_vector(x) == std::vector<int>({3, 30, 40, 10, 1, 20, 2}) and x.size() == 7);
+  x.splice(x.end(), x, x.begin());
+  assert(to_vector(x) == std::vector<int>({30, 40, 10, 1, 20, 2, 3}));
+  x.splice(x.begin() + 1, x, x.begin() + 1);  // 移到自己之前，什么都不变
+  x.splice(x.begin() + 2, x, x.begin() + 1);  // 已经在 position 之前
+  assert(to_vector(x) == std::vector<int>({30, 40, 10, 1, 20, 2, 3}) and x.size() == 7);
+
+  // 不同内存来源的 list 之间不能移动节点
+  monotonic_buffer_resource arena;
+  pmr::list<int> p1({1, 2}, &counting), p2({3}, &arena);
+  try {
+    p1.splice(p1.end(), p2);
+    assert(false);
+  }catch (const tinyWheels::exception& e) {
+    std::cout << "splice exception: " << e.what() << std::endl;
+  }
+
+  // unique、remove、remove_if
+  list<int> dup{1, 1, 2, 2, 2, 3, 1, 1, 4};
+  assert(dup.unique() == 4);
+  assert(to_vector(dup) == std::vector<int>({1, 2, 3, 1, 4}));
+  list<int> many;
+  for (int i = 0; i < 1000; ++i) {
+    many.push_back(i % 10);
+  }
+  assert(many.remove(3) == 100 and many.size() == 900);
+  assert(many.remove_if([](const int v) {return v % 2 == 0;}) == 500 and many.size() == 400);
+  assert(many.remove(many.front()) == 100);  // 删除的值就是自己的元素
+  many.sort();
+  assert(many.unique() == 297 and to_vector(many) == std::vector<int>({5, 7, 9}));
+
+  // 迭代器距离、比较与反向迭代器
+  list<int> seq{0, 1, 2, 3, 4};
+  assert(seq.end() - seq.begin() == 5 and seq.begin() - seq.end() == -5);
+  assert(seq.begin() < seq.end() and not (seq.end() < seq.begin()) and not (seq.begin() < seq.begin()));
+  assert(seq[0] == 0 and seq[4] == 4 and seq[3] == 3 and seq.back() == 4);
+  seq.erase(seq.begin() + 1);
+  assert(to_vector(seq) == std::vector<int>({0, 2, 3, 4}));
+  std::cout << "sort, merge, splice, unique ok" << std::endl;
+}
+
+// 遍历时节点地址是否单调递增
+template<class T, class Alloc>
+bool in_address_order(const list<T, Alloc>& l) {
+  for (auto it = l.begin(); it != l.end() and it + 1 != l.end(); ++it) {
+    if (not std::less<>()(it.get(), (it + 1).get())) return false;
+  }
+  return true;
+}
+
+void test_compact() {
+  std::mt19937 random(22);
+  // 节点从打乱顺序释放的空闲块中申请，遍历顺序与地址顺序无关
+  list<std::string> filler;
+  std::vector<list<std::string>::Iterator> nodes;
+  for (int i = 0; i < 4000; ++i) {
+    filler.push_back("filler");
+  }
+  for (auto it = filler.begin(); it != filler.end(); ++it) {
+    nodes.push_back(it);
+  }
+  std::shuffle(nodes.begin(), nodes.end(), random);
+  for (size_t i = 0; i < nodes.size(); i += 2) {
+    filler.erase(nodes[i]);
+  }
+  list<std::string> l;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 3000; ++i) {
+    auto value = "value " + std::to_string(i) + std::string(static_cast<size_t>(i % 40), 'x');  // 有的在堆上，有的是短字符串
+    if (i % 3 == 0) {
+      l.push_front(value);
+      expected.insert(expected.begin(), value);
+    }else {
+      l.push_back(value);
+      expected.push_back(value);
+    }
+  }
+  assert(not in_address_order(l));
+  l.compact();
+  assert(in_address_order(l) and to_vector(l) == expected);
+  l.compact();  // 再整理一次，结果不变
+  assert(in_address_order(l) and to_vector(l) == expected);
+
+  list<int> empty, one{1};
+  empty.compact();
+  one.compact();
+  assert(empty.empty() and to_vector(one) == std::vector<int>({1}));
+
+  // 自动整理：插入与删除累计达到 size() 的一半时整理
+  list<int> automatic;
+  for (int i = 0; i < 2000; ++i) {
+    automatic.push_back(i);
+  }
+  automatic.auto_compact(0.5);
+  std::vector<int> values(2000);
+  for (int i = 0; i < 2000; ++i) values[i] = i;
+  bool compacted = false;
+  for (int round = 0; round < 1500; ++round) {
+    const auto index = random() % automatic.size();
+    automatic.erase(automatic.begin() + static_cast<long>(index));
+    values.erase(values.begin() + static_cast<long>(index));
+    compacted = compacted or in_address_order(automatic);
+    automatic.push_front(round);
+    values.insert(values.begin(), round);
+    compacted = compacted or in_address_order(automatic);
+  }
+  assert(to_vector(automatic) == values);
+  assert(compacted);
+  automatic.auto_compact(0);
+  std::cout << "compact ok" << std::endl;
+}
+
+// 只有拷贝构造、没有移动的类型，移动会退化为可能抛出异常的拷贝；不能 compact，但 list 的其他操作照常可用
+struct Legacy {
+  int value;
+  explicit Legacy(const int value = 0) : value(value) {}
+  Legacy(const Legacy& another) : value(another.value) {}
+  Legacy& operator=(const Legacy& another) {value = another.value; return *this;}
+};
+static_assert(not std::is_nothrow_move_constructible_v<Legacy>);
+
+void test_throwing_move() {
+  list<Legacy> l;
+  l.auto_compact(0.5);  // 不起作用
+  for (int i = 0; i < 2000; ++i) {
+    l.push_back(Legacy(i));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    l.pop_front();
+  }
+  l.insert(l.begin(), Legacy(-1));
+  l.remove_if([](const Legacy& x) {return x.value % 2 == 0;});
+  assert(l.size() == 501 and l.front().value == -1);
+  std::cout << "throwing move ok" << std::endl;
+}
+
 int main(){
   list v1(10, 1);
   list<int> v2;
@@ -23,5 +258,18 @@ int main(){
   v2.erase(v2.begin() + 3, v2.begin() + 11);
   print_list(v2, "v2");
   print_list(v3, "v3");
+
+  // 节点按批申请：超过一批的构造、插入、拷贝与清空
+  list<int> big(200, 7);
+  big.insert(big.begin(), 100, 1);
+  list<int> copy(big);
+  std::cout << "big: " << big.size() << ", copy: " << copy.size() << ", equal: " << (big == copy) << std::endl;
+  copy.clear();
+  copy.push_back(5);
+  print_list(copy, "copy");
+
+  test_relink();
+  test_compact();
+  test_throwing_move();
   return 0;
 }
@@ -0,0 +1,96 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "algorithm.h"
+#include "mapped_vector.h"
+
+using namespace tinyWheels;
+
+struct Record {
+    uint64_t id;
+    double price;
+    int32_t quantity;
+};
+
+int main() {
+    const std::string path = "/tmp/test_mapped_vector_" + std::to_string(getpid()) + ".bin";
+    unlink(path.c_str());
+
+    // 第一次运行：创建文件并写入
+    {
+        mapped_vector<Record> records(path.c_str());
+        assert(records.empty() and records.capacity() == 0);
+        for (uint64_t i = 0; i < 100000; ++i) {
+            records.push_back({i, static_cast<double>(i) / 4, static_cast<int32_t>(i % 7)});
+        }
+        records.push_back(records[0]);  // 扩容时 value 在映射中
+        assert(records.size() == 100001 and records.back().id == 0);
+        assert(records.pop_back());
+        records.flush();
+        std::cout << "written: " << records.size() << ", capacity: " << records.capacity() << std::endl;
+    }
+
+    // 重启之后只读打开，不需要重新构建
+    {
+        const mapped_vector<Record> records(path.c_str(), true);
+        assert(records.read_only() and records.size() == 100000);
+        uint64_t ids = 0;
+        for (const auto &record : records) {
+            ids += record.id;
+        }
+        assert(ids == 99999ULL * 100000 / 2);
+        assert(records[12345].price == 12345 / 4.0 and records[12345].quantity == 12345 % 7);
+        std::cout << "read only: " << records.size() << " records, sum of ids: " << ids << std::endl;
+    }
+
+    // 只读时不能修改
+    try {
+        mapped_vector<Record> records(path.c_str(), true);
+        records.push_back({1, 1, 1});
+        assert(false);
+    }catch (const tinyWheels::exception &e) {
+        std::cout << "exception: " << e.what() << std::endl;
+    }
+
+    // 元素类型不一致时拒绝打开
+    try {
+        mapped_vector<int> wrong(path.c_str(), true);
+        assert(false);
+    }catch (const tinyWheels::exception &e) {
+        std::cout << "exception: " << e.what() << std::endl;
+    }
+
+    // 读写打开之后继续追加、截断、缩小文件
+    {
+        mapped_vector<Record> records(path.c_str());
+        records.resize(100010, Record{7, 7, 7});
+        assert(records.size() == 100010 and records[100009].id == 7);
+        records.resize(50);
+        records.shrink_to_fit();
+        assert(records.capacity() == 50);
+        records.flush(true);
+    }
+    {
+        const mapped_vector<Record> records(path.c_str(), true);
+        assert(records.size() == 50 and records[49].id == 49);
+        std::cout << "after shrink: " << records.size() << ", capacity: " << records.capacity() << std::endl;
+    }
+
+    // 数字类型的列也可以直接交给向量化的算法
+    const std::string numbers_path = path + ".numbers";
+    unlink(numbers_path.c_str());
+    {
+        mapped_vector<int> numbers(numbers_path.c_str());
+        for (int i = 1; i <= 1000; ++i) {
+            numbers.push_back(i);
+        }
+        assert(sum(numbers.begin(), numbers.end()) == 500500);
+        numbers.clear();
+        assert(numbers.empty() and numbers.capacity() >= 1000);
+    }
+
+    unlink(path.c_str());
+    unlink(numbers_path.c_str());
+    return 0;
+}
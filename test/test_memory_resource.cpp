@@ -0,0 +1,88 @@
+#include <iostream>
+#include <thread>
+#include "list.h"
+#include "memory_resource.h"
+#include "mystring.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+// 记录上游申请与释放的字节数，用来确认 release() 之后内存全部还回去了
+class CountingResource final : public memory_resource {
+    size_t outstanding_{0};
+    size_t allocations_{0};
+public:
+    [[nodiscard]] size_t outstanding() const {return outstanding_;}
+    [[nodiscard]] size_t allocations() const {return allocations_;}
+protected:
+    void *do_allocate(const memory_size_type bytes, const memory_size_type alignment) override {
+        outstanding_ += bytes;
+        ++allocations_;
+        return get_default_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *address, const memory_size_type bytes, const memory_size_type alignment) override {
+        outstanding_ -= bytes;
+        get_default_resource()->deallocate(address, bytes, alignment);
+    }
+};
+
+// 模拟一次请求：所有临时容器都建在 arena 上
+void handle_request(memory_resource *arena, const int id) {
+    pmr::vector<int> v(arena);
+    for (int i = 0; i < 10; ++i) {
+        v.push_back(id * 100 + i);
+    }
+    pmr::list<int> l({1, 2, 3}, arena);
+    l.push_back(id);
+    string s("request ", arena);
+    s += static_cast<char>('0' + id);
+    std::cout << s.c_str() << ": v = [" << v << "], l = [" << l << "]" << std::endl;
+}
+
+int main() {
+    // 1. 单调缓冲区：先用栈上的初始缓冲区，不够时向上游申请，一次 release 全部释放
+    CountingResource upstream;
+    char buffer[256];
+    monotonic_buffer_resource arena(buffer, sizeof(buffer), &upstream);
+    for (int id = 0; id < 3; ++id) {
+        handle_request(&arena, id);
+    }
+    std::cout << "upstream allocations: " << upstream.allocations() << ", outstanding: " << upstream.outstanding() << " bytes" << std::endl;
+    arena.release();
+    std::cout << "after release, outstanding: " << upstream.outstanding() << " bytes" << std::endl;
+
+    // 2. 加锁的池化资源：多个线程共用同一个资源，容器析构时内存回到资源的自由链表
+    CountingResource pool_upstream;
+    {
+        synchronized_pool_resource pool(&pool_upstream);
+        std::thread threads[4];
+        for (int t = 0; t < 4; ++t) {
+            threads[t] = std::thread([&pool, t] {
+                for (int round = 0; round < 100; ++round) {
+                    pmr::list<int> l(&pool);
+                    pmr::vector<long> v(&pool);
+                    for (int i = 0; i < 50; ++i) {
+                        l.push_back(t + i);
+                        v.push_back(t * i);
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        pmr::list<string> names(&pool);
+        names.push_back(string("alice", &pool));
+        names.push_back(string("bob", &pool));
+        std::cout << "names: " << (*names.begin()).data().c_str() << ", " << (*names.begin()).next()->data().c_str() << std::endl;
+        std::cout << "pool upstream allocations: " << pool_upstream.allocations() << ", outstanding: " << pool_upstream.outstanding() << " bytes" << std::endl;
+    }
+    std::cout << "after pool destroyed, outstanding: " << pool_upstream.outstanding() << " bytes" << std::endl;
+
+    // 3. 默认资源与普通 Allocator 的容器照常使用
+    vector<int> plain{1, 2, 3};
+    string hello("hello");
+    hello += ", world";
+    std::cout << "plain = [" << plain << "], " << hello.c_str() << std::endl;
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include "parallel.h"
+
+using namespace tinyWheels;
+
+int main() {
+    ThreadPoll pool(4, true);
+    std::mt19937_64 random(2025);
+
+    // parallel_for：每个元素各自加一，整数版本按下标访问
+    vector<long> numbers(1000003);
+    parallel_for(pool, size_t(0), numbers.size(), [&](const size_t i) {numbers[i] = static_cast<long>(i);});
+    parallel_for(pool, numbers, [](long &x) {x += 1;});
+    for (size_t i = 0; i < numbers.size(); ++i) {
+        assert(numbers[i] == static_cast<long>(i) + 1);
+    }
+    std::cout << "parallel_for ok, size: " << numbers.size() << std::endl;
+
+    // parallel_reduce：求和与最大值
+    const auto total = parallel_reduce(pool, numbers, 0L);
+    const long n = static_cast<long>(numbers.size());
+    assert(total == n * (n + 1) / 2);
+    const auto maximum = parallel_reduce(pool, numbers.begin(), numbers.end(), 0L, [](const long a, const long b) {return std::max(a, b);});
+    assert(maximum == n);
+    assert(parallel_reduce(pool, numbers.begin(), numbers.begin(), 42L) == 42);  // 空区间返回 init
+    std::cout << "parallel_reduce ok, sum: " << total << ", max: " << maximum << std::endl;
+
+    // parallel_transform：输出到另一个 vector，也可以原地
+    vector<double> halves(numbers.size());
+    const auto end = parallel_transform(pool, numbers.begin(), numbers.end(), halves.begin(), [](const long x) {return x / 2.0;});
+    assert(end == halves.end());
+    parallel_transform(pool, halves.begin(), halves.end(), halves.begin(), [](const double x) {return x * 2;});
+    for (size_t i = 0; i < halves.size(); ++i) {
+        assert(halves[i] == static_cast<double>(numbers[i]));
+    }
+    std::cout << "parallel_transform ok" << std::endl;
+
+    // parallel_sort：不同长度（包括不是 2 的幂、小于一块）与 std::sort 的结果比较
+    for (const size_t size : {0UL, 1UL, 1000UL, 16385UL, 100000UL, 1234567UL}) {
+        vector<uint32_t> values(size);
+        for (auto &value : values) {
+            value = static_cast<uint32_t>(random() % (size + 1));  // 有很多重复的元素
+        }
+        std::vector<uint32_t> expected(values.begin(), values.end());
+        std::sort(expected.begin(), expected.end());
+        parallel_sort(pool, values);
+        assert(std::equal(values.begin(), values.end(), expected.begin(), expected.end()));
+        std::cout << "parallel_sort ok, size: " << size << std::endl;
+    }
+
+    // 自定义比较与不能平凡复制的元素
+    vector<std::string> words(200000);
+    for (auto &word : words) {
+        word = std::to_string(random() % 100000);
+    }
+    std::vector<std::string> expected_words(words.begin(), words.end());
+    const auto longer_first = [](const std::string &a, const std::string &b) {
+        return a.size() != b.size() ? a.size() > b.size() : a < b;
+    };
+    std::sort(expected_words.begin(), expected_words.end(), longer_first);
+    parallel_sort(pool, words, longer_first);
+    assert(std::equal(words.begin(), words.end(), expected_words.begin(), expected_words.end()));
+    std::cout << "parallel_sort strings ok, first: " << words[0] << ", last: " << words[words.size() - 1] << std::endl;
+
+    // 分块中的异常在调用线程中重新抛出
+    bool caught = false;
+    try {
+        parallel_for(pool, size_t(0), size_t(100000), [](const size_t i) {
+            if (i == 77777) {
+                throw std::runtime_error("bad element");
+            }
+        });
+    }catch (const std::runtime_error &e) {
+        caught = true;
+        std::cout << "exception propagated: " << e.what() << std::endl;
+    }
+    assert(caught);
+
+    // 在线程池的任务里再调用：调用线程自己也会执行分块，不会因为所有线程都在等待而死锁
+    std::atomic<long> nested{0};
+    std::atomic<int> finished{0};
+    for (int task = 0; task < 8; ++task) {
+        pool.add_task([&] {
+            vector<long> local(100000, 1L);
+            nested += parallel_reduce(pool, local, 0L);
+            ++finished;
+        });
+    }
+    while (finished.load() < 8) {
+        std::this_thread::yield();
+    }
+    assert(nested.load() == 8 * 100000);
+    std::cout << "nested ok, sum: " << nested.load() << std::endl;
+
+    pool.stop(true);
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <iostream>
+#include <string>
+#include "small_vector.h"
+
+using namespace tinyWheels;
+
+template<class T, size_t N>
+void print_vector(const small_vector<T, N>& vec, const char * name) {
+  std::cout << name << " = [" << vec << "], inline: " << vec.is_inline() << ", capacity: " << vec.capacity() << std::endl;
+}
+
+int main(){
+  const auto before = Allocator<int>::statistics().allocated_bytes;
+  small_vector<int, 8> v1{1, 2, 3};
+  small_vector<int, 8> v2(v1);
+  v2.insert(v2.begin(), 2, 0);
+  v2.erase(v2.begin() + 1);
+  v2.push_back(v2[0]);
+  print_vector(v1, "v1");
+  print_vector(v2, "v2");
+  std::cout << "bytes allocated while inline: " << Allocator<int>::statistics().allocated_bytes - before << std::endl;
+
+  // 超过 8 个元素之后放到堆上
+  for (int i = 0; i < 10; ++i) {
+    v1.push_back(i * 10);
+  }
+  print_vector(v1, "v1");
+  std::cout << "reverse:";
+  for (auto it = v1.rbegin(); it != v1.rend(); ++it) {
+    std::cout << " " << *it;
+  }
+  small_vector<int, 8> empty;
+  std::cout << ", empty reversed: " << (empty.rbegin() == empty.rend()) << std::endl;
+  v1.resize(4);
+  print_vector(v1, "v1");
+
+  // 移动：内联的元素逐个搬过来，堆上的直接接管指针
+  small_vector<std::string, 2> s1{"short", "a string long enough to live on the heap"};
+  small_vector<std::string, 2> s2(std::move(s1));
+  s1.push_back("x");
+  s1.push_back("y");
+  s1.push_back("z");
+  swap(s1, s2);
+  std::cout << "s1 = [" << s1[0] << ", " << s1[1] << "] (" << s1.size() << "), inline: " << s1.is_inline() << std::endl;
+  std::cout << "s2 = [" << s2[0] << ", " << s2[1] << ", " << s2[2] << "] (" << s2.size() << "), inline: " << s2.is_inline() << std::endl;
+  std::cout << "sizeof(small_vector<int, 8>) = " << sizeof(small_vector<int, 8>) << std::endl;
+  return 0;
+}
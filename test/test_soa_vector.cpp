@@ -0,0 +1,76 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "algorithm.h"
+#include "soa_vector.h"
+
+using namespace tinyWheels;
+
+int main() {
+    // 三列：id、价格、名字
+    soa_vector<int, double, std::string> orders{{1, 9.5, "apple"}, {2, 3.25, "pear"}};
+    orders.emplace_back(3, 12.0, std::string("melon"));
+    orders.push_back({4, 0.75, "plum"});
+    assert(orders.size() == 4);
+    std::cout << "size: " << orders.size() << ", capacity: " << orders.capacity() << std::endl;
+
+    // 按行访问：结构化绑定得到各列中的引用
+    for (auto row : orders) {
+        auto [id, price, name] = row;
+        price *= 2;
+        std::cout << id << " " << name << " " << price << std::endl;
+    }
+    assert(orders.get<1>(0) == 19.0);
+    assert(orders[2] == std::make_tuple(3, 24.0, std::string("melon")));
+
+    // 行代理可以整体赋值，也可以复制出值
+    orders[3] = {40, 1.5, "grape"};
+    const std::tuple<int, double, std::string> copy = orders[3];
+    assert(std::get<0>(copy) == 40 and std::get<2>(copy) == "grape");
+    orders[0] = orders[1];
+    assert(orders.get<2>(0) == "pear");
+
+    // 列访问：连续的 span，可以直接交给向量化的算法
+    const auto prices = orders.column<1>();
+    std::cout << "sum of prices: " << sum(prices.begin(), prices.end()) << std::endl;
+    assert(sum(prices.begin(), prices.end()) == 6.5 + 6.5 + 24.0 + 1.5);
+    const auto ids = orders.column<0>();
+    assert(tinyWheels::find(ids.begin(), ids.end(), 40) == ids.begin() + 3);
+
+    // 删除一行，所有列一起前移
+    orders.erase(1);
+    assert(orders.size() == 3 and orders.get<0>(1) == 3 and orders.get<2>(2) == "grape");
+    assert(orders.pop_back());
+    assert(orders.size() == 2);
+
+    // const 访问与比较
+    const auto snapshot = orders;
+    assert(snapshot == orders);
+    for (const auto row : snapshot) {
+        std::cout << row.get<0>() << ": " << row.get<2>() << std::endl;
+    }
+
+    // at() 越界抛出异常
+    try {
+        orders.at(10);
+        assert(false);
+    }catch (const tinyWheels::exception &e) {
+        std::cout << "exception: " << e.what() << std::endl;
+    }
+
+    // 大量数据：按列求和与按行求和相同
+    soa_vector<int, float> big(100000);
+    auto column = big.column<0>();
+    for (size_t i = 0; i < column.size(); ++i) {
+        column[i] = static_cast<int>(i % 1000);
+    }
+    long long by_row = 0;
+    for (const auto row : big) {
+        by_row += row.get<0>();
+    }
+    assert(sum(column.begin(), column.end()) == by_row);
+    big.clear();
+    assert(big.empty());
+    std::cout << "sum by row: " << by_row << std::endl;
+    return 0;
+}
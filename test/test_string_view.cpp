@@ -0,0 +1,166 @@
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include "algorithm.h"
+#include "mapped_vector.h"
+#include "mystring.h"
+#include "small_vector.h"
+#include "span.h"
+#include "string_view.h"
+#include "vector.h"
+
+using namespace tinyWheels;
+
+// 只接受视图的函数：vector、small_vector、数组都可以直接传进来，不复制
+long long total(const span<const int> values) {
+    return sum(values.begin(), values.end());
+}
+
+// 按 "key=value;" 切分，全程不申请内存
+size_t parse_pairs(string_view input, string_view *keys, string_view *values) {
+    size_t n = 0;
+    while (not input.empty()) {
+        const auto end = input.find(';');
+        auto pair = input.substr(0, end);
+        const auto eq = pair.find('=');
+        keys[n] = pair.substr(0, eq);
+        values[n] = eq == string_view::npos ? string_view() : pair.substr(eq + 1);
+        ++n;
+        input.remove_prefix(end == string_view::npos ? input.size() : end + 1);
+    }
+    return n;
+}
+
+void test_span() {
+    vector<int> v;
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(i);
+    }
+    span<int> all(v);
+    assert(all.size() == 100 and all.data() == v.begin());
+    auto middle = all.subspan(10, 20);
+    assert(middle.size() == 20 and middle.front() == 10 and middle.back() == 29);
+    middle[0] = -10;  // 视图修改的就是原来的元素
+    assert(v[10] == -10);
+    assert(all.first(5).back() == 4 and all.last(5).front() == 95);
+    assert(all.subspan(100).empty() and all.subspan(90, 1000).size() == 10);
+    assert(find(all.begin(), all.end(), 77) == v.begin() + 77);
+    assert(total(v) == 4950 - 20);
+    assert(total(middle) == total(v.as_span().subspan(10, 20)));
+
+    small_vector<int, 4> small;
+    small.push_back(1);
+    small.push_back(2);
+    assert(total(small) == 3 and total(small.as_span()) == 3);
+    int array[] = {5, 6, 7};
+    assert(total(array) == 18);
+    span<const unsigned char> bytes = span(array).as_bytes();
+    assert(bytes.size() == sizeof(array));
+
+    try {
+        (void)all.subspan(101);
+        assert(false);
+    }catch (const tinyWheels::exception &e) {
+        std::cout << "exception: " << e.what() << std::endl;
+    }
+    try {
+        (void)middle.at(20);
+        assert(false);
+    }catch (const tinyWheels::exception &e) {
+        std::cout << "exception: " << e.what() << std::endl;
+    }
+    std::ostringstream os;
+    os << all.first(3);
+    assert(os.str() == "0, 1, 2");
+    std::cout << "span: " << os.str() << std::endl;
+}
+
+void test_string_view() {
+    const string_view sv = "GET /index.html HTTP/1.1";
+    assert(sv.size() == 24);
+    assert(sv.starts_with("GET ") and sv.ends_with("1.1") and sv.starts_with('G') and not sv.ends_with('0'));
+    const auto space = sv.find(' ');
+    assert(space == 3 and sv.find(' ', space + 1) == 15 and sv.rfind(' ') == 15 and sv.rfind(' ', 14) == 3);
+    assert(sv.substr(space + 1, sv.find(' ', space + 1) - space - 1) == "/index.html");
+    assert(sv.find("HTTP") == 16 and sv.find("HTTQ") == string_view::npos and sv.find("") == 0);
+    assert(sv.find("1.1") == 21 and sv.find("1.1", 22) == string_view::npos);
+    assert(sv.contains("index") and not sv.contains('#'));
+    assert(sv.substr(24).empty());
+
+    // 比较按字典序，较短的前缀更小
+    assert(string_view("abc") < string_view("abd"));
+    assert(string_view("ab") < string_view("abc"));
+    assert(string_view("") < string_view("a"));
+    assert(string_view("\xff") > string_view("a"));  // 按无符号字节比较
+    assert(string_view("abc", 2) == "ab");
+
+    string_view keys[4], values[4];
+    const char buffer[] = "host=example.com;port=80;flag";
+    const auto n = parse_pairs(buffer, keys, values);
+    assert(n == 3);
+    assert(keys[0] == "host" and values[0] == "example.com");
+    assert(keys[1] == "port" and values[1] == "80");
+    assert(keys[2] == "flag" and values[2].empty());
+    assert(values[0].data() == buffer + 5);  // 指向原来的缓冲区
+
+    try {
+        (void)sv.substr(25);
+        assert(false);
+    }catch (const tinyWheels::exception &e) {
+        std::cout << "exception: " << e.what() << std::endl;
+    }
+    std::cout << "string_view: " << sv.substr(4, 11) << std::endl;
+}
+
+void test_string() {
+    string s = "hello, world";
+    const string_view v = s;
+    assert(v.data() == s.c_str() and v.size() == s.size());
+    assert(s.substr(7) == "world" and s.substr(0, 5) == "hello" and s.substr(12).size() == 0);
+    assert(s.find(',') == 5 and s.find("world") == 7 and s.find('x') == string_view::npos);
+    assert(s == v and v == s and s == string_view("hello, world"));
+    assert(string(v.substr(0, 5)) == "hello");
+
+    s += string_view(" and more", 4);
+    assert(s == "hello, world and");
+    s += s.view().substr(0, 5);  // 追加自己的一段，扩容时也要正确
+    assert(s == "hello, world andhello");
+
+    // 长度不同时的比较
+    const string a = "abc", b = "abcd", c = "abd";
+    assert(a < b and b > a and a <= b and b >= a and not (a > b) and not (a >= b));
+    assert(b < c and c > b and a < c);
+    assert(a < "abcd" and "abcd" > a and a >= "abc" and a <= "abc" and "ab" < a and a > "ab");
+    assert(string() < a and string() <= string() and not (string() < string()));
+    assert(a < string_view("abcd") and string_view("abb") < a);
+
+    try {
+        (void)s.substr(100);
+        assert(false);
+    }catch (const tinyWheels::exception &e) {
+        std::cout << "exception: " << e.what() << std::endl;
+    }
+    std::cout << "string: " << s.view() << std::endl;
+}
+
+void test_mapped_span() {
+    const char *path = "/tmp/tinywheels_test_string_view.mvec";
+    remove(path);
+    {
+        mapped_vector<int> mv(path);
+        for (int i = 1; i <= 10; ++i) {
+            mv.push_back(i);
+        }
+        assert(total(mv) == 55 and total(mv.as_span().last(2)) == 19);
+    }
+    remove(path);
+    std::cout << "mapped_vector span ok" << std::endl;
+}
+
+int main() {
+    test_span();
+    test_string_view();
+    test_string();
+    test_mapped_span();
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "arena.h"
+#include "unrolled_list.h"
+
+using namespace tinyWheels;
+
+// 每个节点非空、不超过 K 个元素，个数加起来等于 size()；正反两个方向遍历的结果一致
+template<class T, size_t K, class Alloc>
+std::vector<T> check(const unrolled_list<T, K, Alloc>& l) {
+  std::vector<T> rst;
+  size_t nodes = 0;
+  l.for_each_segment([&](const span<const T> segment) {
+    assert(not segment.empty() and segment.size() <= K);
+    rst.insert(rst.end(), segment.begin(), segment.end());
+    ++nodes;
+  });
+  assert(rst.size() == l.size() and nodes == l.node_count());
+  size_t i = 0;
+  for (auto it = l.cbegin(); it != l.cend(); ++it) {
+    assert(*it == rst[i++]);
+  }
+  assert(i == rst.size());
+  for (auto it = l.rbegin(); it != l.rend(); ++it) {
+    assert(*it == rst[--i]);
+  }
+  assert(i == 0 and l.cend() - l.cbegin() == static_cast<ptrdiff_t>(l.size()));
+  return rst;
+}
+
+// 随机插入、删除，与 std::vector 的结果比较
+template<size_t K>
+void test_random(const unsigned seed) {
+  std::mt19937 random(seed);
+  unrolled_list<std::string, K> l;
+  std::vector<std::string> expected;
+  for (int round = 0; round < 20000; ++round) {
+    const auto op = random() % 8;
+    const auto value = std::to_string(round) + std::string(round % 20, 'x');
+    if (op < 3) {
+      const auto index = random() % (expected.size() + 1);
+      const auto it = l.insert(l.begin() + static_cast<ptrdiff_t>(index), value);
+      assert(*it == value);
+      expected.insert(expected.begin() + static_cast<ptrdiff_t>(index), value);
+    }else if (op == 3) {
+      l.push_back(value);
+      expected.push_back(value);
+    }else if (op == 4) {
+      l.push_front(value);
+      expected.insert(expected.begin(), value);
+    }else if (not expected.empty()) {
+      const auto index = random() % expected.size();
+      const auto it = l.erase(l.begin() + static_cast<ptrdiff_t>(index));
+      expected.erase(expected.begin() + static_cast<ptrdiff_t>(index));
+      assert(it - l.begin() == static_cast<ptrdiff_t>(index));
+      if (index < expected.size()) assert(*it == expected[index]);
+    }
+    if (round % 1000 == 0) {
+      assert(check(l) == expected);
+    }
+  }
+  assert(check(l) == expected);
+  for (size_t i = 0; i < expected.size(); i += 97) {
+    assert(l[i] == expected[i] and l.at(i) == expected[i]);
+  }
+  // 删空之后不留下节点
+  while (not expected.empty()) {
+    if (expected.size() % 2) {
+      assert(l.pop_back());
+      expected.pop_back();
+    }else {
+      assert(l.pop_front());
+      expected.erase(expected.begin());
+    }
+  }
+  assert(l.empty() and l.node_count() == 0 and not l.pop_back() and l.begin() == l.end());
+}
+
+void test_basic() {
+  unrolled_list<int, 4> l{1, 2, 3, 4, 5, 6, 7, 8, 9};
+  assert(l.node_count() == 3 and l.front() == 1 and l.back() == 9);
+  std::cout << "l = [" << l << "]" << std::endl;
+
+  // 插入只影响所在的节点，其他节点中的引用保持有效
+  int& first = l.front();
+  int& last = l.back();
+  l.insert(l.begin() + 5, 100);  // 第二个节点已满，对半拆开
+  assert(&first == &l.front() and &last == &l.back() and l[5] == 100);
+  assert(check(l) == std::vector<int>({1, 2, 3, 4, 5, 100, 6, 7, 8, 9}));
+
+  auto it = l.insert(l.end(), 3, 7);
+  assert(it - l.begin() == 10 and check(l) == std::vector<int>({1, 2, 3, 4, 5, 100, 6, 7, 8, 9, 7, 7, 7}));
+  const std::vector<int> more{-1, -2, -3, -4, -5};
+  it = l.insert(l.begin() + 2, more.begin(), more.end());
+  assert(*it == -1 and it - l.begin() == 2);
+  assert(check(l) == std::vector<int>({1, 2, -1, -2, -3, -4, -5, 3, 4, 5, 100, 6, 7, 8, 9, 7, 7, 7}));
+  it = l.erase(l.begin() + 2, l.begin() + 7);
+  assert(*it == 3 and check(l) == std::vector<int>({1, 2, 3, 4, 5, 100, 6, 7, 8, 9, 7, 7, 7}));
+  l.insert(l.begin(), l.back());  // 插入自己的元素
+  assert(l.front() == 7 and l.size() == 14);
+
+  // 拷贝、移动、比较
+  unrolled_list<int, 4> copy(l);
+  assert(copy == l and copy.node_count() == 4);  // 拷贝出来的节点都是满的
+  unrolled_list<int, 4> moved(std::move(copy));
+  assert(moved == l and copy.empty());
+  copy = {1, 2};
+  assert(copy != l and check(copy) == std::vector<int>({1, 2}));
+
+  // 迭代器跳过整个节点
+  auto jump = l.begin() + 9;
+  assert(*jump == l[9] and jump - 9 == l.begin() and l.begin() < jump and jump - l.begin() == 9);
+  unrolled_list<int, 4>::ConstIterator constant = jump;
+  assert(*constant == l[9]);
+
+  try {
+    (void)l.at(100);
+    assert(false);
+  }catch (const tinyWheels::exception& e) {
+    std::cout << "exception: " << e.what() << std::endl;
+  }
+}
+
+void test_splice() {
+  unrolled_list<int, 4> a{1, 2, 3, 4, 5, 6}, b{10, 11, 12, 13, 14};
+  int& kept = b.back();
+  auto inside = b.begin() + 1;
+  a.splice(a.begin() + 2, b);  // 在节点中间，先把节点拆开
+  assert(b.empty() and b.node_count() == 0 and &kept == &a[6] and *inside == 11);
+  assert(check(a) == std::vector<int>({1, 2, 10, 11, 12, 13, 14, 3, 4, 5, 6}));
+  a.splice(a.end(), unrolled_list<int, 4>{20, 21});
+  a.splice(a.begin(), unrolled_list<int, 4>{0});
+  assert(check(a) == std::vector<int>({0, 1, 2, 10, 11, 12, 13, 14, 3, 4, 5, 6, 20, 21}));
+  b.splice(b.begin(), a);
+  assert(a.empty() and b.size() == 14);
+
+  // 不同 arena 的节点不能移动
+  Arena arena1(4096), arena2(4096);
+  pmr::unrolled_list<int, 4> p(&arena1), q(&arena2);
+  p.push_back(1);
+  q.push_back(2);
+  try {
+    p.splice(p.end(), q);
+    assert(false);
+  }catch (const tinyWheels::exception& e) {
+    std::cout << "splice exception: " << e.what() << std::endl;
+  }
+  assert(p.size() == 1 and q.size() == 1);
+}
+
+int main() {
+  test_basic();
+  test_random<2>(1);
+  test_random<4>(2);
+  test_random<16>(3);
+  test_random<mzUnrolledList::default_node_elements<std::string>()>(4);
+  test_splice();
+  std::cout << "unrolled_list ok, default K for int: " << unrolled_list<int>::NODE_ELEMENTS << std::endl;
+  return 0;
+}
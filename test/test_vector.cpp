@@ -1,6 +1,7 @@
 #include <iostream>
 #include "vector.h"
 #include <fstream>
+#include <string>
 
 using namespace tinyWheels;
 
@@ -13,7 +14,6 @@ int main(){
   // 以文件读写的方式打开 ../log/log.txt
   std::ofstream log_file("../log/log.txt", std::ios::out | std::ios::trunc);
 
-  vector<int>::dataAllocator::set_log_ostream(std::cout);
   vector v1(10, 1);
   vector<int> v2;
   vector v3{1, 2, 3};
@@ -33,5 +33,38 @@ int main(){
     v3.push_back(i * 100);
   }
   print_vector(v3, "v3");
+  // 反向遍历；空 vector 的 data_ 是 nullptr，rbegin() 与 rend() 相等，不做指针减法
+  vector<int> empty;
+  std::cout << "v3 reversed:";
+  for (auto it = v3.crbegin(); it != v3.crend(); ++it) {
+    std::cout << " " << *it;
+  }
+  std::cout << ", empty reversed: " << (empty.rbegin() == empty.rend() and empty.rend() - empty.rbegin() == 0) << std::endl;
+
+  // 不可按字节搬移的元素（std::string 的短字符串指向自身）逐个移动构造；插入自己的元素时先复制出来
+  vector<std::string> names;
+  for (int i = 0; i < 6; ++i) {
+    names.push_back("name-" + std::to_string(i) + std::string(i % 2 ? 0 : 20, '*'));
+  }
+  names.insert(names.begin() + 1, 2, names[4]);
+  names.erase(names.begin() + 3, names.begin() + 5);
+  vector<std::string> copies(names.begin(), names.end());
+  copies.resize(5);
+  std::cout << "names = [";
+  for (const auto &name : copies) {
+    std::cout << name << ", ";
+  }
+  std::cout << "] (" << copies.size() << ")" << std::endl;
+
+  // 数据按 32 字节对齐，扩容之后仍然对齐；cache_aligned 让每个计数器独占一个缓存行
+  aligned_vector<float, 32> floats(5, 1.5f);
+  for (int i = 0; i < 20; ++i) {
+    floats.push_back(static_cast<float>(i));
+  }
+  std::cout << "floats = [" << floats << "], 32-byte aligned: " << (reinterpret_cast<uintptr_t>(floats.begin()) % 32 == 0) << std::endl;
+  vector<cache_aligned<long>> counters(4);
+  counters[2].value = 7;
+  std::cout << "counters = [" << counters << "], stride: " << reinterpret_cast<char *>(&counters[1]) - reinterpret_cast<char *>(&counters[0]) << std::endl;
+  std::cout << vector<int>::dataAllocator::statistics();
   return 0;
 }